@@ -0,0 +1,175 @@
+"""
+Benchmark the readers of every backend on the test classes of `tests/gen-test-data`.
+
+Generate large files first, for example:
+
+    cd tests/gen-test-data/build
+    ./gen-test-data 100000
+
+then run:
+
+    python benchmarks/bench_readers.py --data-dir tests/gen-test-data/build
+
+Baskets are read and decompressed before timing, so the throughput only covers
+decoding (`AsCustom.basket_array`).
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import sys
+import time
+import warnings
+from pathlib import Path
+
+import uproot
+
+import uproot_custom
+import uproot_custom.factories
+
+# reuse the branch lists of the tests, importing them also registers the branches
+sys.path.insert(0, str(Path(__file__).parents[1] / "tests"))
+import conftest  # noqa: E402
+
+ALL_BACKENDS = ["cpp", "plan", "python", "forth", "numba"]
+ALL_FILES = [
+    "primitive",
+    "stl_string",
+    "stl_sequence",
+    "stl_map",
+    "stl_array",
+    "stl_seq_with_obj",
+    "stl_map_with_obj",
+    "stl_nested",
+    "stl_complicated",
+    "root_objects",
+    "cstyle_array",
+    "pointers",
+    "pure_struct",
+]
+
+
+def reset_peak_rss() -> bool:
+    """
+    Reset the peak RSS of the process. Only supported on Linux.
+    """
+    try:
+        with open("/proc/self/clear_refs", "w") as f:
+            f.write("5")
+        return True
+    except OSError:
+        return False
+
+
+def peak_rss_mb() -> float:
+    """
+    Get the peak RSS of the process in MB.
+    """
+    try:
+        with open("/proc/self/status") as f:
+            for line in f:
+                if line.startswith("VmHWM:"):
+                    return int(line.split()[1]) / 1024
+    except OSError:
+        pass
+
+    import resource
+
+    maxrss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    # bytes on macOS, kB on Linux
+    return maxrss / 1024**2 if sys.platform == "darwin" else maxrss / 1024
+
+
+def bench_branch(branch, backend: str, repeat: int) -> dict:
+    interp = branch.interpretation
+    baskets = [branch.basket(i) for i in range(branch.num_baskets)]
+    nbytes = sum(basket.data.nbytes for basket in baskets)
+
+    uproot_custom.factories.reader_backend = backend
+    interp.clear_cache()
+
+    def decode():
+        for basket in baskets:
+            interp.basket_array(
+                basket.data,
+                basket.byte_offsets,
+                basket,
+                branch,
+                branch.context,
+                basket.member("fKeylen"),
+                uproot.interpretation.library._regularize_library("ak"),
+                {},
+            )
+
+    # warm up, e.g. numba compilation and factory building
+    decode()
+
+    reset_peak_rss()
+    best = float("inf")
+    for _ in range(repeat):
+        start = time.perf_counter()
+        decode()
+        best = min(best, time.perf_counter() - start)
+
+    return {
+        "seconds": best,
+        "MB/s": nbytes / 1024**2 / best,
+        "entries/s": branch.num_entries / best,
+        "peak_rss_MB": peak_rss_mb(),
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument(
+        "--data-dir",
+        type=Path,
+        default=Path(__file__).parents[1] / "tests" / "data",
+        help="Directory of the files generated by gen-test-data.",
+    )
+    parser.add_argument("--files", nargs="+", default=ALL_FILES, choices=ALL_FILES)
+    parser.add_argument(
+        "--backends", nargs="+", default=["cpp", "python"], choices=ALL_BACKENDS
+    )
+    parser.add_argument("-k", "--keyword", default="", help="Only run branches matching this.")
+    parser.add_argument("--repeat", type=int, default=3, help="Report the best of N runs.")
+    parser.add_argument("--json", type=Path, help="Also write the results to a JSON file.")
+    args = parser.parse_args()
+
+    warnings.filterwarnings("ignore", message='"(forth|numba)" reader is only for testing')
+
+    results = []
+    header = (
+        f"{'branch':<80} {'backend':<8} {'MB/s':>10} {'entries/s':>12} {'peak RSS MB':>12}"
+    )
+    print(header)
+    print("-" * len(header))
+
+    for name in args.files:
+        test_file = uproot.open(args.data_dir / f"test_{name}.root")
+        for branch_path in getattr(conftest, f"br_{name}"):
+            if args.keyword not in branch_path:
+                continue
+
+            for backend in args.backends:
+                try:
+                    res = bench_branch(test_file[branch_path], backend, args.repeat)
+                except Exception as e:
+                    print(f"{branch_path:<80} {backend:<8} failed: {type(e).__name__}: {e}")
+                    continue
+
+                print(
+                    f"{branch_path:<80} {backend:<8} {res['MB/s']:>10.2f} "
+                    f"{res['entries/s']:>12.4g} {res['peak_rss_MB']:>12.1f}"
+                )
+                results.append(
+                    {"file": name, "branch": branch_path, "backend": backend, **res}
+                )
+
+    if args.json is not None:
+        args.json.write_text(json.dumps(results, indent=2))
+
+
+if __name__ == "__main__":
+    main()
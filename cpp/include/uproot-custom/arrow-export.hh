@@ -0,0 +1,458 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <list>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "uproot-custom.hh"
+
+/**
+ * @file arrow-export.hh
+ * @brief Export of reader outputs as Arrow arrays through the Arrow C Data Interface.
+ * @ref uproot_custom::arrow::build_node turns the output of
+ * @ref uproot_custom::IReader::data() into a tree of @ref uproot_custom::arrow::ArrowNode
+ * in one call, referencing the numpy buffers without copying them. The layout of the tree
+ * is described by a spec generated by the factories (`Factory.make_arrow_spec`), a nested
+ * tuple of:
+ *
+ * - `("primitive", format)`: a numpy array, `format` is the Arrow format, e.g. `"i"`;
+ * - `("string",)`: `(offsets, data)` of a string, exported as `large_utf8`;
+ * - `("list", divisor, element_spec)`: `(offsets, element_data)` of a sequence, exported as
+ *    `large_list`. The offsets are divided by `divisor`;
+ * - `("map", key_name, key_spec, value_name, value_spec)`: `(offsets, keys, values)` of a
+ *    map, exported as `large_list` of `struct`;
+ * - `("struct", [(name, spec or None), ...])`: a list of member data, exported as `struct`.
+ *    Members whose spec is None are left out;
+ * - `("fixed_list", size, element_spec)`: element data of a fixed-size array, exported as
+ *    `fixed_size_list`.
+ *
+ * Arrays are exported without validity bitmaps, i.e. without nulls.
+ */
+
+#ifndef ARROW_C_DATA_INTERFACE
+#    define ARROW_C_DATA_INTERFACE
+
+#    define ARROW_FLAG_DICTIONARY_ORDERED 1
+#    define ARROW_FLAG_NULLABLE 2
+#    define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    // Array type description
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+
+    // Release callback
+    void ( *release )( struct ArrowSchema* );
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+struct ArrowArray {
+    // Array data description
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+
+    // Release callback
+    void ( *release )( struct ArrowArray* );
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+#endif // ARROW_C_DATA_INTERFACE
+
+namespace uproot_custom {
+    namespace arrow {
+        /**
+         * @brief An Arrow array, whose buffers are kept alive by the node.
+         */
+        struct ArrowNode {
+            std::string format;                               ///< Arrow format string
+            std::string name;                                 ///< Field name
+            int64_t length{ 0 };                              ///< Number of elements
+            std::vector<const void*> buffers;                 ///< Buffers, validity first
+            std::vector<std::shared_ptr<ArrowNode>> children; ///< Child arrays
+            std::vector<py::object> owners;                   ///< Arrays holding buffers
+            std::list<std::vector<uint8_t>> owned;            ///< Converted buffers
+        };
+
+        /**
+         * @brief Private data of an exported @ref ArrowSchema.
+         */
+        struct SchemaPrivate {
+            std::string format;
+            std::string name;
+            std::vector<ArrowSchema> children;
+            std::vector<ArrowSchema*> child_ptrs;
+        };
+
+        /**
+         * @brief Private data of an exported @ref ArrowArray. The node holds references to
+         * numpy arrays, so it is only destroyed with the GIL held.
+         */
+        struct ArrayPrivate {
+            std::shared_ptr<ArrowNode> node;
+            std::vector<ArrowArray> children;
+            std::vector<ArrowArray*> child_ptrs;
+        };
+
+        inline void release_schema( ArrowSchema* schema ) {
+            auto priv = static_cast<SchemaPrivate*>( schema->private_data );
+            for ( auto child : priv->child_ptrs )
+                if ( child->release ) child->release( child );
+            delete priv;
+            schema->release = nullptr;
+        }
+
+        inline void release_array( ArrowArray* array ) {
+            auto priv = static_cast<ArrayPrivate*>( array->private_data );
+            for ( auto child : priv->child_ptrs )
+                if ( child->release ) child->release( child );
+            {
+                py::gil_scoped_acquire gil;
+                delete priv;
+            }
+            array->release = nullptr;
+        }
+
+        /**
+         * @brief Describe the type of a node tree in an @ref ArrowSchema.
+         */
+        inline void export_schema( const ArrowNode& node, ArrowSchema* out ) {
+            auto priv    = new SchemaPrivate();
+            priv->format = node.format;
+            priv->name   = node.name;
+            priv->children.resize( node.children.size() );
+            for ( size_t i = 0; i < node.children.size(); i++ )
+            {
+                export_schema( *node.children[i], &priv->children[i] );
+                priv->child_ptrs.push_back( &priv->children[i] );
+            }
+
+            out->format       = priv->format.c_str();
+            out->name         = priv->name.c_str();
+            out->metadata     = nullptr;
+            out->flags        = 0;
+            out->n_children   = priv->child_ptrs.size();
+            out->children     = priv->child_ptrs.empty() ? nullptr : priv->child_ptrs.data();
+            out->dictionary   = nullptr;
+            out->release      = &release_schema;
+            out->private_data = priv;
+        }
+
+        /**
+         * @brief Describe the data of a node tree in an @ref ArrowArray. The exported array
+         * shares the node and its buffers.
+         */
+        inline void export_array( std::shared_ptr<ArrowNode> node, ArrowArray* out ) {
+            auto priv  = new ArrayPrivate();
+            priv->node = node;
+            priv->children.resize( node->children.size() );
+            for ( size_t i = 0; i < node->children.size(); i++ )
+            {
+                export_array( node->children[i], &priv->children[i] );
+                priv->child_ptrs.push_back( &priv->children[i] );
+            }
+
+            out->length       = node->length;
+            out->null_count   = 0;
+            out->offset       = 0;
+            out->n_buffers    = node->buffers.size();
+            out->n_children   = priv->child_ptrs.size();
+            out->buffers      = node->buffers.data();
+            out->children     = priv->child_ptrs.empty() ? nullptr : priv->child_ptrs.data();
+            out->dictionary   = nullptr;
+            out->release      = &release_array;
+            out->private_data = priv;
+        }
+
+        /**
+         * @brief Get a C-contiguous, native byte order version of a numpy array, converting
+         * it only if needed.
+         */
+        inline py::buffer_info native_buffer( py::handle raw, ArrowNode& node ) {
+            auto numpy = py::module_::import( "numpy" );
+            py::object arr = numpy.attr( "ascontiguousarray" )( raw );
+            auto dtype     = arr.attr( "dtype" );
+            if ( !dtype.attr( "isnative" ).cast<bool>() )
+                arr = arr.attr( "astype" )( dtype.attr( "newbyteorder" )( "=" ) );
+
+            node.owners.push_back( arr );
+            return arr.cast<py::buffer>().request();
+        }
+
+        /**
+         * @brief Read a native byte order integer of `size` bytes.
+         */
+        inline int64_t load_integer( const uint8_t* ptr, const ssize_t size,
+                                     const bool is_unsigned ) {
+            switch ( size )
+            {
+            case 1:
+                return is_unsigned ? int64_t( *ptr )
+                                   : int64_t( *reinterpret_cast<const int8_t*>( ptr ) );
+            case 2:
+                return is_unsigned ? int64_t( *reinterpret_cast<const uint16_t*>( ptr ) )
+                                   : int64_t( *reinterpret_cast<const int16_t*>( ptr ) );
+            case 4:
+                return is_unsigned ? int64_t( *reinterpret_cast<const uint32_t*>( ptr ) )
+                                   : int64_t( *reinterpret_cast<const int32_t*>( ptr ) );
+            default: return *reinterpret_cast<const int64_t*>( ptr );
+            }
+        }
+
+        /**
+         * @brief Get the offsets of a sequence as int64, divided by `divisor`. Int32 offsets
+         * and unsigned counts, see @ref make_offsets_array, are widened into a buffer owned by
+         * the node.
+         */
+        inline const int64_t* offsets_buffer( py::handle raw, ArrowNode& node,
+                                              const int64_t divisor, int64_t& length ) {
+            auto info = native_buffer( raw, node );
+
+            // last character of the struct format, e.g. "i" for int32 or "B" for uint8
+            const char type       = info.format.empty() ? '?' : info.format.back();
+            const bool is_counts  = std::string( "BHILQ" ).find( type ) != std::string::npos;
+            const bool is_offsets = std::string( "bhilq" ).find( type ) != std::string::npos;
+            if ( !is_counts && ( !is_offsets || info.size < 1 ) )
+                throw std::runtime_error( "arrow export: offsets of " + node.name +
+                                          " must be a non-empty array of signed offsets, or "
+                                          "an array of unsigned counts!" );
+
+            length = is_counts ? info.size : info.size - 1;
+            if ( is_offsets && info.itemsize == sizeof( int64_t ) && divisor == 1 )
+                return static_cast<const int64_t*>( info.ptr );
+
+            auto& widened = node.owned.emplace_back( ( length + 1 ) * sizeof( int64_t ) );
+            auto out      = reinterpret_cast<int64_t*>( widened.data() );
+            auto bytes    = static_cast<const uint8_t*>( info.ptr );
+            int64_t total = 0;
+            for ( ssize_t i = 0; i < info.size; i++ )
+            {
+                auto value =
+                    load_integer( bytes + i * info.itemsize, info.itemsize, is_counts );
+                if ( !is_counts ) out[i] = value / divisor;
+                else
+                {
+                    out[i] = total / divisor;
+                    total += value;
+                }
+            }
+            if ( is_counts ) out[length] = total / divisor;
+            return out;
+        }
+
+        /**
+         * @brief Size in bytes of the values of a primitive Arrow format, 0 for booleans.
+         */
+        inline ssize_t primitive_size( const std::string& format ) {
+            if ( format == "b" ) return 0;
+            if ( format == "c" || format == "C" ) return 1;
+            if ( format == "s" || format == "S" ) return 2;
+            if ( format == "i" || format == "I" || format == "f" ) return 4;
+            if ( format == "l" || format == "L" || format == "g" ) return 8;
+            throw std::runtime_error( "arrow export: unsupported primitive format " + format );
+        }
+
+        /**
+         * @brief Build the node tree of a reader output, see the file documentation.
+         *
+         * @param raw Output of @ref IReader::data(), or a part of it.
+         * @param spec Layout of `raw`.
+         * @param name Field name of the node.
+         * @return The node tree.
+         */
+        inline std::shared_ptr<ArrowNode> build_node( py::handle raw, py::handle spec,
+                                                      const std::string& name ) {
+            auto node  = std::make_shared<ArrowNode>();
+            node->name = name;
+
+            auto spec_seq = py::reinterpret_borrow<py::sequence>( spec );
+            auto kind     = spec_seq[0].cast<std::string>();
+
+            if ( kind == "primitive" )
+            {
+                node->format = spec_seq[1].cast<std::string>();
+                auto size    = primitive_size( node->format );
+                auto info    = native_buffer( raw, *node );
+                node->length = info.size;
+
+                if ( size == 0 )
+                {
+                    // booleans are bit-packed, least significant bit first
+                    auto values = static_cast<const uint8_t*>( info.ptr );
+                    auto& bits  = node->owned.emplace_back( ( info.size + 7 ) / 8, 0 );
+                    for ( ssize_t i = 0; i < info.size; i++ )
+                        if ( values[i * info.itemsize] ) bits[i / 8] |= 1 << ( i % 8 );
+                    node->buffers = { nullptr, bits.data() };
+                }
+                else if ( info.itemsize != size )
+                {
+                    std::stringstream msg;
+                    msg << "arrow export: " << name << " has values of " << info.itemsize
+                        << " bytes, expect " << size << " for format " << node->format;
+                    throw std::runtime_error( msg.str() );
+                }
+                else node->buffers = { nullptr, info.ptr };
+            }
+            else if ( kind == "string" )
+            {
+                auto raw_seq = py::reinterpret_borrow<py::sequence>( raw );
+                node->format = "U";
+                auto offsets = offsets_buffer( raw_seq[0], *node, 1, node->length );
+                auto data    = native_buffer( raw_seq[1], *node );
+                node->buffers = { nullptr, offsets, data.ptr };
+            }
+            else if ( kind == "list" )
+            {
+                auto raw_seq  = py::reinterpret_borrow<py::sequence>( raw );
+                auto divisor  = spec_seq[1].cast<int64_t>();
+                node->format  = "+L";
+                auto offsets  = offsets_buffer( raw_seq[0], *node, divisor, node->length );
+                node->buffers = { nullptr, offsets };
+                node->children.push_back( build_node( raw_seq[1], spec_seq[2], "item" ) );
+            }
+            else if ( kind == "map" )
+            {
+                auto raw_seq  = py::reinterpret_borrow<py::sequence>( raw );
+                node->format  = "+L";
+                auto offsets  = offsets_buffer( raw_seq[0], *node, 1, node->length );
+                node->buffers = { nullptr, offsets };
+
+                auto entries     = std::make_shared<ArrowNode>();
+                entries->name    = "item";
+                entries->format  = "+s";
+                entries->buffers = { nullptr };
+                entries->children.push_back(
+                    build_node( raw_seq[1], spec_seq[2], spec_seq[1].cast<std::string>() ) );
+                entries->children.push_back(
+                    build_node( raw_seq[2], spec_seq[4], spec_seq[3].cast<std::string>() ) );
+                entries->length = entries->children[0]->length;
+                node->children.push_back( entries );
+            }
+            else if ( kind == "struct" )
+            {
+                auto raw_seq  = py::reinterpret_borrow<py::sequence>( raw );
+                auto members  = py::reinterpret_borrow<py::sequence>( spec_seq[1] );
+                node->format  = "+s";
+                node->buffers = { nullptr };
+                for ( size_t i = 0; i < members.size(); i++ )
+                {
+                    auto member      = py::reinterpret_borrow<py::sequence>( members[i] );
+                    py::object child = member[1];
+                    if ( child.is_none() ) continue;
+
+                    auto member_name = member[0].cast<std::string>();
+                    node->children.push_back( build_node( raw_seq[i], child, member_name ) );
+                }
+
+                if ( node->children.empty() )
+                    throw std::runtime_error( "arrow export: struct " + name +
+                                              " has no members!" );
+
+                node->length = node->children[0]->length;
+                for ( auto& child : node->children )
+                {
+                    if ( child->length == node->length ) continue;
+                    std::stringstream msg;
+                    msg << "arrow export: member " << child->name << " of " << name
+                        << " has " << child->length << " elements, expect " << node->length;
+                    throw std::runtime_error( msg.str() );
+                }
+            }
+            else if ( kind == "fixed_list" )
+            {
+                auto size     = spec_seq[1].cast<int64_t>();
+                node->format  = "+w:" + std::to_string( size );
+                node->buffers = { nullptr };
+                node->children.push_back( build_node( raw, spec_seq[2], "item" ) );
+
+                auto n_elements = node->children[0]->length;
+                if ( size <= 0 || n_elements % size != 0 )
+                {
+                    std::stringstream msg;
+                    msg << "arrow export: " << n_elements << " elements of " << name
+                        << " do not fill arrays of size " << size;
+                    throw std::runtime_error( msg.str() );
+                }
+                node->length = n_elements / size;
+            }
+            else throw std::runtime_error( "arrow export: unknown spec kind " + kind );
+
+            return node;
+        }
+
+        /**
+         * @brief A node tree exported through the Arrow PyCapsule interface, e.g.
+         * `pyarrow.array(export)`.
+         */
+        class ArrowExport {
+          private:
+            std::shared_ptr<ArrowNode> m_root;
+
+            static void delete_schema( PyObject* capsule ) {
+                auto schema = static_cast<ArrowSchema*>(
+                    PyCapsule_GetPointer( capsule, "arrow_schema" ) );
+                if ( schema->release ) schema->release( schema );
+                delete schema;
+            }
+
+            static void delete_array( PyObject* capsule ) {
+                auto array =
+                    static_cast<ArrowArray*>( PyCapsule_GetPointer( capsule, "arrow_array" ) );
+                if ( array->release ) array->release( array );
+                delete array;
+            }
+
+          public:
+            /**
+             * @brief Build the node tree of a reader output.
+             *
+             * @param raw_data Output of @ref IReader::data().
+             * @param spec Layout of `raw_data`, see the file documentation.
+             */
+            ArrowExport( py::object raw_data, py::object spec )
+                : m_root( build_node( raw_data, spec, "" ) ) {}
+
+            /**
+             * @brief Number of elements of the top-level array.
+             */
+            int64_t length() const { return m_root->length; }
+
+            /**
+             * @brief Export the schema as a PyCapsule named `arrow_schema`.
+             */
+            py::capsule c_schema() const {
+                auto schema = new ArrowSchema();
+                export_schema( *m_root, schema );
+                return py::capsule( schema, "arrow_schema", &delete_schema );
+            }
+
+            /**
+             * @brief Export the schema and the array as PyCapsules named `arrow_schema` and
+             * `arrow_array`. Requested schemas are not supported and ignored.
+             */
+            py::tuple c_array( py::object /* requested_schema */ ) const {
+                auto array = new ArrowArray();
+                export_array( m_root, array );
+                return py::make_tuple( c_schema(),
+                                       py::capsule( array, "arrow_array", &delete_array ) );
+            }
+        };
+    } // namespace arrow
+} // namespace uproot_custom
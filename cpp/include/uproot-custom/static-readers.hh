@@ -0,0 +1,325 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "uproot-custom.hh"
+
+/**
+ * @file static-readers.hh
+ * @brief Reader nodes composed at compile time. A reader tree like
+ * `STLSeq<STLMap<Primitive<int>, Primitive<double>>>` holds its children by value and
+ * calls them without virtual dispatch, so the compiler can inline the whole tree. Wrap
+ * the top node in @ref uproot_custom::StaticReader to use it as an @ref
+ * uproot_custom::IReader:
+ *
+ * @code{.cpp}
+ * using namespace uproot_custom;
+ * using VecMapReader = StaticReader<
+ *     static_reader::STLSeq<static_reader::STLMap<static_reader::Primitive<int>,
+ *                                                 static_reader::Primitive<double>>>>;
+ *
+ * PYBIND11_MODULE( my_module, m ) {
+ *     declare_reader<VecMapReader, std::string>( m, "VecMapReader" );
+ * }
+ * @endcode
+ *
+ * The nodes produce the same data as the corresponding generic readers, so the same
+ * factories can consume it. Only object-wise data is supported; member-wise containers
+ * throw and should use the generic readers.
+ *
+ * A node is any type providing `read`, `read_many`, `read_until`, `reset`, `reserve`
+ * and `data` with the same meaning as in @ref uproot_custom::IReader, but non-virtual.
+ */
+
+namespace uproot_custom {
+    namespace static_reader {
+        /**
+         * @brief Read the `fVersion` of a container and reject member-wise data.
+         */
+        inline void read_objwise_version( BinaryStream& stream, const char* node_name ) {
+            auto fVersion = stream.read_fVersion();
+            if ( fVersion & kStreamedMemberWise )
+                throw std::runtime_error( std::string( node_name ) +
+                                          ": member-wise data is not supported by static "
+                                          "readers, use the generic reader instead!" );
+        }
+
+        /**
+         * @brief Node for primitive types. Same data as `PrimitiveReader<T>`.
+         *
+         * @tparam T The primitive type.
+         */
+        template <typename T>
+        class Primitive {
+          private:
+            shared_ptr<ArenaVector<T>> m_data{ std::make_shared<ArenaVector<T>>() };
+
+          public:
+            void read( BinaryStream& stream ) { m_data->push_back( stream.read<T>() ); }
+
+            uint32_t read_many( BinaryStream& stream, const int64_t count ) {
+                if ( count <= 0 ) return 0;
+                auto old_size = m_data->size();
+                m_data->resize( old_size + count );
+                stream.read_array( m_data->data() + old_size, count );
+                return count;
+            }
+
+            uint32_t read_until( BinaryStream& stream, const uint8_t* end_pos ) {
+                if ( stream.get_cursor() >= end_pos ) return 0;
+                auto count = ( end_pos - stream.get_cursor() + sizeof( T ) - 1 ) / sizeof( T );
+                return read_many( stream, count );
+            }
+
+            void reset() { m_data = std::make_shared<ArenaVector<T>>(); }
+
+            void reserve( const uint64_t n_entries, const uint64_t n_bytes ) {
+                auto n_values = n_entries ? n_entries : n_bytes / sizeof( T );
+                m_data->reserve( m_data->size() + n_values );
+            }
+
+            py::object data() const { return make_array( m_data ); }
+        };
+
+        /**
+         * @brief Node for `std::string`. Same data as `STLStringReader`.
+         *
+         * @tparam WithHeader Whether the string has a `fNBytes+fVersion` header.
+         */
+        template <bool WithHeader = false>
+        class STLString {
+          private:
+            shared_ptr<ArenaVector<int64_t>> m_offsets{
+                std::make_shared<ArenaVector<int64_t>>( 1, 0 ) };
+            shared_ptr<ArenaVector<uint8_t>> m_data{
+                std::make_shared<ArenaVector<uint8_t>>() };
+
+            void read_header( BinaryStream& stream ) {
+                stream.read_fNBytes();
+                stream.read_fVersion();
+            }
+
+            void read_body( BinaryStream& stream ) {
+                auto [payload, fSize] = stream.read_TString_view();
+                m_offsets->push_back( m_offsets->back() + fSize );
+                m_data->insert( m_data->end(), payload, payload + fSize );
+            }
+
+          public:
+            void read( BinaryStream& stream ) {
+                if constexpr ( WithHeader ) read_header( stream );
+                read_body( stream );
+            }
+
+            uint32_t read_many( BinaryStream& stream, const int64_t count ) {
+                if ( count <= 0 ) return 0;
+                if constexpr ( WithHeader ) read_header( stream );
+                for ( int64_t i = 0; i < count; i++ ) read_body( stream );
+                return count;
+            }
+
+            uint32_t read_until( BinaryStream& stream, const uint8_t* end_pos ) {
+                if ( stream.get_cursor() == end_pos ) return 0;
+                if constexpr ( WithHeader ) read_header( stream );
+                uint32_t cur_count = 0;
+                for ( ; stream.get_cursor() < end_pos; cur_count++ ) read_body( stream );
+                return cur_count;
+            }
+
+            void reset() {
+                m_offsets = std::make_shared<ArenaVector<int64_t>>( 1, 0 );
+                m_data    = std::make_shared<ArenaVector<uint8_t>>();
+            }
+
+            void reserve( const uint64_t n_entries, const uint64_t n_bytes ) {
+                m_offsets->reserve( m_offsets->size() + n_entries );
+                m_data->reserve( m_data->size() + n_bytes );
+            }
+
+            py::object data() const {
+                return py::make_tuple( make_array( m_offsets ), make_array( m_data ) );
+            }
+        };
+
+        /**
+         * @brief Node for STL sequences (e.g. `std::vector`, `std::list`). Same data as
+         * `STLSeqReader`.
+         *
+         * @tparam Element Node of the elements.
+         * @tparam WithHeader Whether multiple sequences share one `fNBytes+fVersion` header.
+         */
+        template <typename Element, bool WithHeader = false>
+        class STLSeq {
+          private:
+            shared_ptr<ArenaVector<int64_t>> m_offsets{
+                std::make_shared<ArenaVector<int64_t>>( 1, 0 ) };
+            Element m_element;
+
+            void read_header( BinaryStream& stream ) {
+                stream.read_fNBytes();
+                read_objwise_version( stream, "static_reader::STLSeq" );
+            }
+
+            void read_body( BinaryStream& stream ) {
+                auto fSize = stream.read<uint32_t>();
+                m_offsets->push_back( m_offsets->back() + fSize );
+                m_element.read_many( stream, fSize );
+            }
+
+          public:
+            void read( BinaryStream& stream ) {
+                read_header( stream );
+                read_body( stream );
+            }
+
+            uint32_t read_many( BinaryStream& stream, const int64_t count ) {
+                if ( count <= 0 ) return 0;
+                if constexpr ( WithHeader ) read_header( stream );
+                for ( int64_t i = 0; i < count; i++ ) read_body( stream );
+                return count;
+            }
+
+            uint32_t read_until( BinaryStream& stream, const uint8_t* end_pos ) {
+                if ( stream.get_cursor() == end_pos ) return 0;
+                if constexpr ( WithHeader ) read_header( stream );
+                uint32_t cur_count = 0;
+                for ( ; stream.get_cursor() < end_pos; cur_count++ ) read_body( stream );
+                return cur_count;
+            }
+
+            void reset() {
+                m_offsets = std::make_shared<ArenaVector<int64_t>>( 1, 0 );
+                m_element.reset();
+            }
+
+            void reserve( const uint64_t n_entries, const uint64_t n_bytes ) {
+                m_offsets->reserve( m_offsets->size() + n_entries );
+                m_element.reserve( 0, n_bytes );
+            }
+
+            py::object data() const {
+                return py::make_tuple( make_array( m_offsets ), m_element.data() );
+            }
+        };
+
+        /**
+         * @brief Node for STL maps (e.g. `std::map`, `std::unordered_map`). Same data as
+         * `STLMapReader`.
+         *
+         * @tparam Key Node of the keys.
+         * @tparam Value Node of the values.
+         * @tparam WithHeader Whether multiple maps share one `fNBytes+fVersion` header.
+         */
+        template <typename Key, typename Value, bool WithHeader = false>
+        class STLMap {
+          private:
+            shared_ptr<ArenaVector<int64_t>> m_offsets{
+                std::make_shared<ArenaVector<int64_t>>( 1, 0 ) };
+            Key m_key;
+            Value m_value;
+
+            void read_header( BinaryStream& stream ) {
+                stream.read_fNBytes();
+                read_objwise_version( stream, "static_reader::STLMap" );
+
+                // element version, followed by a checksum if 0
+                if ( stream.read_fVersion() == 0 ) stream.skip( 4 );
+            }
+
+            void read_body( BinaryStream& stream ) {
+                auto fSize = stream.read<uint32_t>();
+                m_offsets->push_back( m_offsets->back() + fSize );
+                for ( uint32_t i = 0; i < fSize; i++ )
+                {
+                    m_key.read( stream );
+                    m_value.read( stream );
+                }
+            }
+
+          public:
+            void read( BinaryStream& stream ) {
+                read_header( stream );
+                read_body( stream );
+            }
+
+            uint32_t read_many( BinaryStream& stream, const int64_t count ) {
+                if ( count <= 0 ) return 0;
+                if constexpr ( WithHeader ) read_header( stream );
+                for ( int64_t i = 0; i < count; i++ ) read_body( stream );
+                return count;
+            }
+
+            uint32_t read_until( BinaryStream& stream, const uint8_t* end_pos ) {
+                if ( stream.get_cursor() == end_pos ) return 0;
+                if constexpr ( WithHeader ) read_header( stream );
+                uint32_t cur_count = 0;
+                for ( ; stream.get_cursor() < end_pos; cur_count++ ) read_body( stream );
+                return cur_count;
+            }
+
+            void reset() {
+                m_offsets = std::make_shared<ArenaVector<int64_t>>( 1, 0 );
+                m_key.reset();
+                m_value.reset();
+            }
+
+            void reserve( const uint64_t n_entries, const uint64_t n_bytes ) {
+                m_offsets->reserve( m_offsets->size() + n_entries );
+                m_key.reserve( 0, n_bytes );
+                m_value.reserve( 0, n_bytes );
+            }
+
+            py::object data() const {
+                return py::make_tuple( make_array( m_offsets ), m_key.data(), m_value.data() );
+            }
+        };
+    } // namespace static_reader
+
+    /**
+     * @brief Adapter exposing a compile-time composed reader tree as an @ref IReader. Only
+     * the call into the top node is virtual. The whole tree shows up as one reader when
+     * profiling.
+     *
+     * @tparam Node The top node of the tree, see `static_reader`.
+     */
+    template <typename Node>
+    class StaticReader : public IReader {
+      private:
+        Node m_node; ///< The top node of the reader tree
+
+      public:
+        /**
+         * @brief Construct a new StaticReader object.
+         *
+         * @param name Name of the reader.
+         */
+        StaticReader( std::string name ) : IReader( name ) {}
+
+        void read( BinaryStream& stream ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kRead, 1 );
+            m_node.read( stream );
+        }
+
+        uint32_t read_many( BinaryStream& stream, const int64_t count ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kReadMany, count );
+            return m_node.read_many( stream, count );
+        }
+
+        uint32_t read_until( BinaryStream& stream, const uint8_t* end_pos ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kReadUntil );
+            return profile.produced( m_node.read_until( stream, end_pos ) );
+        }
+
+        void reset() override { m_node.reset(); }
+
+        void reserve( const uint64_t n_entries, const uint64_t n_bytes ) override {
+            m_node.reserve( n_entries, n_bytes );
+        }
+
+        py::object data() const override { return m_node.data(); }
+    };
+} // namespace uproot_custom
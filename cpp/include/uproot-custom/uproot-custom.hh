@@ -7,12 +7,21 @@
 #include <pybind11/pytypes.h>
 #include <pybind11/stl.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <variant>
+#include <vector>
 
 #if defined( _MSC_VER )
 #    include <stdlib.h>
@@ -27,6 +36,16 @@
 #    error "Unsupported compiler!"
 #endif
 
+#if defined( __AVX2__ ) || defined( __SSSE3__ )
+#    include <immintrin.h>
+#elif defined( __SSE2__ ) || defined( _M_X64 )
+#    include <emmintrin.h>
+#    define UPROOT_CUSTOM_SSE2
+#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+#    include <arm_neon.h>
+#    define UPROOT_CUSTOM_NEON
+#endif
+
 /**
  * @brief Macro to import the uproot_custom.cpp module.
  * @note This macro should be used in the `PYBIND11_MODULE` definition of your module.
@@ -47,6 +66,154 @@ namespace uproot_custom {
 
     constexpr uint16_t kStreamedMemberWise = 1 << 14; // streamed member-wise mask
 
+    /**
+     * @brief Copy one big-endian value of `Size` bytes from `src` to `dst`, converting it to
+     * host byte order.
+     *
+     * @tparam Size Size of the value in bytes. Must be 1, 2, 4 or 8.
+     */
+    template <size_t Size>
+    inline void bswap_copy_one( uint8_t* dst, const uint8_t* src ) {
+        static_assert( Size == 1 || Size == 2 || Size == 4 || Size == 8,
+                       "bswap_copy_one: unsupported type size (only 1, 2, 4, 8 bytes)" );
+
+        if constexpr ( Size == 1 ) *dst = *src;
+        else if constexpr ( Size == 2 )
+        {
+            uint16_t bits;
+            std::memcpy( &bits, src, 2 );
+            bits = bswap16( bits );
+            std::memcpy( dst, &bits, 2 );
+        }
+        else if constexpr ( Size == 4 )
+        {
+            uint32_t bits;
+            std::memcpy( &bits, src, 4 );
+            bits = bswap32( bits );
+            std::memcpy( dst, &bits, 4 );
+        }
+        else
+        {
+            uint64_t bits;
+            std::memcpy( &bits, src, 8 );
+            bits = bswap64( bits );
+            std::memcpy( dst, &bits, 8 );
+        }
+    }
+
+    /**
+     * @brief Copy `n` big-endian values of `Size` bytes each from `src` to `dst`, converting
+     * them to host byte order. The bulk of the block is swapped with SIMD shuffles when the
+     * target supports them (AVX2, SSSE3, SSE2 or NEON), the tail is swapped element by
+     * element.
+     *
+     * @tparam Size Size of one value in bytes. Must be 1, 2, 4 or 8.
+     * @param dst Destination buffer, must hold at least `n * Size` bytes.
+     * @param src Source buffer in big-endian byte order.
+     * @param n Number of values to copy.
+     */
+    template <size_t Size>
+    inline void bswap_copy( void* dst, const uint8_t* src, const size_t n ) {
+        static_assert( Size == 1 || Size == 2 || Size == 4 || Size == 8,
+                       "bswap_copy: unsupported type size (only 1, 2, 4, 8 bytes allowed)" );
+
+        auto out            = static_cast<uint8_t*>( dst );
+        const size_t nbytes = n * Size;
+        size_t i            = 0;
+
+        if constexpr ( Size == 1 )
+        {
+            if ( nbytes ) std::memcpy( out, src, nbytes );
+            return;
+        }
+
+#if defined( __AVX2__ ) || defined( __SSSE3__ )
+        alignas( 16 ) uint8_t lane_mask[16];
+        for ( size_t k = 0; k < 16; k++ )
+            lane_mask[k] = static_cast<uint8_t>( k / Size * Size + ( Size - 1 - k % Size ) );
+        const __m128i mask128 =
+            _mm_load_si128( reinterpret_cast<const __m128i*>( lane_mask ) );
+#endif
+
+#if defined( __AVX2__ )
+        const __m256i mask256 = _mm256_broadcastsi128_si256( mask128 );
+        for ( ; i + 32 <= nbytes; i += 32 )
+        {
+            auto v = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( src + i ) );
+            _mm256_storeu_si256( reinterpret_cast<__m256i*>( out + i ),
+                                 _mm256_shuffle_epi8( v, mask256 ) );
+        }
+#endif
+
+#if defined( __AVX2__ ) || defined( __SSSE3__ )
+        for ( ; i + 16 <= nbytes; i += 16 )
+        {
+            auto v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( out + i ),
+                              _mm_shuffle_epi8( v, mask128 ) );
+        }
+#elif defined( UPROOT_CUSTOM_SSE2 )
+        for ( ; i + 16 <= nbytes; i += 16 )
+        {
+            auto v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+            // reverse 16-bit words inside each value, then swap bytes inside each word
+            if constexpr ( Size == 4 )
+                v = _mm_shufflehi_epi16( _mm_shufflelo_epi16( v, 0xB1 ), 0xB1 );
+            else if constexpr ( Size == 8 )
+                v = _mm_shufflehi_epi16( _mm_shufflelo_epi16( v, 0x1B ), 0x1B );
+            v = _mm_or_si128( _mm_slli_epi16( v, 8 ), _mm_srli_epi16( v, 8 ) );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( out + i ), v );
+        }
+#elif defined( UPROOT_CUSTOM_NEON )
+        for ( ; i + 16 <= nbytes; i += 16 )
+        {
+            auto v = vld1q_u8( src + i );
+            if constexpr ( Size == 2 ) v = vrev16q_u8( v );
+            else if constexpr ( Size == 4 ) v = vrev32q_u8( v );
+            else v = vrev64q_u8( v );
+            vst1q_u8( out + i, v );
+        }
+#endif
+
+        for ( ; i < nbytes; i += Size ) bswap_copy_one<Size>( out + i, src + i );
+    }
+
+    /**
+     * @brief Copy `n` interleaved big-endian `(key, value)` pairs from `src` into separate
+     * key and value buffers, converting them to host byte order. This is the layout of the
+     * elements of an object-wise `std::map` of primitives.
+     *
+     * @tparam KeySize Size of one key in bytes. Must be 1, 2, 4 or 8.
+     * @tparam ValueSize Size of one value in bytes. Must be 1, 2, 4 or 8.
+     * @param keys Destination of the keys, must hold at least `n * KeySize` bytes.
+     * @param values Destination of the values, must hold at least `n * ValueSize` bytes.
+     * @param src Source buffer of `n * (KeySize + ValueSize)` bytes.
+     * @param n Number of pairs to copy.
+     */
+    template <size_t KeySize, size_t ValueSize>
+    inline void bswap_copy_pairs( void* keys, void* values, const uint8_t* src,
+                                  const size_t n ) {
+        auto key_out   = static_cast<uint8_t*>( keys );
+        auto value_out = static_cast<uint8_t*>( values );
+        for ( size_t i = 0; i < n; i++, src += KeySize + ValueSize )
+        {
+            bswap_copy_one<KeySize>( key_out + i * KeySize, src );
+            bswap_copy_one<ValueSize>( value_out + i * ValueSize, src + KeySize );
+        }
+    }
+
+    class ReadProfiler;
+
+    /**
+     * @brief Cursor over the raw data of a basket.
+     *
+     * By default, every read is checked against the end of the data, so that a corrupt
+     * basket throws `std::runtime_error` instead of reading out of bounds. Checks are made
+     * once per block: a scalar read, a call of @ref read_array() or @ref read_bytes() and a
+     * skip each compare the block size to the remaining bytes once, whatever the size of the
+     * block. For trusted data, checks can be disabled per stream with @ref set_checked(), or
+     * for all new streams with @ref set_default_checked().
+     */
     class BinaryStream {
       public:
         enum EStatusBits {
@@ -64,15 +231,60 @@ namespace uproot_custom {
                              << 13 ///< if object ctor succeeded but object should not be used
         };
 
+        /**
+         * @brief A reference registered while reading pointers: either a class, whose name
+         * is interned in the stream (see @ref intern_class_name()), or an object.
+         */
+        struct Reference {
+            enum Kind : uint8_t { kClass, kObject };
+
+            Kind kind;
+            int64_t value; ///< class id for `kClass`, object index for `kObject`
+        };
+
+        /**
+         * @brief Class reference of @ref get_refs().
+         * @deprecated Use @ref Reference instead.
+         */
         struct RefCls {
             std::string name;
         };
 
+        /**
+         * @brief Object reference of @ref get_refs().
+         * @deprecated Use @ref Reference instead.
+         */
         struct RefObj {
             int64_t index;
         };
 
-        using Reference = std::variant<RefCls, RefObj>;
+        /**
+         * @brief Reference of @ref get_refs().
+         * @deprecated Use @ref Reference instead.
+         */
+        using LegacyReference = std::variant<RefCls, RefObj>;
+
+        /**
+         * @brief Construct a BinaryStream from raw memory, e.g. a memory-mapped file. The
+         * memory is not copied, so it must outlive the stream.
+         * @param data Pointer to the raw data.
+         * @param offsets Pointer to the `n_entries + 1` offsets of the entries.
+         * @param n_entries Number of entries.
+         * @param initial_cursor_position Initial cursor position, used for calculating
+         * relative offsets.
+         * @param n_bytes Size of the data. If `kUntilLastEntry`, the data ends with the last
+         * entry, i.e. at `offsets[n_entries]`.
+         */
+        BinaryStream( const uint8_t* data, const uint32_t* offsets, const uint64_t n_entries,
+                      uint32_t initial_cursor_position,
+                      const size_t n_bytes = kUntilLastEntry )
+            : m_cursor( data )
+            , m_entries( n_entries )
+            , m_data( data )
+            , m_offsets( offsets )
+            , m_initial_cursor_offset( initial_cursor_position ) {
+            m_end = data + ( n_bytes == kUntilLastEntry ? offsets[n_entries] : n_bytes );
+        }
 
         /**
          * @brief Construct a BinaryStream from numpy arrays.
@@ -81,11 +293,13 @@ namespace uproot_custom {
          */
         BinaryStream( py::array_t<uint8_t> data, py::array_t<uint32_t> offsets,
                       uint32_t initial_cursor_position )
-            : m_data( static_cast<uint8_t*>( data.request().ptr ) )
-            , m_offsets( static_cast<uint32_t*>( offsets.request().ptr ) )
-            , m_initial_cursor_offset( initial_cursor_position )
-            , m_entries( offsets.request().size - 1 )
-            , m_cursor( static_cast<uint8_t*>( data.request().ptr ) ) {}
+            : BinaryStream( data.data(), offsets.data(), offsets.size() - 1,
+                            initial_cursor_position, data.size() ) {}
+
+        /**
+         * @brief Value of `n_bytes` meaning that the data ends with the last entry.
+         */
+        static constexpr size_t kUntilLastEntry = static_cast<size_t>( -1 );
 
         /**
          * @brief Read a value of type T from the stream, handling endianness.
@@ -96,6 +310,7 @@ namespace uproot_custom {
         template <typename T>
         const T read() {
             constexpr auto size = sizeof( T );
+            require( size );
 
             if constexpr ( size == 1 ) return *reinterpret_cast<const T*>( m_cursor++ );
             else if constexpr ( size == 2 )
@@ -137,6 +352,36 @@ namespace uproot_custom {
                     "read<T>: unsupported type size (only 1, 2, 4, 8 bytes allowed)" );
         }
 
+        /**
+         * @brief Read `n` contiguous values of type T from the stream into `dst`, handling
+         * endianness. Equivalent to calling @ref read() `n` times, but converts the whole
+         * block at once with @ref bswap_copy().
+         *
+         * @tparam T The type to read.
+         * @param dst Destination buffer, must hold at least `n` values.
+         * @param n Number of values to read.
+         */
+        template <typename T>
+        void read_array( T* dst, const size_t n ) {
+            require( n * sizeof( T ) );
+            bswap_copy<sizeof( T )>( dst, m_cursor, n );
+            m_cursor += n * sizeof( T );
+        }
+
+        /**
+         * @brief Read `n` raw bytes from the stream without converting them, e.g. to copy
+         * them elsewhere.
+         *
+         * @param n Number of bytes to read.
+         * @return Pointer to the first byte, valid as long as the underlying data buffer.
+         */
+        const uint8_t* read_bytes( const size_t n ) {
+            require( n );
+            auto start = m_cursor;
+            m_cursor += n;
+            return start;
+        }
+
         /**
          * @brief Read the fVersion field from the stream
          *
@@ -164,8 +409,7 @@ namespace uproot_custom {
          */
         const std::string read_null_terminated_string() {
             auto start = m_cursor;
-            while ( *m_cursor != 0 ) { m_cursor++; }
-            m_cursor++;
+            skip_null_terminated_string();
             return std::string( start, m_cursor );
         }
 
@@ -191,11 +435,21 @@ namespace uproot_custom {
          * @return The TString data read from the stream, as a std::string.
          */
         const std::string read_TString() {
+            auto [start, length] = read_TString_view();
+            return std::string( start, start + length );
+        }
+
+        /**
+         * @brief Read a length-prefixed payload (the format of TString and std::string) from
+         * the stream without copying. See @ref read_TString() for the format.
+         *
+         * @return A pair of (pointer to the first payload byte, payload length). The pointer
+         * is valid as long as the underlying data buffer.
+         */
+        const std::pair<const uint8_t*, uint32_t> read_TString_view() {
             uint32_t length = read<uint8_t>();
             if ( length == 255 ) length = read<uint32_t>();
-            auto start = m_cursor;
-            m_cursor += length;
-            return std::string( start, m_cursor );
+            return { read_bytes( length ), length };
         }
 
         /**
@@ -203,7 +457,10 @@ namespace uproot_custom {
          *
          * @param n Number of bytes to skip.
          */
-        void skip( const size_t n ) { m_cursor += n; }
+        void skip( const size_t n ) {
+            require( n );
+            m_cursor += n;
+        }
 
         /**
          * @brief Skip the fNBytes field. Equivalent to read_fNBytes() but does not return the
@@ -220,6 +477,15 @@ namespace uproot_custom {
          * @brief Skip a null-terminated (`\0`) string in the stream.
          */
         void skip_null_terminated_string() {
+            if ( m_checked )
+            {
+                // search the whole string at once instead of checking each byte
+                auto end = static_cast<const uint8_t*>(
+                    std::memchr( m_cursor, 0, std::max<ptrdiff_t>( m_end - m_cursor, 0 ) ) );
+                if ( end == nullptr ) throw_out_of_bounds( m_end - m_cursor + 1 );
+                m_cursor = end + 1;
+                return;
+            }
             while ( *m_cursor != 0 ) { m_cursor++; }
             m_cursor++;
         }
@@ -248,7 +514,7 @@ namespace uproot_custom {
         }
 
         /**
-         * @brief Get the raw data pointer.
+         * @brief Get the raw data pointer of the current window, see @ref set_window().
          */
         const uint8_t* get_data() const { return m_data; }
 
@@ -262,12 +528,45 @@ namespace uproot_custom {
          */
         const uint32_t* get_offsets() const { return m_offsets; }
 
+        /**
+         * @brief Get the end of the readable data of the current window.
+         */
+        const uint8_t* get_end() const { return m_end; }
+
+        /**
+         * @brief Whether the reads are checked against the end of the data.
+         */
+        const bool checked() const { return m_checked; }
+
+        /**
+         * @brief Enable or disable the bounds checks of this stream. Only disable them for
+         * trusted data: reading a corrupt basket unchecked is undefined behavior.
+         */
+        void set_checked( const bool checked ) { m_checked = checked; }
+
+        /**
+         * @brief Whether new streams check their reads, see @ref set_default_checked().
+         */
+        static bool default_checked() { return s_default_checked; }
+
+        /**
+         * @brief Enable or disable the bounds checks of the streams constructed afterwards.
+         * Checks are enabled by default.
+         *
+         * @note The default is not shared across extension modules: each module including
+         * this header has its own copy. `uproot_custom.cpp.set_bounds_checks()` sets the one
+         * of the built-in module, whose `read_data` functions construct the streams passed
+         * to all readers, including the readers of other modules. Streams constructed by
+         * another module follow the default of that module, see @ref set_checked().
+         */
+        static void set_default_checked( const bool checked ) { s_default_checked = checked; }
+
         /**
          * @brief Get the index object
          *
          * @return const uint32_t
          */
-        const uint32_t get_index() const { return m_cursor - m_data; }
+        const uint32_t get_index() const { return m_cursor - m_data + m_data_index; }
 
         /**
          * @brief Get the initial cursor offset, which is used for calculating relative
@@ -278,17 +577,192 @@ namespace uproot_custom {
         const uint32_t get_initial_cursor_offset() const { return m_initial_cursor_offset; }
 
         /**
-         * @brief Get the references map, which is used for pointer reading.
+         * @brief Find a reference by its tag.
+         *
+         * @param key The reference tag, must not be 0.
+         * @return Pointer to the reference, or nullptr if the tag is not registered.
+         */
+        const Reference* find_ref( const uint32_t key ) const {
+            if ( m_ref_keys.empty() ) return nullptr;
+
+            const size_t mask = m_ref_keys.size() - 1;
+            size_t i          = hash_ref_key( key ) & mask;
+            while ( m_ref_keys[i] != 0 )
+            {
+                if ( m_ref_keys[i] == key ) return &m_ref_values[i];
+                i = ( i + 1 ) & mask;
+            }
+            return nullptr;
+        }
+
+        /**
+         * @brief Register a reference, replacing any previous one with the same tag.
+         *
+         * @param key The reference tag, must not be 0.
+         * @param ref The reference.
+         */
+        void set_ref( const uint32_t key, const Reference ref ) {
+            // keep the load factor below 1/2 so that probe sequences stay short
+            if ( ( m_n_refs + 1 ) * 2 > m_ref_keys.size() )
+                rehash_refs( std::max<size_t>( 16, m_ref_keys.size() * 2 ) );
+
+            const size_t mask = m_ref_keys.size() - 1;
+            size_t i          = hash_ref_key( key ) & mask;
+            while ( m_ref_keys[i] != 0 && m_ref_keys[i] != key ) i = ( i + 1 ) & mask;
+
+            if ( m_ref_keys[i] == 0 ) m_n_refs++;
+            m_ref_keys[i]   = key;
+            m_ref_values[i] = ref;
+        }
+
+        /**
+         * @brief Get the number of references registered in the stream, including those
+         * discarded by @ref reset_refs(). Tags of objects written without byte count are
+         * numbered from it, so they do not depend on whether the references are reset.
+         */
+        const size_t n_refs() const { return m_n_reset_refs + m_n_refs; }
+
+        /**
+         * @brief Get the number of slots of the reference table, a power of 2 at least twice
+         * the number of registered references.
+         */
+        const size_t ref_capacity() const { return m_ref_keys.size(); }
+
+        /**
+         * @brief Discard the registered references. The numbering of @ref n_refs() goes on,
+         * and interned class names are kept.
+         */
+        void reset_refs() {
+            std::fill( m_ref_keys.begin(), m_ref_keys.end(), 0 );
+            m_n_reset_refs += m_n_refs;
+            m_n_refs = 0;
+            m_legacy_refs.clear();
+        }
+
+        /**
+         * @brief Discard the references registered in previous entries, see @ref
+         * reset_refs(). Readers call it before resolving references when the references
+         * of an entry cannot point to other entries, so that the table stays small. Calls
+         * within the same entry do nothing.
+         */
+        void reset_refs_per_entry() {
+            if ( m_refs_entry == m_current_entry ) return;
+            if ( m_n_refs ) reset_refs();
+            m_refs_entry = m_current_entry;
+        }
+
+        /**
+         * @brief Build a map of the registered references. Changes to the map are merged
+         * back into the references (added or replaced entries only) by the next call.
+         *
+         * @deprecated Building the map copies all references, use @ref find_ref() and @ref
+         * set_ref() instead.
          *
          * @return The references map.
          */
-        std::map<uint32_t, Reference>& get_refs() { return m_refs; }
+        [[deprecated( "get_refs() copies all references. Use find_ref() and set_ref() "
+                      "instead." )]] std::map<uint32_t, LegacyReference>&
+        get_refs() {
+            for ( const auto& [key, ref] : m_legacy_refs )
+            {
+                if ( auto cls = std::get_if<RefCls>( &ref ) )
+                    set_ref( key, { Reference::kClass, intern_class_name( cls->name ) } );
+                else set_ref( key, { Reference::kObject, std::get<RefObj>( ref ).index } );
+            }
+
+            m_legacy_refs.clear();
+            for ( size_t i = 0; i < m_ref_keys.size(); i++ )
+            {
+                if ( m_ref_keys[i] == 0 ) continue;
+                const auto& ref = m_ref_values[i];
+                if ( ref.kind == Reference::kClass )
+                    m_legacy_refs[m_ref_keys[i]] = RefCls{ class_name( ref.value ) };
+                else m_legacy_refs[m_ref_keys[i]] = RefObj{ ref.value };
+            }
+            return m_legacy_refs;
+        }
+
+        /**
+         * @brief Get the id of a class name, registering it if it is new. Ids are only valid
+         * within this stream.
+         *
+         * @param name The class name.
+         * @return The id of the class name.
+         */
+        uint32_t intern_class_name( const std::string& name ) {
+            // a branch references only a handful of classes, a linear scan is the fastest
+            for ( uint32_t i = 0; i < m_class_names.size(); i++ )
+                if ( m_class_names[i] == name ) return i;
+            m_class_names.push_back( name );
+            return m_class_names.size() - 1;
+        }
+
+        /**
+         * @brief Get the class name of an id returned by @ref intern_class_name().
+         */
+        const std::string& class_name( const uint32_t id ) const { return m_class_names[id]; }
 
         /**
          * @brief Get the number of entries.
          */
         const uint64_t entries() const { return m_entries; }
 
+        /**
+         * @brief Get the index of the entry currently being read.
+         */
+        const uint64_t current_entry() const { return m_current_entry; }
+
+        /**
+         * @brief Set the index of the entry currently being read. Called by the entry loop
+         * (e.g. `read_data`) before reading each entry.
+         *
+         * @param i_entry Index of the entry.
+         */
+        void set_current_entry( const uint64_t i_entry ) { m_current_entry = i_entry; }
+
+        /**
+         * @brief Get the end position of the entry currently being read.
+         *
+         * @return Pointer to the first byte after the current entry.
+         */
+        const uint8_t* current_entry_end() const {
+            return m_data + ( m_offsets[m_current_entry + 1] - m_data_index );
+        }
+
+        /**
+         * @brief Continue reading from another window of the same data, e.g. the next chunk
+         * of a basket fed piece by piece. The entry offsets and the registered references
+         * are kept. Moves the cursor to the beginning of the window.
+         *
+         * @param data Pointer to the window.
+         * @param data_index Position of the window in the whole data, the same unit as the
+         * entry offsets.
+         * @param n_bytes Size of the window. If `kUntilLastEntry`, the window ends with the
+         * last entry.
+         */
+        void set_window( const uint8_t* data, const uint32_t data_index,
+                         const size_t n_bytes = kUntilLastEntry ) {
+            m_data       = data;
+            m_data_index = data_index;
+            m_cursor     = data;
+            m_end = data + ( n_bytes == kUntilLastEntry ? m_offsets[m_entries] - data_index
+                                                        : n_bytes );
+        }
+
+        /**
+         * @brief Get the profiler recording the reader calls, see @ref ReadProfiler.
+         *
+         * @return The profiler, or nullptr if profiling is disabled.
+         */
+        ReadProfiler* profiler() const { return m_profiler; }
+
+        /**
+         * @brief Set the profiler recording the reader calls.
+         *
+         * @param profiler The profiler, or nullptr to disable profiling.
+         */
+        void set_profiler( ReadProfiler* profiler ) { m_profiler = profiler; }
+
         /**
          * @brief Debug print the next `n` bytes from the current cursor.
          *
@@ -300,15 +774,67 @@ namespace uproot_custom {
         }
 
       private:
-        uint8_t* m_cursor;                      ///< current cursor position
+        const uint8_t* m_cursor;                ///< current cursor position
         const uint64_t m_entries;               ///< number of entries
         const uint8_t* m_data;                  ///< raw data pointer
+        uint32_t m_data_index{ 0 };             ///< position of @ref m_data in the whole data
         const uint32_t* m_offsets;              ///< entry offsets pointer
         const uint32_t m_initial_cursor_offset; ///< initial cursor position, used for
                                                 ///< calculating relative offsets
+        const uint8_t* m_end;                   ///< end of the readable data of the window
+        bool m_checked{ s_default_checked };    ///< whether reads are checked against m_end
+        uint64_t m_current_entry{ 0 };          ///< index of the entry being read
+        ReadProfiler* m_profiler{ nullptr };    ///< optional profiler of the reader calls
+
+        inline static std::atomic<bool> s_default_checked{ true }; ///< one per module
 
-        std::map<uint32_t, Reference> m_refs; ///< offset -> reference, used for pointer
-                                              ///< reading
+        /**
+         * @brief Throw if fewer than `n` bytes are left in a checked stream.
+         */
+        void require( const size_t n ) const {
+            if ( m_checked && ( m_cursor > m_end || n > size_t( m_end - m_cursor ) ) )
+                throw_out_of_bounds( n );
+        }
+
+        [[noreturn]] void throw_out_of_bounds( const size_t n ) const {
+            std::stringstream msg;
+            msg << "BinaryStream: Read of " << n << " bytes at position " << get_index()
+                << " of entry " << m_current_entry << " is out of bounds, only "
+                << std::max<ptrdiff_t>( m_end - m_cursor, 0 ) << " bytes left!";
+            throw std::runtime_error( msg.str() );
+        }
+
+        // Open-addressing hash table of pointer references, tag -> reference. Tag 0 (null
+        // pointer) is never registered, so it marks empty slots.
+        std::vector<uint32_t> m_ref_keys;    ///< reference tags, size is a power of 2
+        std::vector<Reference> m_ref_values; ///< references, parallel to @ref m_ref_keys
+        size_t m_n_refs{ 0 };                ///< number of registered references
+        size_t m_n_reset_refs{ 0 };          ///< number of references discarded by resets
+        uint64_t m_refs_entry{ 0 };          ///< entry of @ref reset_refs_per_entry()
+        std::vector<std::string> m_class_names; ///< interned class names
+        std::map<uint32_t, LegacyReference> m_legacy_refs; ///< map of @ref get_refs()
+
+        static size_t hash_ref_key( const uint32_t key ) {
+            // tags are byte offsets, spread them with a Fibonacci hash
+            return ( static_cast<uint64_t>( key ) * 0x9E3779B97F4A7C15ULL ) >> 32;
+        }
+
+        void rehash_refs( const size_t new_size ) {
+            std::vector<uint32_t> old_keys( new_size, 0 );
+            std::vector<Reference> old_values( new_size );
+            m_ref_keys.swap( old_keys );
+            m_ref_values.swap( old_values );
+
+            const size_t mask = new_size - 1;
+            for ( size_t j = 0; j < old_keys.size(); j++ )
+            {
+                if ( old_keys[j] == 0 ) continue;
+                size_t i = hash_ref_key( old_keys[j] ) & mask;
+                while ( m_ref_keys[i] != 0 ) i = ( i + 1 ) & mask;
+                m_ref_keys[i]   = old_keys[j];
+                m_ref_values[i] = old_values[j];
+            }
+        }
     };
 
     // backward compatibility
@@ -322,6 +848,190 @@ namespace uproot_custom {
     -----------------------------------------------------------------------------
     */
 
+    class IReader;
+
+    /**
+     * @brief Per-reader statistics collected while reading, enabled by `read_data(...,
+     * profile=True)`. Readers record their calls with a @ref ProfileScope, and nested calls
+     * form a tree of the readers.
+     */
+    class ReadProfiler {
+      public:
+        enum Method : uint8_t { kRead, kReadMany, kReadUntil, kReadManyMemberwise, kNMethods };
+
+        /**
+         * @brief Statistics of a reader at one position of the tree.
+         */
+        struct Node {
+            const IReader* reader;            ///< the reader, nullptr for the root node
+            std::string name;                 ///< name of the reader
+            uint64_t n_calls[kNMethods]{};    ///< number of calls of each method
+            uint64_t n_bytes{ 0 };            ///< bytes consumed, including sub-readers
+            uint64_t n_elements{ 0 };         ///< number of elements produced
+            uint64_t time_ns{ 0 };            ///< time spent, including sub-readers
+            std::vector<uint32_t> children{}; ///< node indices of the sub-readers
+        };
+
+        ReadProfiler() : m_nodes( 1, Node{ nullptr, "" } ), m_stack( 1, 0 ) {}
+
+        /**
+         * @brief Record a call of a reader method. Calls of a reader into itself (e.g. the
+         * default @ref IReader::read_many() calling @ref IReader::read()) are counted, but
+         * their bytes, elements and time are left to the outer call.
+         *
+         * @param reader The reader being called.
+         * @param method The method being called.
+         * @return Index of the node to pass to @ref leave(), or 0 for calls into itself.
+         */
+        uint32_t enter( const IReader* reader, const Method method );
+
+        /**
+         * @brief Finish a call recorded by @ref enter().
+         *
+         * @param node The index returned by @ref enter().
+         * @param n_bytes Number of bytes consumed by the call.
+         * @param n_elements Number of elements produced by the call.
+         * @param time_ns Time spent in the call.
+         */
+        void leave( const uint32_t node, const uint64_t n_bytes, const uint64_t n_elements,
+                    const uint64_t time_ns ) {
+            auto& stats = m_nodes[node];
+            stats.n_bytes += n_bytes;
+            stats.n_elements += n_elements;
+            stats.time_ns += time_ns;
+            m_stack.pop_back();
+        }
+
+        /**
+         * @brief Get the recorded statistics. Node 0 is the root, whose children are the top
+         * readers.
+         */
+        const std::vector<Node>& nodes() const { return m_nodes; }
+
+        /**
+         * @brief Get the recorded statistics as a tree of Python dicts keyed by the reader
+         * names. Each reader maps to a dict with `calls` (per method), `bytes`, `elements`,
+         * `time_ns`, `self_time_ns` (excluding sub-readers) and `children`.
+         */
+        py::dict report() const { return children_report( 0 ); }
+
+      private:
+        std::vector<Node> m_nodes;     ///< recorded nodes, node 0 is the root
+        std::vector<uint32_t> m_stack; ///< nodes of the calls in progress
+
+        py::dict children_report( const uint32_t node ) const {
+            static const char* method_names[kNMethods] = { "read", "read_many", "read_until",
+                                                           "read_many_memberwise" };
+            py::dict res;
+            for ( auto i_child : m_nodes[node].children )
+            {
+                const auto& child = m_nodes[i_child];
+
+                py::dict calls;
+                for ( int i = 0; i < kNMethods; i++ )
+                    calls[method_names[i]] = child.n_calls[i];
+
+                uint64_t children_time_ns = 0;
+                for ( auto i : child.children ) children_time_ns += m_nodes[i].time_ns;
+
+                py::dict stats;
+                stats["calls"]    = calls;
+                stats["bytes"]    = child.n_bytes;
+                stats["elements"] = child.n_elements;
+                stats["time_ns"]  = child.time_ns;
+                stats["self_time_ns"] =
+                    child.time_ns > children_time_ns ? child.time_ns - children_time_ns : 0;
+                stats["children"] = children_report( i_child );
+
+                // sibling readers sharing a name get a suffix
+                std::string key = child.name;
+                for ( int i = 2; res.contains( key ); i++ )
+                    key = child.name + "#" + std::to_string( i );
+                res[py::str( key )] = stats;
+            }
+            return res;
+        }
+    };
+
+    /**
+     * @brief Record a reader call into the profiler of the stream for the lifetime of the
+     * scope. Only costs a null check when profiling is disabled. Put it at the beginning of
+     * the reading methods:
+     *
+     * @code{.cpp}
+     * uint32_t read_many( BinaryStream& stream, const int64_t count ) override {
+     *     ProfileScope profile( stream, this, ReadProfiler::kReadMany, count );
+     *     ...
+     * }
+     * @endcode
+     */
+    class ProfileScope {
+      public:
+        /**
+         * @brief Start recording a reader call.
+         *
+         * @param stream The stream being read.
+         * @param reader The reader being called.
+         * @param method The method being called.
+         * @param n_elements Number of elements produced, if known in advance. Otherwise set
+         * it later with @ref produced().
+         */
+        ProfileScope( BinaryStream& stream, const IReader* reader,
+                      const ReadProfiler::Method method, const int64_t n_elements = 0 )
+            : m_profiler( stream.profiler() ) {
+            if ( !m_profiler ) return;
+            m_node = m_profiler->enter( reader, method );
+            if ( m_node == 0 ) return;
+
+            m_stream       = &stream;
+            m_start_cursor = stream.get_cursor();
+            m_n_elements   = n_elements > 0 ? n_elements : 0;
+            m_start_time   = std::chrono::steady_clock::now();
+        }
+
+        ~ProfileScope() {
+            if ( !m_profiler || m_node == 0 ) return;
+            auto time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::steady_clock::now() - m_start_time )
+                               .count();
+            m_profiler->leave( m_node, m_stream->get_cursor() - m_start_cursor, m_n_elements,
+                               time_ns );
+        }
+
+        ProfileScope( const ProfileScope& )            = delete;
+        ProfileScope& operator=( const ProfileScope& ) = delete;
+
+        /**
+         * @brief Set the number of elements produced by the call.
+         *
+         * @param n_elements Number of elements produced.
+         * @return `n_elements`, so that it can wrap the return value.
+         */
+        template <typename T>
+        T produced( const T n_elements ) {
+            m_n_elements = n_elements > 0 ? n_elements : 0;
+            return n_elements;
+        }
+
+      private:
+        ReadProfiler* m_profiler;
+        uint32_t m_node{ 0 };
+        const BinaryStream* m_stream{ nullptr };
+        const uint8_t* m_start_cursor{ nullptr };
+        uint64_t m_n_elements{ 0 };
+        std::chrono::steady_clock::time_point m_start_time;
+    };
+
+    /**
+     * @brief Layout of the offsets returned by readers of sequences, see @ref
+     * OffsetsVector and @ref IReader::set_offsets_format().
+     */
+    enum OffsetsFormat : int {
+        kOffsetsInt64, ///< int64 offsets, one more than items (the default)
+        kOffsetsInt32, ///< int32 offsets, an error if an offset does not fit
+        kCounts,       ///< number of elements of each item, as uint8, uint16 or uint32
+    };
+
     /**
      * @brief Interface for element readers. All element readers must inherit from this class.
      */
@@ -374,6 +1084,7 @@ namespace uproot_custom {
          * @return Number of elements read.
          */
         virtual uint32_t read_many( BinaryStream& stream, const int64_t count ) {
+            ProfileScope profile( stream, this, ReadProfiler::kReadMany, count );
             for ( int32_t i = 0; i < count; i++ ) { read( stream ); }
             return count;
         }
@@ -391,13 +1102,14 @@ namespace uproot_custom {
          * @return Number of elements read.
          */
         virtual uint32_t read_until( BinaryStream& stream, const uint8_t* end_pos ) {
+            ProfileScope profile( stream, this, ReadProfiler::kReadUntil );
             uint32_t cur_count = 0;
             while ( stream.get_cursor() < end_pos )
             {
                 read( stream );
                 cur_count++;
             }
-            return cur_count;
+            return profile.produced( cur_count );
         }
 
         /**
@@ -411,6 +1123,40 @@ namespace uproot_custom {
         virtual uint32_t read_many_memberwise( BinaryStream& stream, const int64_t count ) {
             throw std::runtime_error( name() + "::read_many_memberwise is not implemented." );
         }
+
+        /**
+         * @brief Discard all accumulated data so that the reader can be reused for another
+         * stream. Readers that need to be reused must implement this method, and composed
+         * readers must forward it to their sub-readers.
+         *
+         * @note Arrays returned by a previous @ref data() call may still share the old
+         * buffers, so implementations must replace the buffers with new ones instead of
+         * clearing them in place.
+         */
+        virtual void reset() {
+            throw std::runtime_error( name() + "::reset is not implemented." );
+        }
+
+        /**
+         * @brief Hint the amount of data to be read, so that buffers can be allocated once
+         * instead of growing repeatedly. Does nothing by default. Composed readers should
+         * forward the hint to their sub-readers, splitting `n_bytes` among sub-readers that
+         * consume the same bytes, so that the hints stay an upper bound in total.
+         *
+         * @param n_entries Number of times @ref read() will be called, or 0 if unknown.
+         * @param n_bytes Upper bound of the number of bytes the reader will consume.
+         */
+        virtual void reserve( const uint64_t n_entries, const uint64_t n_bytes ) {}
+
+        /**
+         * @brief Select the layout of the offsets returned by @ref data(), see @ref
+         * OffsetsVector. Does nothing by default. Readers of sequences discard the data read
+         * so far, so call it before reading. Composed readers must forward it to their
+         * sub-readers.
+         *
+         * @param format The layout of the offsets.
+         */
+        virtual void set_offsets_format( const OffsetsFormat format ) {}
     };
 
     /**
@@ -427,6 +1173,34 @@ namespace uproot_custom {
      */
     using SharedReader = shared_ptr<IReader>;
 
+    inline uint32_t ReadProfiler::enter( const IReader* reader, const Method method ) {
+        const uint32_t parent = m_stack.back();
+        if ( m_nodes[parent].reader == reader )
+        {
+            m_nodes[parent].n_calls[method]++;
+            return 0;
+        }
+
+        uint32_t node = 0;
+        for ( auto i_child : m_nodes[parent].children )
+        {
+            if ( m_nodes[i_child].reader != reader ) continue;
+            node = i_child;
+            break;
+        }
+
+        if ( node == 0 )
+        {
+            node = m_nodes.size();
+            m_nodes.push_back( Node{ reader, reader->name() } );
+            m_nodes[parent].children.push_back( node );
+        }
+
+        m_nodes[node].n_calls[method]++;
+        m_stack.push_back( node );
+        return node;
+    }
+
     /*
     -----------------------------------------------------------------------------
     -----------------------------------------------------------------------------
@@ -469,26 +1243,532 @@ namespace uproot_custom {
     -----------------------------------------------------------------------------
     */
 
+    /**
+     * @brief Memory arena for the output buffers of readers. While an @ref ArenaScope is
+     * active on a thread, buffers allocated by @ref ArenaAllocator on that thread come from
+     * the arena instead of being allocated one by one on the heap.
+     *
+     * Buffers up to @ref kMaxBlockSize are rounded up to a power of two and carved from
+     * slabs of @ref kSlabSize bytes, larger ones get a slab of their own. Freed buffers are
+     * kept in a free list per size and reused by the next allocations, e.g. the storage
+     * left behind by a vector growing is taken by the next vector reaching the same size.
+     *
+     * Once the arena is released by its owner and its scopes, the slabs without live buffers
+     * are freed, and the others are freed as soon as their last buffer is, e.g. when the
+     * numpy arrays wrapping them are garbage-collected.
+     */
+    class BufferArena {
+      public:
+        static constexpr size_t kSlabSize     = 1 << 20;       ///< size of a slab
+        static constexpr size_t kMaxBlockSize = kSlabSize / 8; ///< max size carved from slabs
+        static constexpr size_t kMinBlockSize = 64;            ///< size of the smallest block
+
+        /**
+         * @brief Memory usage of an arena, see @ref stats().
+         */
+        struct Stats {
+            size_t n_slabs;       ///< number of slabs, including the ones of large buffers
+            size_t n_bytes;       ///< total size of the slabs
+            size_t n_live_blocks; ///< number of buffers allocated and not freed yet
+            size_t n_free_blocks; ///< number of freed buffers kept for reuse
+            size_t n_reused;      ///< number of allocations served by a freed buffer
+        };
+
+        /**
+         * @brief Create an arena, owned by the caller until @ref release() is called.
+         */
+        static BufferArena* create() { return new BufferArena(); }
+
+        /**
+         * @brief Get the arena of the innermost active @ref ArenaScope of this thread.
+         *
+         * @return The arena, or nullptr if there is no active scope.
+         */
+        static BufferArena* current() { return s_current; }
+
+        /**
+         * @brief Allocate memory from the current arena, or from the heap if there is no
+         * current arena.
+         *
+         * @param n_bytes Number of bytes to allocate.
+         * @return Pointer to the memory, aligned to 16 bytes.
+         */
+        static void* allocate( const size_t n_bytes ) {
+            if ( auto arena = current() ) return arena->allocate_block( n_bytes );
+
+            auto header = static_cast<Header*>( ::operator new( n_bytes + sizeof( Header ) ) );
+            header->arena = nullptr;
+            return header + 1;
+        }
+
+        /**
+         * @brief Free memory returned by @ref allocate(). Can be called from any thread.
+         *
+         * @param ptr Pointer returned by @ref allocate().
+         */
+        static void deallocate( void* ptr ) {
+            auto header = static_cast<Header*>( ptr ) - 1;
+            if ( header->arena ) header->arena->free_block( header );
+            else ::operator delete( header );
+        }
+
+        /**
+         * @brief Take a reference to the arena.
+         */
+        void retain() {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_refs++;
+        }
+
+        /**
+         * @brief Drop a reference to the arena. With the last one, the slabs without live
+         * buffers are freed, and the arena is deleted with its last slab.
+         */
+        void release() {
+            bool done;
+            {
+                std::lock_guard<std::mutex> lock( m_mutex );
+                if ( --m_refs == 0 )
+                {
+                    for ( auto slab = m_slabs; slab; )
+                    {
+                        auto next = slab->next;
+                        if ( slab->n_live == 0 ) free_slab( slab );
+                        slab = next;
+                    }
+                }
+                done = m_refs == 0 && m_slabs == nullptr;
+            }
+            if ( done ) delete this;
+        }
+
+        /**
+         * @brief Get the memory usage of the arena.
+         */
+        Stats stats() {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            size_t n_slabs = 0;
+            for ( auto slab = m_slabs; slab; slab = slab->next ) n_slabs++;
+            return { n_slabs, m_n_bytes, m_n_live, m_n_free, m_n_reused };
+        }
+
+      private:
+        struct alignas( 16 ) Slab {
+            Slab* prev;    ///< previous slab of the arena
+            Slab* next;    ///< next slab of the arena
+            uint8_t* pos;  ///< next free byte
+            uint8_t* end;  ///< end of the slab
+            size_t n_live; ///< number of live buffers carved from the slab
+        };
+
+        struct alignas( 16 ) Header {
+            BufferArena* arena; ///< arena the block comes from, nullptr for the heap
+            Slab* slab;         ///< slab the block is carved from
+            size_t size;        ///< size of the block, including the header
+        };
+
+        struct FreeLinks {
+            Header* prev; ///< previous free block of the same size
+            Header* next; ///< next free block of the same size
+        };
+
+        static constexpr size_t kNumClasses = 12; ///< kMinBlockSize to kMaxBlockSize
+        static_assert( kMinBlockSize << ( kNumClasses - 1 ) == kMaxBlockSize );
+
+        std::mutex m_mutex;              ///< guards everything below
+        size_t m_refs{ 1 };              ///< owner + active scopes
+        Slab* m_slabs{ nullptr };        ///< slabs of the arena
+        Slab* m_current{ nullptr };      ///< slab the small blocks are carved from
+        Header* m_free[kNumClasses]{};   ///< free small blocks, by size class
+        Header* m_free_large{ nullptr }; ///< free blocks with a slab of their own
+        size_t m_n_bytes{ 0 };           ///< total size of the slabs
+        size_t m_n_live{ 0 };            ///< number of live blocks
+        size_t m_n_free{ 0 };            ///< number of free blocks
+        size_t m_n_reused{ 0 };          ///< number of reused blocks
+
+        static inline thread_local BufferArena* s_current = nullptr;
+
+        BufferArena() = default;
+
+        static FreeLinks* links( Header* header ) {
+            return reinterpret_cast<FreeLinks*>( header + 1 );
+        }
+
+        static size_t size_class( const size_t n_bytes ) {
+            size_t cls = 0;
+            while ( ( kMinBlockSize << cls ) < n_bytes ) cls++;
+            return cls;
+        }
+
+        Header*& free_list( const size_t size ) {
+            return size > kMaxBlockSize ? m_free_large : m_free[size_class( size )];
+        }
+
+        void push_free( Header* header ) {
+            auto& list            = free_list( header->size );
+            links( header )->prev = nullptr;
+            links( header )->next = list;
+            if ( list ) links( list )->prev = header;
+            list = header;
+            m_n_free++;
+        }
+
+        void unlink_free( Header* header ) {
+            auto& list = free_list( header->size );
+            auto prev  = links( header )->prev;
+            auto next  = links( header )->next;
+            if ( prev ) links( prev )->next = next;
+            else list = next;
+            if ( next ) links( next )->prev = prev;
+            m_n_free--;
+        }
+
+        Slab* new_slab( const size_t n_bytes ) {
+            auto slab = static_cast<Slab*>( ::operator new( sizeof( Slab ) + n_bytes ) );
+            slab->prev   = nullptr;
+            slab->next   = m_slabs;
+            slab->pos    = reinterpret_cast<uint8_t*>( slab + 1 );
+            slab->end    = slab->pos + n_bytes;
+            slab->n_live = 0;
+            if ( m_slabs ) m_slabs->prev = slab;
+            m_slabs = slab;
+            m_n_bytes += sizeof( Slab ) + n_bytes;
+            return slab;
+        }
+
+        /**
+         * @brief Free a slab without live blocks, taking its blocks out of the free lists.
+         */
+        void free_slab( Slab* slab ) {
+            for ( auto pos = reinterpret_cast<uint8_t*>( slab + 1 ); pos < slab->pos; )
+            {
+                auto header = reinterpret_cast<Header*>( pos );
+                unlink_free( header );
+                pos += header->size;
+            }
+
+            if ( slab->prev ) slab->prev->next = slab->next;
+            else m_slabs = slab->next;
+            if ( slab->next ) slab->next->prev = slab->prev;
+            if ( m_current == slab ) m_current = nullptr;
+
+            m_n_bytes -= slab->end - reinterpret_cast<uint8_t*>( slab );
+            ::operator delete( slab );
+        }
+
+        Header* carve( Slab* slab, const size_t size ) {
+            auto header   = reinterpret_cast<Header*>( slab->pos );
+            header->arena = nullptr;
+            header->slab  = slab;
+            header->size = size;
+            slab->pos += size;
+            return header;
+        }
+
+        void* allocate_block( const size_t n_bytes ) {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            const size_t n_needed = n_bytes + sizeof( Header );
+
+            Header* header = nullptr;
+            if ( n_needed <= kMaxBlockSize )
+            {
+                const size_t cls  = size_class( n_needed );
+                const size_t size = kMinBlockSize << cls;
+                header            = m_free[cls];
+                if ( !header )
+                {
+                    if ( !m_current || size_t( m_current->end - m_current->pos ) < size )
+                        m_current = new_slab( kSlabSize - sizeof( Slab ) );
+                    header = carve( m_current, size );
+                }
+            }
+            else
+            {
+                // reuse a free large block, unless it wastes more than half of it
+                const size_t size = ( n_needed + 15 ) & ~size_t( 15 );
+                for ( auto free = m_free_large; free; free = links( free )->next )
+                {
+                    if ( free->size >= size && free->size / 2 <= size )
+                    {
+                        header = free;
+                        break;
+                    }
+                }
+                if ( !header ) header = carve( new_slab( size ), size );
+            }
+
+            if ( header->arena )
+            {
+                unlink_free( header );
+                m_n_reused++;
+            }
+            header->arena = this;
+            header->slab->n_live++;
+            m_n_live++;
+            return header + 1;
+        }
+
+        void free_block( Header* header ) {
+            bool done = false;
+            {
+                std::lock_guard<std::mutex> lock( m_mutex );
+                header->slab->n_live--;
+                m_n_live--;
+                push_free( header );
+                if ( m_refs == 0 && header->slab->n_live == 0 )
+                {
+                    free_slab( header->slab );
+                    done = m_slabs == nullptr;
+                }
+            }
+            if ( done ) delete this;
+        }
+
+        friend class ArenaScope;
+    };
+
+    /**
+     * @brief Make buffers allocated on this thread come from an arena for the lifetime of
+     * the scope, see @ref BufferArena. Scopes can be nested.
+     */
+    class ArenaScope {
+      public:
+        /**
+         * @brief Enter a new arena.
+         */
+        ArenaScope() : ArenaScope( BufferArena::create() ) { m_arena->release(); }
+
+        /**
+         * @brief Enter an existing arena, e.g. to continue allocating from it across calls.
+         *
+         * @param arena The arena, which is retained until the scope ends.
+         */
+        explicit ArenaScope( BufferArena* arena )
+            : m_arena( arena ), m_previous( BufferArena::s_current ) {
+            m_arena->retain();
+            BufferArena::s_current = m_arena;
+        }
+
+        ~ArenaScope() {
+            BufferArena::s_current = m_previous;
+            m_arena->release();
+        }
+
+        ArenaScope( const ArenaScope& )            = delete;
+        ArenaScope& operator=( const ArenaScope& ) = delete;
+
+      private:
+        BufferArena* m_arena;
+        BufferArena* m_previous;
+    };
+
+    /**
+     * @brief Allocator taking memory from the current @ref BufferArena of the thread.
+     *
+     * @tparam T The element type.
+     */
+    template <typename T>
+    struct ArenaAllocator {
+        using value_type = T;
+
+        ArenaAllocator() = default;
+
+        template <typename U>
+        ArenaAllocator( const ArenaAllocator<U>& ) {}
+
+        T* allocate( const size_t n ) {
+            return static_cast<T*>( BufferArena::allocate( n * sizeof( T ) ) );
+        }
+
+        void deallocate( T* ptr, const size_t ) { BufferArena::deallocate( ptr ); }
+
+        template <typename U>
+        bool operator==( const ArenaAllocator<U>& ) const {
+            return true;
+        }
+
+        template <typename U>
+        bool operator!=( const ArenaAllocator<U>& ) const {
+            return false;
+        }
+    };
+
+    /**
+     * @brief Vector whose storage comes from the current @ref BufferArena. The built-in
+     * readers store their output in it, and it can be passed to @ref make_array().
+     */
+    template <typename T>
+    using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
     /**
      * @brief Convert a shared pointer to a std::vector<T> to a numpy array without copying.
      * User can use this function to return numpy arrays from reader's data() method.
      *
      * @tparam T The element type of the vector.
+     * @tparam Alloc The allocator of the vector, e.g. `std::allocator<T>` or @ref
+     * ArenaAllocator.
      * @param seq The shared pointer to the std::vector<T>.
      * @return The numpy array wrapping the vector data.
      */
-    template <typename T>
-    inline py::array_t<T> make_array( shared_ptr<std::vector<T>> seq ) {
+    template <typename T, typename Alloc>
+    inline py::array_t<T> make_array( shared_ptr<std::vector<T, Alloc>> seq ) {
         auto size = seq->size();
         auto data = seq->data();
 
         auto capsule = py::capsule( new auto( seq ), []( void* p ) {
-            delete reinterpret_cast<std::shared_ptr<std::vector<T>>*>( p );
+            delete reinterpret_cast<std::shared_ptr<std::vector<T, Alloc>>*>( p );
         } );
 
         return py::array_t<T>( size, data, capsule );
     }
 
+    /**
+     * @brief Copy counts into a new numpy array of a narrower type.
+     */
+    template <typename To, typename Alloc>
+    inline py::array_t<To> narrow_counts( const std::vector<uint32_t, Alloc>& counts ) {
+        py::array_t<To> res( counts.size() );
+        auto out = res.mutable_data();
+        for ( size_t i = 0; i < counts.size(); i++ ) out[i] = static_cast<To>( counts[i] );
+        return res;
+    }
+
+    /**
+     * @brief Offsets of the items of a reader of sequences, stored directly in the layout
+     * selected by @ref set_format(): int64 or int32 offsets, or uint32 counts, which @ref
+     * make_offsets_array() narrows to the smallest unsigned type fitting the largest count.
+     *
+     * Whatever the layout, it is used like a `std::vector<int64_t>` of offsets starting
+     * with 0: @ref push_back() takes the offset after the new item.
+     */
+    class OffsetsVector {
+      private:
+        OffsetsFormat m_format{ kOffsetsInt64 }; ///< layout of the stored offsets
+        int64_t m_last{ 0 };                     ///< last offset pushed
+        size_t m_size{ 1 };                      ///< number of offsets, including 0
+        uint32_t m_max_count{ 0 };               ///< largest count, with @ref kCounts
+        shared_ptr<ArenaVector<int64_t>> m_int64;
+        shared_ptr<ArenaVector<int32_t>> m_int32;
+        shared_ptr<ArenaVector<uint32_t>> m_counts;
+
+        [[noreturn]] static void throw_overflow( const int64_t value, const char* layout ) {
+            std::stringstream msg;
+            msg << "OffsetsVector: " << value << " does not fit in " << layout << "!";
+            throw std::overflow_error( msg.str() );
+        }
+
+      public:
+        OffsetsVector( const OffsetsFormat format = kOffsetsInt64 ) { set_format( format ); }
+
+        OffsetsFormat format() const { return m_format; }
+
+        /**
+         * @brief Select the layout of the offsets, discarding the offsets pushed so far.
+         */
+        void set_format( const OffsetsFormat format ) {
+            m_format = format;
+            clear();
+        }
+
+        /**
+         * @brief Discard the offsets. The buffers are replaced, so arrays returned by @ref
+         * make_offsets_array() keep their data, see @ref IReader::reset().
+         */
+        void clear() {
+            m_last      = 0;
+            m_size      = 1;
+            m_max_count = 0;
+            m_int64.reset();
+            m_int32.reset();
+            m_counts.reset();
+            switch ( m_format )
+            {
+            case kOffsetsInt64: m_int64 = std::make_shared<ArenaVector<int64_t>>( 1, 0 ); break;
+            case kOffsetsInt32: m_int32 = std::make_shared<ArenaVector<int32_t>>( 1, 0 ); break;
+            case kCounts: m_counts = std::make_shared<ArenaVector<uint32_t>>(); break;
+            }
+        }
+
+        /**
+         * @brief Get the last offset, 0 if no item was pushed.
+         */
+        int64_t back() const { return m_last; }
+
+        /**
+         * @brief Get the number of offsets, i.e. the number of items plus one.
+         */
+        size_t size() const { return m_size; }
+
+        /**
+         * @brief Append an item ending at `offset`.
+         */
+        void push_back( const int64_t offset ) {
+            switch ( m_format )
+            {
+            case kOffsetsInt64: m_int64->push_back( offset ); break;
+            case kOffsetsInt32:
+                if ( offset > std::numeric_limits<int32_t>::max() )
+                    throw_overflow( offset, "int32 offsets" );
+                m_int32->push_back( static_cast<int32_t>( offset ) );
+                break;
+            case kCounts:
+            {
+                const int64_t count = offset - m_last;
+                if ( count > std::numeric_limits<uint32_t>::max() )
+                    throw_overflow( count, "uint32 counts" );
+                m_counts->push_back( static_cast<uint32_t>( count ) );
+                m_max_count = std::max( m_max_count, static_cast<uint32_t>( count ) );
+                break;
+            }
+            }
+            m_last = offset;
+            m_size++;
+        }
+
+        /**
+         * @brief Reserve room for `n_offsets` offsets in total.
+         */
+        void reserve( const size_t n_offsets ) {
+            switch ( m_format )
+            {
+            case kOffsetsInt64: m_int64->reserve( n_offsets ); break;
+            case kOffsetsInt32: m_int32->reserve( n_offsets ); break;
+            case kCounts: m_counts->reserve( n_offsets ? n_offsets - 1 : 0 ); break;
+            }
+        }
+
+        /**
+         * @brief Get the offsets as a numpy array, see @ref make_offsets_array().
+         */
+        py::array array() const {
+            switch ( m_format )
+            {
+            case kOffsetsInt64: return make_array( m_int64 );
+            case kOffsetsInt32: return make_array( m_int32 );
+            case kCounts: break;
+            }
+
+            if ( m_max_count <= std::numeric_limits<uint8_t>::max() )
+                return narrow_counts<uint8_t>( *m_counts );
+            if ( m_max_count <= std::numeric_limits<uint16_t>::max() )
+                return narrow_counts<uint16_t>( *m_counts );
+            return make_array( m_counts );
+        }
+    };
+
+    /**
+     * @brief Convert the offsets of a reader to a numpy array. Offsets are returned without
+     * copying; counts are returned in the narrowest unsigned type fitting the largest one,
+     * which costs a copy unless it is uint32. In Python, unsigned arrays are counts and
+     * signed arrays are offsets.
+     *
+     * @param offsets The offsets, see @ref OffsetsVector.
+     * @return The numpy array of the offsets or counts.
+     */
+    inline py::array make_offsets_array( const shared_ptr<OffsetsVector>& offsets ) {
+        return offsets->array();
+    }
+
     /*
     -----------------------------------------------------------------------------
     -----------------------------------------------------------------------------
@@ -496,8 +1776,26 @@ namespace uproot_custom {
     */
 
     /**
-     * @brief Debug print function. Prints only when environment variable with name
-     * `UPROOT_CUSTOM_DEBUG` is defined. Use this function like `printf()`.
+     * @brief Whether debug printing is enabled, i.e. the environment variable
+     * `UPROOT_CUSTOM_DEBUG` is defined. The environment is only looked up once. If the macro
+     * `UPROOT_CUSTOM_NO_DEBUG` is defined at compile time, always returns false so that all
+     * debug printing is compiled out.
+     */
+#ifdef UPROOT_CUSTOM_NO_DEBUG
+    constexpr bool debug_enabled() { return false; }
+#else
+    inline bool debug_enabled() {
+        static const bool enabled = getenv( "UPROOT_CUSTOM_DEBUG" ) != nullptr;
+        return enabled;
+    }
+#endif
+
+    /**
+     * @brief Debug print function. Prints only when @ref debug_enabled(). Use this function
+     * like `printf()`.
+     *
+     * @note The arguments are evaluated even if debug printing is disabled. In hot paths,
+     * use @ref UPROOT_CUSTOM_DEBUG_PRINTF instead.
      *
      * @tparam Args Argument types. No need to specify explicitly.
      * @param msg The format string.
@@ -505,27 +1803,33 @@ namespace uproot_custom {
      */
     template <typename... Args>
     inline void debug_printf( const char* msg, Args... args ) {
-        bool do_print = getenv( "UPROOT_CUSTOM_DEBUG" );
-        if ( !do_print ) return;
+        if ( !debug_enabled() ) return;
         printf( msg, std::forward<Args>( args )... );
     }
 
     /**
-     * @brief Debug print function for BinaryStream. Prints only when environment
-     * variable with name `UPROOT_CUSTOM_DEBUG` is defined. Call @ref
-     * BinaryStream::debug_print() internally.
+     * @brief Debug print function for BinaryStream. Prints only when @ref debug_enabled().
+     * Call @ref BinaryStream::debug_print() internally.
      *
      * @param stream The BinaryStream to print.
      * @param n Number of bytes to print.
      */
     inline void debug_printf( uproot_custom::BinaryStream& stream, const size_t n = 100 ) {
-        bool do_print = getenv( "UPROOT_CUSTOM_DEBUG" );
-        if ( !do_print ) return;
+        if ( !debug_enabled() ) return;
         stream.debug_print( n );
     }
 
 } // namespace uproot_custom
 
+/**
+ * @brief Same as @ref uproot_custom::debug_printf(), but the arguments are only evaluated if
+ * debug printing is enabled, and nothing is left when compiled with `UPROOT_CUSTOM_NO_DEBUG`.
+ */
+#define UPROOT_CUSTOM_DEBUG_PRINTF( ... )                                                     \
+    do {                                                                                      \
+        if ( ::uproot_custom::debug_enabled() ) ::uproot_custom::debug_printf( __VA_ARGS__ ); \
+    } while ( 0 )
+
 // backward compatibility
 // TODO: remove the uproot namespace and use uproot_custom namespace directly in the future.
 namespace uproot {
@@ -1,8 +1,17 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
+#include <tuple>
 #include <variant>
 #include <vector>
 
@@ -10,6 +19,7 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/pytypes.h>
 
+#include "uproot-custom/arrow-export.hh"
 #include "uproot-custom/uproot-custom.hh"
 
 namespace uproot_custom {
@@ -20,7 +30,30 @@ namespace uproot_custom {
     using std::vector;
 
     template <typename T>
-    using SharedVector = shared_ptr<vector<T>>;
+    using SharedVector = shared_ptr<ArenaVector<T>>;
+
+    /**
+     * @brief Interface of the readers of fixed-size primitive values, so that composite
+     * readers can decode their values in bulk instead of calling them per value.
+     */
+    class IPrimitiveReader : public IReader {
+      public:
+        using IReader::IReader;
+
+        /**
+         * @brief Size of one value in bytes.
+         */
+        virtual size_t value_size() const = 0;
+
+        /**
+         * @brief Append `n` values to the data, to be written by the caller in host byte
+         * order.
+         *
+         * @param n Number of values to append.
+         * @return Pointer to the first appended value.
+         */
+        virtual uint8_t* append( const size_t n ) = 0;
+    };
 
     /**
      * @brief Reader for primitive types
@@ -28,7 +61,7 @@ namespace uproot_custom {
      * @tparam T Primitive type
      */
     template <typename T>
-    class PrimitiveReader : public IReader {
+    class PrimitiveReader : public IPrimitiveReader {
       private:
         SharedVector<T> m_data; ///< Store the read data
 
@@ -39,14 +72,77 @@ namespace uproot_custom {
          * @param name Name of the reader
          */
         PrimitiveReader( string name )
-            : IReader( name ), m_data( std::make_shared<vector<T>>() ) {}
+            : IPrimitiveReader( name ), m_data( std::make_shared<ArenaVector<T>>() ) {}
+
+        size_t value_size() const override { return sizeof( T ); }
+
+        uint8_t* append( const size_t n ) override {
+            auto old_size = m_data->size();
+            m_data->resize( old_size + n );
+            return reinterpret_cast<uint8_t*>( m_data->data() + old_size );
+        }
 
         /**
          * @brief Read a value from the stream and store it. Only reads one value at a time.
          *
          * @param stream The binary stream to read from
          */
-        void read( BinaryStream& stream ) override { m_data->push_back( stream.read<T>() ); }
+        void read( BinaryStream& stream ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kRead, 1 );
+            m_data->push_back( stream.read<T>() );
+        }
+
+        /**
+         * @brief Read multiple contiguous values from the stream. Grows the data buffer once
+         * and converts the whole block with @ref BinaryStream::read_array().
+         *
+         * @param stream The binary stream to read from
+         * @param count Number of values to read. If negative, throws an error.
+         * @return Number of values read
+         */
+        uint32_t read_many( BinaryStream& stream, const int64_t count ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kReadMany, count );
+            if ( count < 0 )
+            {
+                stringstream msg;
+                msg << name() << "::read_many with negative count: " << count;
+                throw std::runtime_error( msg.str() );
+            }
+
+            auto old_size = m_data->size();
+            m_data->resize( old_size + count );
+            stream.read_array( m_data->data() + old_size, count );
+            return count;
+        }
+
+        /**
+         * @brief Read contiguous values from the stream until reaching the end position.
+         * Same as @ref read_many() with the count derived from the remaining bytes.
+         *
+         * @param stream The binary stream to read from
+         * @param end_pos The end position to stop reading
+         * @return Number of values read
+         */
+        uint32_t read_until( BinaryStream& stream, const uint8_t* end_pos ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kReadUntil );
+            if ( stream.get_cursor() >= end_pos ) return 0;
+            auto count = ( end_pos - stream.get_cursor() + sizeof( T ) - 1 ) / sizeof( T );
+            return profile.produced( read_many( stream, count ) );
+        }
+
+        /**
+         * @brief Discard the read data.
+         */
+        void reset() override { m_data = std::make_shared<ArenaVector<T>>(); }
+
+        /**
+         * @brief Reserve one value per entry if the number of entries is known, otherwise
+         * the upper bound of `n_bytes / sizeof(T)` values.
+         */
+        void reserve( const uint64_t n_entries, const uint64_t n_bytes ) override {
+            auto n_values = n_entries ? n_entries : n_bytes / sizeof( T );
+            m_data->reserve( m_data->size() + n_values );
+        }
 
         /**
          * @brief Get the read data as a numpy array
@@ -67,11 +163,11 @@ namespace uproot_custom {
      */
     class TObjectReader : public IReader {
       private:
-        const bool m_keep_data;               ///< Whether to keep the read data
-        SharedVector<int32_t> m_unique_id;    ///< Store fUniqueID values
-        SharedVector<uint32_t> m_bits;        ///< Store fBits values
-        SharedVector<uint16_t> m_pidf;        ///< Store pidf values
-        SharedVector<int64_t> m_pidf_offsets; ///< Store offsets for pidf
+        const bool m_keep_data;                   ///< Whether to keep the read data
+        SharedVector<int32_t> m_unique_id;        ///< Store fUniqueID values
+        SharedVector<uint32_t> m_bits;            ///< Store fBits values
+        SharedVector<uint16_t> m_pidf;            ///< Store pidf values
+        shared_ptr<OffsetsVector> m_pidf_offsets; ///< Store offsets for pidf
 
       public:
         /**
@@ -83,10 +179,10 @@ namespace uproot_custom {
         TObjectReader( string name, bool keep_data )
             : IReader( name )
             , m_keep_data( keep_data )
-            , m_unique_id( std::make_shared<vector<int32_t>>() )
-            , m_bits( std::make_shared<vector<uint32_t>>() )
-            , m_pidf( std::make_shared<vector<uint16_t>>() )
-            , m_pidf_offsets( std::make_shared<vector<int64_t>>( 1, 0 ) ) {}
+            , m_unique_id( std::make_shared<ArenaVector<int32_t>>() )
+            , m_bits( std::make_shared<ArenaVector<uint32_t>>() )
+            , m_pidf( std::make_shared<ArenaVector<uint16_t>>() )
+            , m_pidf_offsets( std::make_shared<OffsetsVector>() ) {}
 
         /**
          * @brief Read a TObject from the stream. A TObject contains `fVersion` (int16_t),
@@ -97,6 +193,7 @@ namespace uproot_custom {
          * @param stream The binary stream to read from
          */
         void read( BinaryStream& stream ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kRead, 1 );
             stream.skip_fVersion();
             auto fUniqueID = stream.read<int32_t>();
             auto fBits     = stream.read<uint32_t>();
@@ -115,6 +212,33 @@ namespace uproot_custom {
             }
         }
 
+        /**
+         * @brief Discard the read data.
+         */
+        void reset() override {
+            m_unique_id    = std::make_shared<ArenaVector<int32_t>>();
+            m_bits         = std::make_shared<ArenaVector<uint32_t>>();
+            m_pidf         = std::make_shared<ArenaVector<uint16_t>>();
+            m_pidf_offsets->clear();
+        }
+
+        /**
+         * @brief Reserve the kept data for `n_entries` TObjects.
+         */
+        void reserve( const uint64_t n_entries, const uint64_t n_bytes ) override {
+            if ( !m_keep_data || n_entries == 0 ) return;
+            m_unique_id->reserve( m_unique_id->size() + n_entries );
+            m_bits->reserve( m_bits->size() + n_entries );
+            m_pidf_offsets->reserve( m_pidf_offsets->size() + n_entries );
+        }
+
+        /**
+         * @brief Select the layout of the offsets.
+         */
+        void set_offsets_format( const OffsetsFormat format ) override {
+            m_pidf_offsets->set_format( format );
+        }
+
         /**
          * @brief Get the data read by the reader. This should be called after the whole
          * reading process.
@@ -128,7 +252,7 @@ namespace uproot_custom {
             auto unique_id_array = make_array( m_unique_id );
             auto bits_array      = make_array( m_bits );
             auto pidf_array      = make_array( m_pidf );
-            auto pidf_offsets    = make_array( m_pidf_offsets );
+            auto pidf_offsets    = make_offsets_array( m_pidf_offsets );
             return py::make_tuple( unique_id_array, bits_array, pidf_array, pidf_offsets );
         }
     };
@@ -144,9 +268,9 @@ namespace uproot_custom {
      */
     class TStringReader : public IReader {
       private:
-        const bool m_with_header;     ///< Whether the TString has a `fNBytes+fVersion` header
-        SharedVector<uint8_t> m_data; ///< Store the string data
-        SharedVector<int64_t> m_offsets; ///< Store the offsets for each string
+        const bool m_with_header; ///< Whether the TString has a `fNBytes+fVersion` header
+        SharedVector<uint8_t> m_data;        ///< Store the string data
+        shared_ptr<OffsetsVector> m_offsets; ///< Store the offsets for each string
 
       public:
         /**
@@ -158,8 +282,8 @@ namespace uproot_custom {
         TStringReader( string name, bool with_header )
             : IReader( name )
             , m_with_header( with_header )
-            , m_data( std::make_shared<vector<uint8_t>>() )
-            , m_offsets( std::make_shared<vector<int64_t>>( 1, 0 ) ) {}
+            , m_data( std::make_shared<ArenaVector<uint8_t>>() )
+            , m_offsets( std::make_shared<OffsetsVector>() ) {}
 
         /**
          * @brief Read a TString from the stream. A TString starts with a uint8_t size. If the
@@ -169,10 +293,9 @@ namespace uproot_custom {
          * @param stream The binary stream to read from.
          */
         void read( BinaryStream& stream ) override {
-            uint32_t fSize = stream.read<uint8_t>();
-            if ( fSize == 255 ) fSize = stream.read<uint32_t>();
-
-            for ( int i = 0; i < fSize; i++ ) { m_data->push_back( stream.read<uint8_t>() ); }
+            ProfileScope profile( stream, this, ReadProfiler::kRead, 1 );
+            auto [payload, fSize] = stream.read_TString_view();
+            m_data->insert( m_data->end(), payload, payload + fSize );
             m_offsets->push_back( m_data->size() );
         }
 
@@ -185,6 +308,7 @@ namespace uproot_custom {
          * @return Number of TStrings read.
          */
         uint32_t read_many( BinaryStream& stream, const int64_t count ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kReadMany, count );
             if ( count < 0 )
                 throw std::runtime_error(
                     "TStringReader::read_many with negative count not supported!" );
@@ -211,6 +335,7 @@ namespace uproot_custom {
          * @return Number of TStrings read.
          */
         uint32_t read_until( BinaryStream& stream, const uint8_t* end_pos ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kReadUntil );
             if ( stream.get_cursor() == end_pos ) return 0;
 
             if ( m_with_header )
@@ -225,7 +350,30 @@ namespace uproot_custom {
                 read( stream );
                 cur_count++;
             }
-            return cur_count;
+            return profile.produced( cur_count );
+        }
+
+        /**
+         * @brief Discard the read data.
+         */
+        void reset() override {
+            m_data    = std::make_shared<ArenaVector<uint8_t>>();
+            m_offsets->clear();
+        }
+
+        /**
+         * @brief Reserve offsets for `n_entries` strings and at most `n_bytes` characters.
+         */
+        void reserve( const uint64_t n_entries, const uint64_t n_bytes ) override {
+            m_offsets->reserve( m_offsets->size() + n_entries );
+            m_data->reserve( m_data->size() + n_bytes );
+        }
+
+        /**
+         * @brief Select the layout of the offsets.
+         */
+        void set_offsets_format( const OffsetsFormat format ) override {
+            m_offsets->set_format( format );
         }
 
         /**
@@ -235,7 +383,7 @@ namespace uproot_custom {
          * @return A tuple of numpy arrays: (offsets, data).
          */
         py::object data() const override {
-            auto offsets_array = make_array( m_offsets );
+            auto offsets_array = make_offsets_array( m_offsets );
             auto data_array    = make_array( m_data );
             return py::make_tuple( offsets_array, data_array );
         }
@@ -255,7 +403,7 @@ namespace uproot_custom {
         const bool m_with_header; ///< Whether the sequence has a `fNBytes+fVersion` header.
         const int m_objwise_or_memberwise{ -1 }; ///< -1: auto, 0: obj-wise, 1: member-wise
         SharedReader m_element_reader;           ///< Reader for the elements of the sequence.
-        SharedVector<int64_t> m_offsets;         ///< Store the offsets for each sequence.
+        shared_ptr<OffsetsVector> m_offsets;     ///< Store the offsets for each sequence.
 
       public:
         /**
@@ -273,7 +421,7 @@ namespace uproot_custom {
             , m_with_header( with_header )
             , m_objwise_or_memberwise( objwise_or_memberwise )
             , m_element_reader( element_reader )
-            , m_offsets( std::make_shared<vector<int64_t>>( 1, 0 ) ) {}
+            , m_offsets( std::make_shared<OffsetsVector>() ) {}
 
         /**
          * @brief Check if the reading mode matches the expected mode.
@@ -313,9 +461,10 @@ namespace uproot_custom {
             auto fSize = stream.read<uint32_t>();
             m_offsets->push_back( m_offsets->back() + fSize );
 
-            debug_printf( "STLSeqReader(%s): reading body, is_memberwise=%d, fSize=%d\n",
-                          m_name.c_str(), is_memberwise, fSize );
-            debug_printf( stream );
+            UPROOT_CUSTOM_DEBUG_PRINTF(
+                "STLSeqReader(%s): reading body, is_memberwise=%d, fSize=%d\n",
+                m_name.c_str(), is_memberwise, fSize );
+            UPROOT_CUSTOM_DEBUG_PRINTF( stream );
 
             if ( is_memberwise ) m_element_reader->read_many_memberwise( stream, fSize );
             else m_element_reader->read_many( stream, fSize );
@@ -328,6 +477,7 @@ namespace uproot_custom {
          * @param stream The binary stream to read from.
          */
         void read( BinaryStream& stream ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kRead, 1 );
             stream.read_fNBytes();
             auto fVersion      = stream.read_fVersion();
             bool is_memberwise = fVersion & kStreamedMemberWise;
@@ -346,6 +496,7 @@ namespace uproot_custom {
          * @return Number of sequences read.
          */
         uint32_t read_many( BinaryStream& stream, const int64_t count ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kReadMany, count );
             if ( count == 0 ) return 0;
             else if ( count < 0 )
             {
@@ -395,6 +546,7 @@ namespace uproot_custom {
          * @return Number of sequences read.
          */
         uint32_t read_until( BinaryStream& stream, const uint8_t* end_pos ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kReadUntil );
             if ( stream.get_cursor() == end_pos ) return 0;
             bool is_memberwise = m_objwise_or_memberwise == 1;
             if ( m_with_header )
@@ -412,7 +564,32 @@ namespace uproot_custom {
                 read_body( stream, is_memberwise );
                 cur_count++;
             }
-            return cur_count;
+            return profile.produced( cur_count );
+        }
+
+        /**
+         * @brief Discard the read offsets and reset @ref m_element_reader.
+         */
+        void reset() override {
+            m_offsets->clear();
+            m_element_reader->reset();
+        }
+
+        /**
+         * @brief Reserve offsets for `n_entries` sequences. The number of elements is unknown,
+         * so only `n_bytes` is forwarded to the element reader.
+         */
+        void reserve( const uint64_t n_entries, const uint64_t n_bytes ) override {
+            m_offsets->reserve( m_offsets->size() + n_entries );
+            m_element_reader->reserve( 0, n_bytes );
+        }
+
+        /**
+         * @brief Select the layout of the offsets and forward it to the sub-readers.
+         */
+        void set_offsets_format( const OffsetsFormat format ) override {
+            m_offsets->set_format( format );
+            m_element_reader->set_offsets_format( format );
         }
 
         /**
@@ -422,7 +599,7 @@ namespace uproot_custom {
          * @return A tuple contains: (offsets, elements_data).
          */
         py::object data() const override {
-            auto offsets_array = make_array( m_offsets );
+            auto offsets_array = make_offsets_array( m_offsets );
             auto elements_data = m_element_reader->data();
             return py::make_tuple( offsets_array, elements_data );
         }
@@ -435,10 +612,38 @@ namespace uproot_custom {
       private:
         const bool m_with_header; ///< Whether the map has a `fNBytes+fVersion` header.
         const int m_objwise_or_memberwise{ -1 }; ///< -1: auto, 0: obj-wise, 1: member-wise
-        SharedVector<int64_t> m_offsets;         ///< Store the offsets for each map.
+        shared_ptr<OffsetsVector> m_offsets;     ///< Store the offsets for each map.
         SharedReader m_key_reader;               ///< Reader for the keys of the map.
         SharedReader m_value_reader;             ///< Reader for the values of the map.
 
+        using PairKernel = void ( * )( void*, void*, const uint8_t*, const size_t );
+        IPrimitiveReader* m_key_primitive{ nullptr };   ///< @ref m_key_reader, if primitive
+        IPrimitiveReader* m_value_primitive{ nullptr }; ///< @ref m_value_reader, if primitive
+        PairKernel m_pair_kernel{ nullptr };            ///< decodes pairs of primitives
+
+        template <size_t KeySize>
+        static PairKernel pair_kernel( const size_t value_size ) {
+            switch ( value_size )
+            {
+            case 1: return &bswap_copy_pairs<KeySize, 1>;
+            case 2: return &bswap_copy_pairs<KeySize, 2>;
+            case 4: return &bswap_copy_pairs<KeySize, 4>;
+            case 8: return &bswap_copy_pairs<KeySize, 8>;
+            default: return nullptr;
+            }
+        }
+
+        static PairKernel pair_kernel( const size_t key_size, const size_t value_size ) {
+            switch ( key_size )
+            {
+            case 1: return pair_kernel<1>( value_size );
+            case 2: return pair_kernel<2>( value_size );
+            case 4: return pair_kernel<4>( value_size );
+            case 8: return pair_kernel<8>( value_size );
+            default: return nullptr;
+            }
+        }
+
       public:
         /**
          * @brief Construct a new STLMapReader object.
@@ -455,9 +660,15 @@ namespace uproot_custom {
             : IReader( name )
             , m_with_header( with_header )
             , m_objwise_or_memberwise( objwise_or_memberwise )
-            , m_offsets( std::make_shared<vector<int64_t>>( 1, 0 ) )
+            , m_offsets( std::make_shared<OffsetsVector>() )
             , m_key_reader( key_reader )
-            , m_value_reader( value_reader ) {}
+            , m_value_reader( value_reader ) {
+            m_key_primitive   = dynamic_cast<IPrimitiveReader*>( m_key_reader.get() );
+            m_value_primitive = dynamic_cast<IPrimitiveReader*>( m_value_reader.get() );
+            if ( m_key_primitive && m_value_primitive )
+                m_pair_kernel = pair_kernel( m_key_primitive->value_size(),
+                                             m_value_primitive->value_size() );
+        }
 
         /**
          * @brief Check if the reading mode matches the expected mode.
@@ -490,7 +701,8 @@ namespace uproot_custom {
          * @brief Read the body of the map from the stream. First reads the size
          * (uint32_t) of the map, then calls @ref m_key_reader and @ref m_value_reader
          * to read the keys and values. If member-wise, reads all keys first, then all values.
-         * Otherwise, reads key-value pairs one by one.
+         * Otherwise, reads key-value pairs one by one, or, if both the keys and the values
+         * are primitives, splits all pairs into the two columns at once.
          *
          * @param stream The binary stream to read from.
          * @param is_memberwise Whether the current reading mode is member-wise.
@@ -504,6 +716,14 @@ namespace uproot_custom {
                 m_key_reader->read_many( stream, fSize );
                 m_value_reader->read_many( stream, fSize );
             }
+            else if ( m_pair_kernel )
+            {
+                auto pair_size =
+                    m_key_primitive->value_size() + m_value_primitive->value_size();
+                auto pairs = stream.read_bytes( fSize * pair_size );
+                m_pair_kernel( m_key_primitive->append( fSize ),
+                               m_value_primitive->append( fSize ), pairs, fSize );
+            }
             else
             {
                 for ( auto i = 0; i < fSize; i++ )
@@ -522,6 +742,7 @@ namespace uproot_custom {
          * @param stream The binary stream to read from.
          */
         void read( BinaryStream& stream ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kRead, 1 );
             stream.read_fNBytes();
             auto fVersion = stream.read_fVersion();
             read_element_version( stream );
@@ -542,6 +763,7 @@ namespace uproot_custom {
          * @return Number of maps read.
          */
         uint32_t read_many( BinaryStream& stream, const int64_t count ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kReadMany, count );
             if ( count == 0 ) return 0;
             else if ( count < 0 )
             {
@@ -593,6 +815,7 @@ namespace uproot_custom {
          * @return Number of maps read.
          */
         uint32_t read_until( BinaryStream& stream, const uint8_t* end_pos ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kReadUntil );
             if ( stream.get_cursor() == end_pos ) return 0;
 
             bool is_memberwise = m_objwise_or_memberwise == 1;
@@ -612,7 +835,7 @@ namespace uproot_custom {
                 read_body( stream, is_memberwise );
                 cur_count++;
             }
-            return cur_count;
+            return profile.produced( cur_count );
         }
 
         /**
@@ -624,6 +847,7 @@ namespace uproot_custom {
          */
         virtual uint32_t read_many_memberwise( BinaryStream& stream,
                                                const int64_t count ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kReadManyMemberwise, count );
             if ( count < 0 )
             {
                 stringstream msg;
@@ -636,6 +860,35 @@ namespace uproot_custom {
             return read_many( stream, count );
         }
 
+        /**
+         * @brief Discard the read offsets and reset @ref m_key_reader and @ref
+         * m_value_reader.
+         */
+        void reset() override {
+            m_offsets->clear();
+            m_key_reader->reset();
+            m_value_reader->reset();
+        }
+
+        /**
+         * @brief Reserve offsets for `n_entries` maps. The number of elements is unknown,
+         * so half of `n_bytes` is forwarded to each of the key and value readers.
+         */
+        void reserve( const uint64_t n_entries, const uint64_t n_bytes ) override {
+            m_offsets->reserve( m_offsets->size() + n_entries );
+            m_key_reader->reserve( 0, n_bytes / 2 );
+            m_value_reader->reserve( 0, n_bytes / 2 );
+        }
+
+        /**
+         * @brief Select the layout of the offsets and forward it to the sub-readers.
+         */
+        void set_offsets_format( const OffsetsFormat format ) override {
+            m_offsets->set_format( format );
+            m_key_reader->set_offsets_format( format );
+            m_value_reader->set_offsets_format( format );
+        }
+
         /**
          * @brief Get the data read by the reader. This should be called after the whole
          * reading process.
@@ -643,7 +896,7 @@ namespace uproot_custom {
          * @return A tuple contains: (offsets, keys_data, values_data).
          */
         py::object data() const override {
-            auto offsets_array     = make_array( m_offsets );
+            auto offsets_array     = make_offsets_array( m_offsets );
             py::object keys_data   = m_key_reader->data();
             py::object values_data = m_value_reader->data();
             return py::make_tuple( offsets_array, keys_data, values_data );
@@ -656,8 +909,8 @@ namespace uproot_custom {
     class STLStringReader : public IReader {
       private:
         const bool m_with_header; ///< Whether the string has a `fNBytes+fVersion` header.
-        SharedVector<int64_t> m_offsets; ///< Store the offsets for each string.
-        SharedVector<uint8_t> m_data;    ///< Store the string data as uint8_t.
+        shared_ptr<OffsetsVector> m_offsets; ///< Store the offsets for each string.
+        SharedVector<uint8_t> m_data;        ///< Store the string data as uint8_t.
 
       public:
         /**
@@ -669,8 +922,8 @@ namespace uproot_custom {
         STLStringReader( string name, bool with_header )
             : IReader( name )
             , m_with_header( with_header )
-            , m_offsets( std::make_shared<vector<int64_t>>( 1, 0 ) )
-            , m_data( std::make_shared<vector<uint8_t>>() ) {}
+            , m_offsets( std::make_shared<OffsetsVector>() )
+            , m_data( std::make_shared<ArenaVector<uint8_t>>() ) {}
 
         /**
          * @brief Read the body of the string from the stream. A string starts with a uint8_t
@@ -680,11 +933,9 @@ namespace uproot_custom {
          * @param stream The binary stream to read from.
          */
         void read_body( BinaryStream& stream ) {
-            uint32_t fSize = stream.read<uint8_t>();
-            if ( fSize == 255 ) fSize = stream.read<uint32_t>();
-
+            auto [payload, fSize] = stream.read_TString_view();
             m_offsets->push_back( m_offsets->back() + fSize );
-            for ( int i = 0; i < fSize; i++ ) { m_data->push_back( stream.read<uint8_t>() ); }
+            m_data->insert( m_data->end(), payload, payload + fSize );
         }
 
         /**
@@ -694,6 +945,7 @@ namespace uproot_custom {
          * @param stream The binary stream to read from.
          */
         void read( BinaryStream& stream ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kRead, 1 );
             if ( m_with_header )
             {
                 stream.read_fNBytes();
@@ -712,6 +964,7 @@ namespace uproot_custom {
          * @return Number of strings read.
          */
         uint32_t read_many( BinaryStream& stream, const int64_t count ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kReadMany, count );
             if ( count == 0 ) return 0;
             else if ( count < 0 )
             {
@@ -753,6 +1006,7 @@ namespace uproot_custom {
          * @return Number of strings read.
          */
         uint32_t read_until( BinaryStream& stream, const uint8_t* end_pos ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kReadUntil );
             if ( stream.get_cursor() == end_pos ) return 0;
             if ( m_with_header )
             {
@@ -766,7 +1020,30 @@ namespace uproot_custom {
                 read_body( stream );
                 cur_count++;
             }
-            return cur_count;
+            return profile.produced( cur_count );
+        }
+
+        /**
+         * @brief Discard the read data.
+         */
+        void reset() override {
+            m_offsets->clear();
+            m_data    = std::make_shared<ArenaVector<uint8_t>>();
+        }
+
+        /**
+         * @brief Reserve offsets for `n_entries` strings and at most `n_bytes` characters.
+         */
+        void reserve( const uint64_t n_entries, const uint64_t n_bytes ) override {
+            m_offsets->reserve( m_offsets->size() + n_entries );
+            m_data->reserve( m_data->size() + n_bytes );
+        }
+
+        /**
+         * @brief Select the layout of the offsets.
+         */
+        void set_offsets_format( const OffsetsFormat format ) override {
+            m_offsets->set_format( format );
         }
 
         /**
@@ -776,7 +1053,7 @@ namespace uproot_custom {
          * @return A tuple of numpy arrays: (offsets, data).
          */
         py::object data() const override {
-            auto offsets_array = make_array( m_offsets );
+            auto offsets_array = make_offsets_array( m_offsets );
             auto data_array    = make_array( m_data );
             return py::make_tuple( offsets_array, data_array );
         }
@@ -796,45 +1073,102 @@ namespace uproot_custom {
     template <typename T>
     class TArrayReader : public IReader {
       private:
-        SharedVector<int64_t> m_offsets; ///< Store the offsets for each TArray.
-        SharedVector<T> m_data;          ///< Store the TArray data.
+        const bool m_keep_big_endian; ///< Whether to keep the data in big-endian byte order.
+        shared_ptr<OffsetsVector> m_offsets; ///< Store the offsets for each TArray.
+        SharedVector<T> m_data;              ///< Store the TArray data.
 
       public:
         /**
          * @brief Construct a new TArrayReader object.
          *
          * @param name Name of the reader.
+         * @param keep_big_endian Whether to keep the data in big-endian byte order. If true,
+         * the bytes are copied without swapping, and @ref data() returns them with a
+         * big-endian numpy dtype.
          */
-        TArrayReader( string name )
+        TArrayReader( string name, bool keep_big_endian = false )
             : IReader( name )
-            , m_offsets( std::make_shared<vector<int64_t>>( 1, 0 ) )
-            , m_data( std::make_shared<vector<T>>() ) {}
+            , m_keep_big_endian( keep_big_endian )
+            , m_offsets( std::make_shared<OffsetsVector>() )
+            , m_data( std::make_shared<ArenaVector<T>>() ) {}
 
         /**
          * @brief Read a TArray from the stream. First reads the size (uint32_t) of the TArray,
-         * then reads the elements of the TArray.
+         * then reads the elements of the TArray as one contiguous block.
          *
          * @param stream The binary stream to read from.
          */
         void read( BinaryStream& stream ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kRead, 1 );
             auto fSize = stream.read<uint32_t>();
             m_offsets->push_back( m_offsets->back() + fSize );
-            for ( auto i = 0; i < fSize; i++ ) { m_data->push_back( stream.read<T>() ); }
+
+            auto old_size = m_data->size();
+            m_data->resize( old_size + fSize );
+            if ( m_keep_big_endian )
+            {
+                std::memcpy( m_data->data() + old_size,
+                             stream.read_bytes( fSize * sizeof( T ) ), fSize * sizeof( T ) );
+            }
+            else stream.read_array( m_data->data() + old_size, fSize );
+        }
+
+        /**
+         * @brief Discard the read data.
+         */
+        void reset() override {
+            m_offsets->clear();
+            m_data    = std::make_shared<ArenaVector<T>>();
+        }
+
+        /**
+         * @brief Reserve offsets for `n_entries` arrays and at most `n_bytes / sizeof(T)`
+         * values.
+         */
+        void reserve( const uint64_t n_entries, const uint64_t n_bytes ) override {
+            m_offsets->reserve( m_offsets->size() + n_entries );
+            m_data->reserve( m_data->size() + n_bytes / sizeof( T ) );
+        }
+
+        /**
+         * @brief Select the layout of the offsets.
+         */
+        void set_offsets_format( const OffsetsFormat format ) override {
+            m_offsets->set_format( format );
         }
 
         /**
          * @brief Get the data read by the reader. This should be called after the whole
          * reading process.
          *
-         * @return A tuple of numpy arrays: (offsets, data).
+         * @return A tuple of numpy arrays: (offsets, data). If @ref m_keep_big_endian is
+         * true, data is a view with big-endian dtype.
          */
         py::object data() const override {
-            auto offsets_array = make_array( m_offsets );
-            auto data_array    = make_array( m_data );
+            auto offsets_array = make_offsets_array( m_offsets );
+            py::object data_array = make_array( m_data );
+            if ( m_keep_big_endian )
+                data_array = data_array.attr( "view" )(
+                    py::dtype::of<T>().attr( "newbyteorder" )( ">" ) );
             return py::make_tuple( offsets_array, data_array );
         }
     };
 
+    /**
+     * @brief Declare a TArrayReader in a pybind11 module. Accepts both `(name)` and
+     * `(name, keep_big_endian)` constructor arguments.
+     *
+     * @tparam T Element type of the TArray.
+     * @param m The declaring pybind11 module.
+     * @param name The name of the reader class in Python.
+     */
+    template <typename T>
+    void declare_tarray_reader( py::module& m, const char* name ) {
+        py::class_<TArrayReader<T>, shared_ptr<TArrayReader<T>>, IReader>( m, name )
+            .def( py::init( &CreateReader<TArrayReader<T>, string> ) )
+            .def( py::init( &CreateReader<TArrayReader<T>, string, bool> ) );
+    }
+
     /*
     -----------------------------------------------------------------------------
     -----------------------------------------------------------------------------
@@ -865,11 +1199,12 @@ namespace uproot_custom {
          * @param stream The binary stream to read from.
          */
         void read( BinaryStream& stream ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kRead, 1 );
             for ( auto& reader : m_element_readers )
             {
-                debug_printf( "GroupReader %s: reading %s\n", m_name.c_str(),
-                              reader->name().c_str() );
-                debug_printf( stream );
+                UPROOT_CUSTOM_DEBUG_PRINTF( "GroupReader %s: reading %s\n", m_name.c_str(),
+                                            reader->name().c_str() );
+                UPROOT_CUSTOM_DEBUG_PRINTF( stream );
                 reader->read( stream );
             }
         }
@@ -884,6 +1219,7 @@ namespace uproot_custom {
          * @return Number of objects read. Should be equal to @ref count.
          */
         uint32_t read_many_memberwise( BinaryStream& stream, const int64_t count ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kReadManyMemberwise, count );
             if ( count < 0 )
             {
                 stringstream msg;
@@ -893,14 +1229,36 @@ namespace uproot_custom {
 
             for ( auto& reader : m_element_readers )
             {
-                debug_printf( "GroupReader %s: reading %s\n", m_name.c_str(),
-                              reader->name().c_str() );
-                debug_printf( stream );
+                UPROOT_CUSTOM_DEBUG_PRINTF( "GroupReader %s: reading %s\n", m_name.c_str(),
+                                            reader->name().c_str() );
+                UPROOT_CUSTOM_DEBUG_PRINTF( stream );
                 reader->read_many( stream, count );
             }
             return count;
         }
 
+        /**
+         * @brief Reset all grouped readers.
+         */
+        void reset() override { for ( auto& reader : m_element_readers ) reader->reset(); }
+
+        /**
+         * @brief Forward the hint to all grouped readers. The grouped readers share the
+         * bytes, so each of them gets an equal part of `n_bytes`.
+         */
+        void reserve( const uint64_t n_entries, const uint64_t n_bytes ) override {
+            if ( m_element_readers.empty() ) return;
+            const uint64_t share = n_bytes / m_element_readers.size();
+            for ( auto& reader : m_element_readers ) reader->reserve( n_entries, share );
+        }
+
+        /**
+         * @brief Forward the offsets layout to the sub-readers.
+         */
+        void set_offsets_format( const OffsetsFormat format ) override {
+            for ( auto& reader : m_element_readers ) reader->set_offsets_format( format );
+        }
+
         /**
          * @brief Get the data read by the reader. This should be called after the whole
          * reading process.
@@ -946,6 +1304,7 @@ namespace uproot_custom {
          * @param stream The binary stream to read from.
          */
         void read( BinaryStream& stream ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kRead, 1 );
             auto fNBytes   = stream.read_fNBytes();
             auto start_pos = stream.get_cursor();
             auto end_pos   = stream.get_cursor() + fNBytes;
@@ -955,9 +1314,9 @@ namespace uproot_custom {
 
             for ( auto& reader : m_element_readers )
             {
-                debug_printf( "AnyClassReader %s: reading %s\n", m_name.c_str(),
-                              reader->name().c_str() );
-                debug_printf( stream );
+                UPROOT_CUSTOM_DEBUG_PRINTF( "AnyClassReader %s: reading %s\n", m_name.c_str(),
+                                            reader->name().c_str() );
+                UPROOT_CUSTOM_DEBUG_PRINTF( stream );
                 reader->read( stream );
             }
 
@@ -979,6 +1338,7 @@ namespace uproot_custom {
          * @return Number of objects read. Should be equal to @ref count.
          */
         uint32_t read_many_memberwise( BinaryStream& stream, const int64_t count ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kReadManyMemberwise, count );
             if ( count < 0 )
             {
                 stringstream msg;
@@ -988,15 +1348,37 @@ namespace uproot_custom {
 
             for ( auto& reader : m_element_readers )
             {
-                debug_printf( "AnyClassReader %s: reading memberwise %s\n", m_name.c_str(),
-                              reader->name().c_str() );
-                debug_printf( stream );
+                UPROOT_CUSTOM_DEBUG_PRINTF( "AnyClassReader %s: reading memberwise %s\n",
+                                            m_name.c_str(), reader->name().c_str() );
+                UPROOT_CUSTOM_DEBUG_PRINTF( stream );
                 reader->read_many( stream, count );
             }
 
             return count;
         }
 
+        /**
+         * @brief Reset all element readers.
+         */
+        void reset() override { for ( auto& reader : m_element_readers ) reader->reset(); }
+
+        /**
+         * @brief Forward the hint to all element readers. The members share the bytes, so
+         * each of them gets an equal part of `n_bytes`.
+         */
+        void reserve( const uint64_t n_entries, const uint64_t n_bytes ) override {
+            if ( m_element_readers.empty() ) return;
+            const uint64_t share = n_bytes / m_element_readers.size();
+            for ( auto& reader : m_element_readers ) reader->reserve( n_entries, share );
+        }
+
+        /**
+         * @brief Forward the offsets layout to the sub-readers.
+         */
+        void set_offsets_format( const OffsetsFormat format ) override {
+            for ( auto& reader : m_element_readers ) reader->set_offsets_format( format );
+        }
+
         /**
          * @brief Get the data read by the reader. This should be called after the whole
          * reading process.
@@ -1016,74 +1398,372 @@ namespace uproot_custom {
     -----------------------------------------------------------------------------
     */
 
-    class AnyPointerReader : public IReader {
+    /**
+     * @brief Reader for classes made of primitive members only, such as
+     * `TPureStruct`. Produces the same data as an @ref AnyClassReader of @ref
+     * PrimitiveReader, i.e. one array per member, but reads the members itself without
+     * virtual dispatch. In member-wise mode, each member is one contiguous big-endian
+     * block, whose offset is known from the member sizes, so every block is byte-swapped
+     * into its column in one pass.
+     *
+     * Members with an empty dtype are skipped, like an @ref EmptyReader skipping a fixed
+     * number of bytes, and their data is None.
+     */
+    class PODClassReader : public IReader {
       private:
-        SharedReader m_element_reader; ///< Reader for the object content.
-
-        int64_t m_object_counter{ 0 }; ///< Counter for the number of objects read, used for
-                                       ///< generating indexes
+        const vector<string> m_dtypes;           ///< numpy dtype of each member
+        const vector<uint32_t> m_sizes;          ///< Size of each member in bytes
+        uint32_t m_row_size{ 0 };                ///< Size of all members in bytes
+        vector<SharedVector<uint8_t>> m_columns; ///< Native-endian data of each member
 
-        SharedVector<int64_t> m_object_indexes; ///< Store the indexes of the objects read
+        /**
+         * @brief Copy `count` values of member `i` from `src`, converting them to native
+         * byte order.
+         */
+        void append_column( const size_t i, const uint8_t* src, const size_t count ) {
+            auto& column   = m_columns[i];
+            auto old_bytes = column->size();
+            column->resize( old_bytes + count * m_sizes[i] );
+            auto dst = column->data() + old_bytes;
+            switch ( m_sizes[i] )
+            {
+            case 1: bswap_copy<1>( dst, src, count ); break;
+            case 2: bswap_copy<2>( dst, src, count ); break;
+            case 4: bswap_copy<4>( dst, src, count ); break;
+            case 8: bswap_copy<8>( dst, src, count ); break;
+            }
+        }
 
-        string m_class_name{}; ///< Store the class name of the object
+        /**
+         * @brief Replace the data of all members with new, empty buffers.
+         */
+        void reset_columns() {
+            m_columns.clear();
+            for ( size_t i = 0; i < m_sizes.size(); i++ )
+                m_columns.push_back( std::make_shared<ArenaVector<uint8_t>>() );
+        }
 
       public:
-        AnyPointerReader( string name, SharedReader element_reader )
-            : IReader( name )
-            , m_element_reader( element_reader )
-            , m_object_indexes( std::make_shared<vector<int64_t>>() ) {}
+        /**
+         * @brief Construct a new PODClassReader object.
+         *
+         * @param name Name of the reader.
+         * @param dtypes numpy dtype of each member, empty for skipped members.
+         * @param sizes Size of each member in bytes. Must be 1, 2, 4 or 8 for members that
+         * are not skipped.
+         */
+        PODClassReader( string name, vector<string> dtypes, vector<uint32_t> sizes )
+            : IReader( name ), m_dtypes( dtypes ), m_sizes( sizes ) {
+            if ( m_dtypes.size() != m_sizes.size() )
+                throw std::runtime_error( "PODClassReader(" + name +
+                                          "): dtypes and sizes differ in length!" );
 
-        void check_cursor_position( BinaryStream& stream, const uint32_t expected_nbytes,
-                                    const uint8_t* expected_pos ) {
-            if ( stream.get_cursor() != expected_pos )
+            for ( size_t i = 0; i < m_sizes.size(); i++ )
             {
-                stringstream msg;
-                msg << "AnyPointerReader(" << name() << "): Invalid read length! Expect "
-                    << expected_nbytes << " bytes, got "
-                    << static_cast<int64_t>( expected_nbytes ) -
-                           ( expected_pos - stream.get_cursor() )
-                    << " bytes.";
-                throw std::runtime_error( msg.str() );
+                auto size = m_sizes[i];
+                if ( !m_dtypes[i].empty() && size != 1 && size != 2 && size != 4 &&
+                     size != 8 )
+                {
+                    stringstream msg;
+                    msg << "PODClassReader(" << name << "): unsupported size " << size
+                        << " of member " << i;
+                    throw std::runtime_error( msg.str() );
+                }
+                m_row_size += size;
             }
+            reset_columns();
         }
 
+        /**
+         * @brief Read an object-wise object: the `fNBytes+fVersion` header, then one value
+         * of each member.
+         *
+         * @param stream The binary stream to read from.
+         */
         void read( BinaryStream& stream ) override {
-            auto start_ptr     = stream.get_cursor();
-            uint32_t start_pos = stream.get_index();
-            uint32_t ref_begin = start_pos + stream.get_initial_cursor_offset();
-            auto fNBytes       = stream.read<uint32_t>();
+            ProfileScope profile( stream, this, ReadProfiler::kRead, 1 );
+            auto fNBytes   = stream.read_fNBytes();
+            auto start_pos = stream.get_cursor();
+            auto end_pos   = stream.get_cursor() + fNBytes;
 
-            int16_t fVersion;
-            uint32_t fTag;
+            auto fVersion = stream.read_fVersion();
+            if ( fVersion == 0 ) stream.skip( 4 ); // skip checksum for fVersion 0
 
-            if ( ( fNBytes & kByteCountMask ) == 0 || fNBytes == kNewClassTag )
+            for ( size_t i = 0; i < m_sizes.size(); i++ )
             {
-                fVersion  = 0;
-                ref_begin = 0;
-                fTag      = fNBytes;
-                fNBytes   = 0;
+                auto value = stream.read_bytes( m_sizes[i] );
+                if ( !m_dtypes[i].empty() ) append_column( i, value, 1 );
             }
-            else
+
+            if ( stream.get_cursor() != end_pos )
             {
-                fVersion = 1;
-                fTag     = stream.read<uint32_t>();
-                fNBytes &= ~kByteCountMask;
+                stringstream msg;
+                msg << "PODClassReader: Invalid read length for " << name() << "! Expect "
+                    << end_pos - start_pos << ", got " << stream.get_cursor() - start_pos;
+                throw std::runtime_error( msg.str() );
             }
+        }
 
-            auto end_ptr = fVersion > 0 ? start_ptr + 4 + fNBytes : start_ptr + 4;
+        /**
+         * @brief Read `count` member-wise objects, i.e. `count` values of the first
+         * member, then `count` values of the second member, and so on.
+         *
+         * @param stream The binary stream to read from.
+         * @param count Number of objects to read.
+         * @return Number of objects read.
+         */
+        uint32_t read_many_memberwise( BinaryStream& stream, const int64_t count ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kReadManyMemberwise, count );
+            if ( count < 0 )
+            {
+                stringstream msg;
+                msg << name() << "::read_many_memberwise with negative count: " << count;
+                throw std::runtime_error( msg.str() );
+            }
 
-            if ( ( fTag & kClassMask ) == 0 )
+            auto block = stream.read_bytes( m_row_size * count );
+            for ( size_t i = 0; i < m_sizes.size(); i++ )
             {
-                if ( fTag == 0 )
-                {
-                    check_cursor_position( stream, fNBytes, end_ptr );
-                    m_object_indexes->push_back( -1 ); // use -1 to indicate null pointer
-                    return;
-                }
-                else if ( fTag == 1 )
-                    throw std::runtime_error( "AnyPointerReader(" + name() +
+                if ( !m_dtypes[i].empty() ) append_column( i, block, count );
+                block += m_sizes[i] * count;
+            }
+            return count;
+        }
+
+        /**
+         * @brief Discard the read data.
+         */
+        void reset() override { reset_columns(); }
+
+        /**
+         * @brief Reserve one value of each member per entry if the number of entries is
+         * known, otherwise the upper bound of `n_bytes / row size` values.
+         */
+        void reserve( const uint64_t n_entries, const uint64_t n_bytes ) override {
+            if ( m_row_size == 0 ) return;
+            auto n_rows = n_entries ? n_entries : n_bytes / m_row_size;
+            for ( size_t i = 0; i < m_sizes.size(); i++ )
+            {
+                if ( m_dtypes[i].empty() ) continue;
+                m_columns[i]->reserve( m_columns[i]->size() + n_rows * m_sizes[i] );
+            }
+        }
+
+        /**
+         * @brief Get the data read by the reader.
+         *
+         * @return A list with the array of each member, or None for skipped members.
+         */
+        py::object data() const override {
+            py::list res;
+            for ( size_t i = 0; i < m_sizes.size(); i++ )
+            {
+                if ( m_dtypes[i].empty() ) res.append( py::none() );
+                else res.append( make_array( m_columns[i] ).attr( "view" )( m_dtypes[i] ) );
+            }
+            return res;
+        }
+    };
+
+    /*
+    -----------------------------------------------------------------------------
+    -----------------------------------------------------------------------------
+    -----------------------------------------------------------------------------
+    */
+
+    /**
+     * @brief Index the members of object-wise objects without decoding them. For each
+     * object, records the position of each member in the stream, then jumps over the member
+     * with a skipping reader (see @ref EmptyReader). The recorded spans are decoded later,
+     * one member at a time, by `read_data_spans`.
+     */
+    class MemberSpanReader : public IReader {
+      private:
+        vector<SharedReader> m_skippers;            ///< Reader skipping each member
+        vector<SharedVector<uint32_t>> m_positions; ///< Start of each member, then the end
+
+        /**
+         * @brief Replace the positions of all members with new, empty buffers.
+         */
+        void reset_positions() {
+            m_positions.clear();
+            for ( size_t i = 0; i <= m_skippers.size(); i++ )
+                m_positions.push_back( std::make_shared<ArenaVector<uint32_t>>() );
+        }
+
+      public:
+        /**
+         * @brief Construct a new MemberSpanReader object.
+         *
+         * @param name Name of the reader.
+         * @param skippers Reader skipping each member of the class, in order.
+         */
+        MemberSpanReader( string name, vector<SharedReader> skippers )
+            : IReader( name ), m_skippers( skippers ) {
+            reset_positions();
+        }
+
+        /**
+         * @brief Index an object: reads the `fNBytes+fVersion` header, then records the
+         * start of each member before skipping it, and the end of the last member.
+         *
+         * @param stream The binary stream to read from.
+         */
+        void read( BinaryStream& stream ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kRead, 1 );
+            auto fNBytes   = stream.read_fNBytes();
+            auto start_pos = stream.get_cursor();
+            auto end_pos   = stream.get_cursor() + fNBytes;
+
+            auto fVersion = stream.read_fVersion();
+            if ( fVersion == 0 ) stream.skip( 4 ); // skip checksum for fVersion 0
+
+            for ( size_t i = 0; i < m_skippers.size(); i++ )
+            {
+                m_positions[i]->push_back( stream.get_index() );
+                m_skippers[i]->read( stream );
+            }
+            m_positions.back()->push_back( stream.get_index() );
+
+            if ( stream.get_cursor() != end_pos )
+            {
+                stringstream msg;
+                msg << "MemberSpanReader: Invalid read length for " << name() << "! Expect "
+                    << end_pos - start_pos << ", got " << stream.get_cursor() - start_pos;
+                throw std::runtime_error( msg.str() );
+            }
+        }
+
+        /**
+         * @brief Discard the recorded positions and the data of the skipping readers.
+         */
+        void reset() override {
+            reset_positions();
+            for ( auto& skipper : m_skippers ) skipper->reset();
+        }
+
+        /**
+         * @brief Reserve one position per entry for each member span. The members are only
+         * skipped, so `n_bytes` is not used.
+         */
+        void reserve( const uint64_t n_entries, const uint64_t n_bytes ) override {
+            for ( auto& positions : m_positions )
+                positions->reserve( positions->size() + n_entries );
+        }
+
+        /**
+         * @brief Forward the offsets layout to the sub-readers.
+         */
+        void set_offsets_format( const OffsetsFormat format ) override {
+            for ( auto& skipper : m_skippers ) skipper->set_offsets_format( format );
+        }
+
+        /**
+         * @brief Get the recorded positions.
+         *
+         * @return A list with the start of each member in each object, followed by the end
+         * of the last member in each object.
+         */
+        py::object data() const override {
+            py::list res;
+            for ( auto& positions : m_positions ) res.append( make_array( positions ) );
+            return res;
+        }
+    };
+
+    /*
+    -----------------------------------------------------------------------------
+    -----------------------------------------------------------------------------
+    -----------------------------------------------------------------------------
+    */
+
+    class AnyPointerReader : public IReader {
+      private:
+        SharedReader m_element_reader; ///< Reader for the object content.
+
+        int64_t m_object_counter{ 0 }; ///< Counter for the number of objects read, used for
+                                       ///< generating indexes
+
+        SharedVector<int64_t> m_object_indexes; ///< Store the indexes of the objects read
+
+        string m_class_name{}; ///< Store the class name of the object
+
+        const bool m_reset_refs; ///< Whether references are discarded at each new entry
+
+      public:
+        /**
+         * @brief Construct a new AnyPointerReader object.
+         *
+         * @param name Name of the reader.
+         * @param element_reader Reader of the pointed objects.
+         * @param reset_refs Whether the references registered in previous entries are
+         * discarded, see @ref BinaryStream::reset_refs_per_entry(). Only valid when no
+         * pointer refers to an object of another entry. Tags are numbered the same either
+         * way.
+         */
+        AnyPointerReader( string name, SharedReader element_reader,
+                          const bool reset_refs = false )
+            : IReader( name )
+            , m_element_reader( element_reader )
+            , m_object_indexes( std::make_shared<ArenaVector<int64_t>>() )
+            , m_reset_refs( reset_refs ) {}
+
+        void check_cursor_position( BinaryStream& stream, const uint32_t expected_nbytes,
+                                    const uint8_t* expected_pos ) {
+            if ( stream.get_cursor() != expected_pos )
+            {
+                stringstream msg;
+                msg << "AnyPointerReader(" << name() << "): Invalid read length! Expect "
+                    << expected_nbytes << " bytes, got "
+                    << static_cast<int64_t>( expected_nbytes ) -
+                           ( expected_pos - stream.get_cursor() )
+                    << " bytes.";
+                throw std::runtime_error( msg.str() );
+            }
+        }
+
+        void read( BinaryStream& stream ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kRead, 1 );
+            if ( m_reset_refs ) stream.reset_refs_per_entry();
+
+            auto start_ptr     = stream.get_cursor();
+            uint32_t start_pos = stream.get_index();
+            uint32_t ref_begin = start_pos + stream.get_initial_cursor_offset();
+            auto fNBytes       = stream.read<uint32_t>();
+
+            int16_t fVersion;
+            uint32_t fTag;
+
+            if ( ( fNBytes & kByteCountMask ) == 0 || fNBytes == kNewClassTag )
+            {
+                fVersion  = 0;
+                ref_begin = 0;
+                fTag      = fNBytes;
+                fNBytes   = 0;
+            }
+            else
+            {
+                fVersion = 1;
+                fTag     = stream.read<uint32_t>();
+                fNBytes &= ~kByteCountMask;
+            }
+
+            auto end_ptr = fVersion > 0 ? start_ptr + 4 + fNBytes : start_ptr + 4;
+
+            if ( ( fTag & kClassMask ) == 0 )
+            {
+                if ( fTag == 0 )
+                {
+                    check_cursor_position( stream, fNBytes, end_ptr );
+                    m_object_indexes->push_back( -1 ); // use -1 to indicate null pointer
+                    return;
+                }
+                else if ( fTag == 1 )
+                    throw std::runtime_error( "AnyPointerReader(" + name() +
                                               "): Unsupported fTag value 1" );
-                else if ( stream.get_refs().find( fTag ) == stream.get_refs().end() )
+
+                auto ref = stream.find_ref( fTag );
+                if ( ref == nullptr )
                 {
                     // skip unknown reference
                     auto nskip = end_ptr - stream.get_cursor();
@@ -1091,11 +1771,16 @@ namespace uproot_custom {
                     check_cursor_position( stream, fNBytes, end_ptr );
                     return;
                 }
+                else if ( ref->kind != BinaryStream::Reference::kObject )
+                {
+                    stringstream msg;
+                    msg << "AnyPointerReader(" << name() << "): Reference " << fTag
+                        << " is a class, expect an object";
+                    throw std::runtime_error( msg.str() );
+                }
                 else
                 {
-                    auto ref     = stream.get_refs().at( fTag );
-                    auto ref_idx = std::get<BinaryStream::RefObj>( ref ).index;
-                    m_object_indexes->push_back( ref_idx );
+                    m_object_indexes->push_back( ref->value );
                     check_cursor_position( stream, fNBytes, end_ptr );
                     return;
                 }
@@ -1113,27 +1798,25 @@ namespace uproot_custom {
                     throw std::runtime_error( msg.str() );
                 }
 
-                auto& buf_refs = stream.get_refs();
-
-                auto ref_key = fVersion > 0 ? ref_begin + kMapOffset : buf_refs.size() + 1;
-                buf_refs[ref_key] = BinaryStream::RefCls{ class_name };
+                auto ref_key = fVersion > 0 ? ref_begin + kMapOffset : stream.n_refs() + 1;
+                stream.set_ref( ref_key, { BinaryStream::Reference::kClass,
+                                           stream.intern_class_name( class_name ) } );
 
                 m_element_reader->read( stream );
                 m_object_indexes->push_back( m_object_counter );
 
-                ref_key = fVersion > 0 ? ref_begin + kMapOffset : buf_refs.size() + 1;
-                buf_refs[ref_key] = BinaryStream::RefObj{ m_object_counter };
+                ref_key = fVersion > 0 ? ref_begin + kMapOffset : stream.n_refs() + 1;
+                stream.set_ref( ref_key,
+                                { BinaryStream::Reference::kObject, m_object_counter } );
 
                 m_object_counter++;
             }
             else
             {
-                auto& buf_refs   = stream.get_refs();
                 auto cls_ref_key = fTag & ( ~kClassMask );
-                if ( buf_refs.find( cls_ref_key ) != buf_refs.end() )
+                if ( auto cls_ref = stream.find_ref( cls_ref_key ) )
                 {
-                    auto class_name =
-                        std::get<BinaryStream::RefCls>( buf_refs.at( cls_ref_key ) ).name;
+                    const auto& class_name = stream.class_name( cls_ref->value );
                     if ( class_name != m_class_name )
                     {
                         stringstream msg;
@@ -1147,8 +1830,9 @@ namespace uproot_custom {
                 m_element_reader->read( stream );
                 m_object_indexes->push_back( m_object_counter );
 
-                auto obj_ref_key = fVersion > 0 ? ref_begin + kMapOffset : buf_refs.size() + 1;
-                buf_refs[obj_ref_key] = BinaryStream::RefObj{ m_object_counter };
+                auto obj_ref_key = fVersion > 0 ? ref_begin + kMapOffset : stream.n_refs() + 1;
+                stream.set_ref( obj_ref_key,
+                                { BinaryStream::Reference::kObject, m_object_counter } );
 
                 m_object_counter++;
             }
@@ -1156,6 +1840,29 @@ namespace uproot_custom {
             check_cursor_position( stream, fNBytes, end_ptr );
         }
 
+        void reset() override {
+            m_object_counter = 0;
+            m_object_indexes = std::make_shared<ArenaVector<int64_t>>();
+            m_class_name.clear();
+            m_element_reader->reset();
+        }
+
+        /**
+         * @brief Reserve one object index per entry. The number of objects is unknown, so
+         * only `n_bytes` is forwarded to the element reader.
+         */
+        void reserve( const uint64_t n_entries, const uint64_t n_bytes ) override {
+            m_object_indexes->reserve( m_object_indexes->size() + n_entries );
+            m_element_reader->reserve( 0, n_bytes );
+        }
+
+        /**
+         * @brief Forward the offsets layout to the sub-readers.
+         */
+        void set_offsets_format( const OffsetsFormat format ) override {
+            m_element_reader->set_offsets_format( format );
+        }
+
         py::object data() const override {
             auto element_data  = m_element_reader->data();
             auto indexes_array = make_array( m_object_indexes );
@@ -1176,9 +1883,9 @@ namespace uproot_custom {
       private:
         const int64_t m_flat_size; ///< Flatten size of the array. If negative, means variable
                                    ///< size.
-        SharedVector<int64_t> m_offsets; ///< Store the offsets for each array (only used when
-                                         ///< variable size).
-        SharedReader m_element_reader;   ///< Reader for the array elements.
+        shared_ptr<OffsetsVector> m_offsets; ///< Store the offsets for each array (only used
+                                             ///< when variable size).
+        SharedReader m_element_reader;       ///< Reader for the array elements.
 
       public:
         /**
@@ -1191,7 +1898,7 @@ namespace uproot_custom {
         CStyleArrayReader( string name, const int64_t flat_size, SharedReader element_reader )
             : IReader( name )
             , m_flat_size( flat_size )
-            , m_offsets( std::make_shared<vector<int64_t>>( 1, 0 ) )
+            , m_offsets( std::make_shared<OffsetsVector>() )
             , m_element_reader( element_reader ) {}
 
         /**
@@ -1202,27 +1909,19 @@ namespace uproot_custom {
          * @param stream The binary stream to read from.
          */
         void read( BinaryStream& stream ) override {
-            debug_printf( "CStyleArrayReader(%s) with flat_size %ld\n", m_name.c_str(),
-                          m_flat_size );
-            debug_printf( stream );
+            ProfileScope profile( stream, this, ReadProfiler::kRead, 1 );
+            UPROOT_CUSTOM_DEBUG_PRINTF( "CStyleArrayReader(%s) with flat_size %ld\n",
+                                        m_name.c_str(), m_flat_size );
+            UPROOT_CUSTOM_DEBUG_PRINTF( stream );
 
             if ( m_flat_size >= 0 ) { m_element_reader->read_many( stream, m_flat_size ); }
             else
             {
-                // get end-position
-                auto n_entries     = stream.entries();
-                auto start_pos     = stream.get_data();
-                auto entry_offsets = stream.get_offsets();
-                auto cursor_pos    = stream.get_cursor();
-                auto entry_end = std::find_if( entry_offsets, entry_offsets + n_entries + 1,
-                                               [start_pos, cursor_pos]( uint32_t offset ) {
-                                                   return start_pos + offset > cursor_pos;
-                                               } );
-                auto end_pos   = start_pos + *entry_end;
+                auto end_pos   = stream.current_entry_end();
                 uint32_t count = m_element_reader->read_until( stream, end_pos );
                 m_offsets->push_back( m_offsets->back() + count );
-                debug_printf( "CStyleArrayReader(%s) read %d elements\n", m_name.c_str(),
-                              count );
+                UPROOT_CUSTOM_DEBUG_PRINTF( "CStyleArrayReader(%s) read %d elements\n",
+                                            m_name.c_str(), count );
             }
         }
 
@@ -1235,6 +1934,7 @@ namespace uproot_custom {
          * @return Number of arrays read.
          */
         uint32_t read_many( BinaryStream& stream, const int64_t count ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kReadMany, count );
             if ( m_flat_size < 0 )
             {
                 stringstream msg;
@@ -1267,6 +1967,37 @@ namespace uproot_custom {
             throw std::runtime_error( "CStyleArrayReader::read with end_pos not supported!" );
         }
 
+        /**
+         * @brief Discard the read offsets and reset @ref m_element_reader.
+         */
+        void reset() override {
+            m_offsets->clear();
+            m_element_reader->reset();
+        }
+
+        /**
+         * @brief Forward `n_entries * flat_size` elements to the element reader for fixed
+         * size arrays. For variable size arrays, reserve offsets for `n_entries` arrays and
+         * only forward `n_bytes`.
+         */
+        void reserve( const uint64_t n_entries, const uint64_t n_bytes ) override {
+            if ( m_flat_size >= 0 )
+                m_element_reader->reserve( n_entries * m_flat_size, n_bytes );
+            else
+            {
+                m_offsets->reserve( m_offsets->size() + n_entries );
+                m_element_reader->reserve( 0, n_bytes );
+            }
+        }
+
+        /**
+         * @brief Select the layout of the offsets and forward it to the sub-readers.
+         */
+        void set_offsets_format( const OffsetsFormat format ) override {
+            m_offsets->set_format( format );
+            m_element_reader->set_offsets_format( format );
+        }
+
         /**
          * @brief Get the data read by the reader. This should be called after the whole
          * reading process.
@@ -1278,7 +2009,7 @@ namespace uproot_custom {
             if ( m_flat_size >= 0 ) return m_element_reader->data();
             else
             {
-                auto offsets_array = make_array( m_offsets );
+                auto offsets_array = make_offsets_array( m_offsets );
                 auto elements_data = m_element_reader->data();
                 return py::make_tuple( offsets_array, elements_data );
             }
@@ -1292,21 +2023,128 @@ namespace uproot_custom {
     */
 
     /**
-     * @brief Reader that does nothing and returns None.
+     * @brief Reader for members that are not requested. It moves the cursor past the
+     * member without storing anything, and returns None. Depending on how it is
+     * constructed, it:
+     *
+     * - does nothing, for members that take no space in the stream;
+     * - skips a fixed number of bytes per element, e.g. for primitives;
+     * - jumps over each element using its `fNBytes` byte count, e.g. for classes;
+     * - jumps over all elements of a call using their shared `fNBytes` byte count, e.g. for
+     *   STL containers with a header;
+     * - otherwise, parses the elements with an element reader, whose data is discarded.
      */
     class EmptyReader : public IReader {
+      private:
+        const uint32_t m_element_size{ 0 };       ///< Size of each element, 0 if variable
+        const bool m_jump_by_byte_count{ false }; ///< Jump over elements with `fNBytes`
+        const bool m_shared_byte_count{ false };  ///< One `fNBytes` for all elements
+        SharedReader m_element_reader;            ///< Reader parsing the skipped elements
+
       public:
         /**
-         * @brief Construct a new EmptyReader object.
+         * @brief Construct an EmptyReader that does nothing.
          *
          * @param name Name of the reader.
          */
         EmptyReader( string name ) : IReader( name ) {}
 
         /**
-         * @brief Do nothing.
+         * @brief Construct an EmptyReader skipping elements of a fixed size.
+         *
+         * @param name Name of the reader.
+         * @param element_size Size of each element in bytes.
+         */
+        EmptyReader( string name, uint32_t element_size )
+            : IReader( name ), m_element_size( element_size ) {}
+
+        /**
+         * @brief Construct an EmptyReader skipping elements of variable size.
+         *
+         * @param name Name of the reader.
+         * @param element_reader Reader of the elements, used when they cannot be jumped
+         * over.
+         * @param jump_by_byte_count Whether each element starts with a `fNBytes` byte count,
+         * so that it can be jumped over without parsing. Member-wise data is still parsed.
+         * @param shared_byte_count Whether the elements read by one @ref read_many() call
+         * share a single `fNBytes` byte count instead, like STL containers with a header,
+         * whose @ref STLSeqReader::read_many() reads one header for all sequences. Requires
+         * an element reader, which parses them in @ref read_until().
+         */
+        EmptyReader( string name, SharedReader element_reader, bool jump_by_byte_count,
+                     bool shared_byte_count = false )
+            : IReader( name )
+            , m_jump_by_byte_count( jump_by_byte_count )
+            , m_shared_byte_count( jump_by_byte_count && shared_byte_count )
+            , m_element_reader( element_reader ) {
+            if ( m_shared_byte_count && !m_element_reader )
+                throw std::runtime_error( "EmptyReader(" + name +
+                                          "): shared_byte_count requires an element reader!" );
+        }
+
+        void read( BinaryStream& stream ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kRead, 1 );
+            if ( m_element_size ) stream.skip( m_element_size );
+            else if ( m_jump_by_byte_count )
+            {
+                auto fNBytes = stream.read_fNBytes();
+                stream.skip( fNBytes );
+            }
+            else if ( m_element_reader ) m_element_reader->read( stream );
+        }
+
+        uint32_t read_many( BinaryStream& stream, const int64_t count ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kReadMany, count );
+            if ( count <= 0 ) return 0;
+            if ( m_element_size ) stream.skip( m_element_size * count );
+            else if ( m_shared_byte_count ) stream.skip( stream.read_fNBytes() );
+            else if ( m_jump_by_byte_count )
+                for ( int64_t i = 0; i < count; i++ ) stream.skip( stream.read_fNBytes() );
+            else if ( m_element_reader ) return m_element_reader->read_many( stream, count );
+            return count;
+        }
+
+        uint32_t read_until( BinaryStream& stream, const uint8_t* end_pos ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kReadUntil );
+            if ( stream.get_cursor() >= end_pos ) return 0;
+            if ( m_element_size )
+            {
+                uint32_t count = ( end_pos - stream.get_cursor() + m_element_size - 1 ) /
+                                 m_element_size;
+                stream.skip( m_element_size * count );
+                return profile.produced( count );
+            }
+            else if ( m_jump_by_byte_count && !m_shared_byte_count )
+            {
+                uint32_t count = 0;
+                for ( ; stream.get_cursor() < end_pos; count++ )
+                    stream.skip( stream.read_fNBytes() );
+                return profile.produced( count );
+            }
+            else if ( m_element_reader )
+                return profile.produced( m_element_reader->read_until( stream, end_pos ) );
+            return 0;
+        }
+
+        uint32_t read_many_memberwise( BinaryStream& stream, const int64_t count ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kReadManyMemberwise, count );
+            if ( !m_element_reader ) return IReader::read_many_memberwise( stream, count );
+            return m_element_reader->read_many_memberwise( stream, count );
+        }
+
+        /**
+         * @brief Discard the data parsed by the element reader, if any.
+         */
+        void reset() override {
+            if ( m_element_reader ) m_element_reader->reset();
+        }
+
+        /**
+         * @brief Forward the offsets layout to the element reader, if any.
          */
-        void read( BinaryStream& ) override {}
+        void set_offsets_format( const OffsetsFormat format ) override {
+            if ( m_element_reader ) m_element_reader->set_offsets_format( format );
+        }
 
         /**
          * @brief Return None.
@@ -1321,44 +2159,1112 @@ namespace uproot_custom {
     */
 
     /**
-     * @brief Read data from a binary stream using the provided reader.
+     * @brief Reader executing a flat program of opcodes instead of a tree of readers. The
+     * program is lowered from the factory tree in Python (see `uproot_custom.readers.plan`),
+     * and runs in one dispatch loop per object, without virtual calls or pointer chasing
+     * between the nodes. The output of all nodes is stored in flat columns; the nested
+     * structure of the equivalent reader tree is rebuilt in Python from a template.
      *
-     * @param data Binary data as a numpy array of uint8_t
-     * @param offsets Offsets for each entry as a numpy array of uint32_t
-     * @param reader Shared pointer to the top-level reader
-     * @return (Possibly nested) numpy array containing the read data
+     * Counts of sequences are kept on a stack: ops reading "many" items pop the count of
+     * items from the top. Nodes that cannot be lowered are read by fallback readers.
      */
-    py::object py_read_data( py::array_t<uint8_t> data, py::array_t<uint32_t> offsets,
-                             uint32_t cursor_offset, SharedReader reader ) {
-        BinaryStream stream( data, offsets, cursor_offset );
-        for ( auto i_evt = 0; i_evt < stream.entries(); i_evt++ )
-        {
-            auto start_pos = stream.get_cursor();
-            reader->read( stream );
-            auto end_pos = stream.get_cursor();
+    class PlanReader : public IReader {
+      public:
+        enum OpCode : uint8_t {
+            kPrimitive,       ///< read a value of `arg` bytes into column `a`
+            kPrimitiveArray,  ///< pop a count, read as many values of `arg` bytes into `a`
+            kSkip,            ///< skip `arg` bytes
+            kSkipArray,       ///< pop a count, skip as many items of `arg` bytes
+            kCount,           ///< read a uint32 count, append it to offsets `a`, push it
+            kDup,             ///< push a copy of the top count
+            kPop,             ///< pop a count
+            kLoop,            ///< pop and jump to `a` if the top count is 0, else decrement it
+            kJump,            ///< jump to `a`
+            kZero,            ///< pop and jump to `a` if the top count is 0
+            kObjHeader,       ///< read a `fNBytes+fVersion` header
+            kSeqHeader,       ///< STL sequence header, jump to `a` if member-wise, see below
+            kString,          ///< read a length-prefixed string into offsets `a`, column `b`
+            kClassBegin,      ///< read a class header, remember where the object ends
+            kClassEnd,        ///< check that the object ends there, `c` names the class
+            kCall,            ///< call `read()` of fallback reader `a`
+            kCallMany,        ///< pop a count, call `read_many()` of fallback reader `a`
+            kCallMemberwise,  ///< pop a count, call `read_many_memberwise()` of reader `a`
+            kFail,            ///< throw the message `c`
+            kNOpCodes
+        };
+
+        /// Flags of @ref kSeqHeader in `arg`
+        enum SeqFlags : int32_t {
+            kWithHeader     = 1 << 0, ///< the header is read before `read_many()`
+            kMany           = 1 << 1, ///< the ops read `read_many()` of the sequence
+            kObjwiseOnly    = 1 << 2, ///< member-wise data is an error
+            kMemberwiseOnly = 1 << 3, ///< object-wise data is an error
+        };
+
+        struct Op {
+            OpCode code;
+            int32_t arg;
+            uint32_t a, b, c;
+        };
 
-            if ( end_pos - start_pos !=
-                 stream.get_offsets()[i_evt + 1] - stream.get_offsets()[i_evt] )
+      private:
+        vector<Op> m_ops;                            ///< the program
+        vector<string> m_dtypes;                     ///< numpy dtype of each column
+        vector<SharedVector<uint8_t>> m_columns;     ///< native-endian data of each column
+        vector<shared_ptr<OffsetsVector>> m_offsets; ///< offsets of each sequence
+        vector<SharedReader> m_readers;              ///< fallback readers
+        vector<string> m_strings;                    ///< names and messages of the program
+        vector<uint32_t> m_counts;                   ///< stack of counts
+
+        /// stack of the start and end of the classes being read
+        vector<pair<const uint8_t*, const uint8_t*>> m_objects;
+
+        void append_values( const uint32_t column, const int32_t size, const uint8_t* src,
+                            const size_t count ) {
+            auto& data     = *m_columns[column];
+            auto old_bytes = data.size();
+            data.resize( old_bytes + count * size );
+            auto dst = data.data() + old_bytes;
+            switch ( size )
             {
-                stringstream msg;
-                msg << "py_read_data: Invalid read length for " << reader->name()
-                    << " at event " << i_evt << "! Expect "
-                    << stream.get_offsets()[i_evt + 1] - stream.get_offsets()[i_evt]
-                    << ", got " << end_pos - start_pos;
-                throw std::runtime_error( msg.str() );
+            case 1: bswap_copy<1>( dst, src, count ); break;
+            case 2: bswap_copy<2>( dst, src, count ); break;
+            case 4: bswap_copy<4>( dst, src, count ); break;
+            case 8: bswap_copy<8>( dst, src, count ); break;
             }
         }
-        return reader->data();
+
+        [[noreturn]] void fail_stack( const char* what ) const {
+            throw std::runtime_error( "PlanReader(" + name() + "): " + what + " is empty!" );
+        }
+
+        uint32_t& top_count() {
+            if ( m_counts.empty() ) fail_stack( "count stack" );
+            return m_counts.back();
+        }
+
+        uint32_t pop_count() {
+            auto count = top_count();
+            m_counts.pop_back();
+            return count;
+        }
+
+        void reset_outputs() {
+            for ( auto& column : m_columns ) column = std::make_shared<ArenaVector<uint8_t>>();
+            for ( auto& offsets : m_offsets ) offsets->clear();
+        }
+
+        void check_program() const {
+            auto fail = [&]( size_t ip, const char* what ) {
+                stringstream msg;
+                msg << "PlanReader(" << name() << "): op " << ip << " has " << what << "!";
+                throw std::runtime_error( msg.str() );
+            };
+
+            for ( size_t ip = 0; ip < m_ops.size(); ip++ )
+            {
+                const auto& op = m_ops[ip];
+                switch ( op.code )
+                {
+                case kPrimitive:
+                case kPrimitiveArray:
+                    if ( op.a >= m_columns.size() ) fail( ip, "an invalid column" );
+                    if ( op.arg != 1 && op.arg != 2 && op.arg != 4 && op.arg != 8 )
+                        fail( ip, "an unsupported value size" );
+                    break;
+                case kCount:
+                    if ( op.a >= m_offsets.size() ) fail( ip, "invalid offsets" );
+                    break;
+                case kString:
+                    if ( op.a >= m_offsets.size() || op.b >= m_columns.size() )
+                        fail( ip, "invalid offsets or column" );
+                    break;
+                case kLoop:
+                case kJump:
+                case kZero:
+                case kSeqHeader:
+                    if ( op.a > m_ops.size() ) fail( ip, "an invalid jump target" );
+                    break;
+                case kCall:
+                case kCallMany:
+                case kCallMemberwise:
+                    if ( op.a >= m_readers.size() ) fail( ip, "an invalid reader" );
+                    break;
+                case kClassEnd:
+                case kFail:
+                    if ( op.c >= m_strings.size() ) fail( ip, "an invalid string" );
+                    break;
+                case kNOpCodes: fail( ip, "an invalid opcode" );
+                default: break;
+                }
+                if ( op.code == kSeqHeader && op.c >= m_strings.size() )
+                    fail( ip, "an invalid string" );
+            }
+        }
+
+      public:
+        /**
+         * @brief Construct a new PlanReader object.
+         *
+         * @param name Name of the reader.
+         * @param ops The program, as `(code, arg, a, b, c)` tuples, see @ref OpCode.
+         * @param dtypes numpy dtype of each column.
+         * @param n_offsets Number of offsets arrays.
+         * @param readers Fallback readers.
+         * @param strings Names and messages referenced by the program.
+         */
+        PlanReader( string name, vector<std::array<int64_t, 5>> ops, vector<string> dtypes,
+                    uint32_t n_offsets, vector<SharedReader> readers, vector<string> strings )
+            : IReader( name )
+            , m_dtypes( dtypes )
+            , m_columns( dtypes.size() )
+            , m_offsets( n_offsets )
+            , m_readers( readers )
+            , m_strings( strings ) {
+            for ( auto& [code, arg, a, b, c] : ops )
+            {
+                if ( code < 0 || code >= kNOpCodes )
+                    throw std::runtime_error( "PlanReader(" + name + "): invalid opcode!" );
+                m_ops.push_back( { static_cast<OpCode>( code ), static_cast<int32_t>( arg ),
+                                   static_cast<uint32_t>( a ), static_cast<uint32_t>( b ),
+                                   static_cast<uint32_t>( c ) } );
+            }
+            check_program();
+            for ( auto& offsets : m_offsets ) offsets = std::make_shared<OffsetsVector>();
+            reset_outputs();
+        }
+
+        /**
+         * @brief Run the program on one object.
+         *
+         * @param stream The binary stream to read from.
+         */
+        void read( BinaryStream& stream ) override {
+            ProfileScope profile( stream, this, ReadProfiler::kRead, 1 );
+            m_counts.clear();
+            m_objects.clear();
+
+            const Op* ops  = m_ops.data();
+            const size_t n = m_ops.size();
+            for ( size_t ip = 0; ip < n; )
+            {
+                const Op& op = ops[ip++];
+                switch ( op.code )
+                {
+                case kPrimitive:
+                    append_values( op.a, op.arg, stream.read_bytes( op.arg ), 1 );
+                    break;
+                case kPrimitiveArray:
+                {
+                    auto count = pop_count();
+                    append_values( op.a, op.arg, stream.read_bytes( size_t( count ) * op.arg ),
+                                   count );
+                    break;
+                }
+                case kSkip: stream.skip( op.arg ); break;
+                case kSkipArray: stream.skip( size_t( pop_count() ) * op.arg ); break;
+                case kCount:
+                {
+                    auto count    = stream.read<uint32_t>();
+                    auto& offsets = *m_offsets[op.a];
+                    offsets.push_back( offsets.back() + count );
+                    m_counts.push_back( count );
+                    break;
+                }
+                case kDup: m_counts.push_back( top_count() ); break;
+                case kPop: pop_count(); break;
+                case kLoop:
+                    if ( top_count() == 0 )
+                    {
+                        m_counts.pop_back();
+                        ip = op.a;
+                    }
+                    else m_counts.back()--;
+                    break;
+                case kJump: ip = op.a; break;
+                case kZero:
+                    if ( top_count() == 0 )
+                    {
+                        m_counts.pop_back();
+                        ip = op.a;
+                    }
+                    break;
+                case kObjHeader:
+                    stream.skip_fNBytes();
+                    stream.skip_fVersion();
+                    break;
+                case kSeqHeader:
+                {
+                    // same as the headers of STLSeqReader::read() and ::read_many()
+                    bool is_memberwise = op.arg & kMemberwiseOnly;
+                    if ( !( op.arg & kMany ) || ( op.arg & kWithHeader ) )
+                    {
+                        stream.skip_fNBytes();
+                        is_memberwise = stream.read_fVersion() & kStreamedMemberWise;
+                        if ( ( op.arg & kObjwiseOnly ) && is_memberwise )
+                            throw std::runtime_error( "STLSeqReader(" + m_strings[op.c] +
+                                                      "): Expect obj-wise, got member-wise!" );
+                        if ( ( op.arg & kMemberwiseOnly ) && !is_memberwise )
+                            throw std::runtime_error( "STLSeqReader(" + m_strings[op.c] +
+                                                      "): Expect member-wise, got obj-wise!" );
+                    }
+                    if ( is_memberwise )
+                    {
+                        if ( stream.read_fVersion() == 0 ) stream.skip( 4 ); // checksum
+                        ip = op.a;
+                    }
+                    break;
+                }
+                case kString:
+                {
+                    auto [payload, size] = stream.read_TString_view();
+                    auto& offsets        = *m_offsets[op.a];
+                    offsets.push_back( offsets.back() + size );
+                    m_columns[op.b]->insert( m_columns[op.b]->end(), payload, payload + size );
+                    break;
+                }
+                case kClassBegin:
+                {
+                    auto fNBytes = stream.read_fNBytes();
+                    auto start   = stream.get_cursor();
+                    m_objects.emplace_back( start, start + fNBytes );
+                    if ( stream.read_fVersion() == 0 ) stream.skip( 4 ); // checksum
+                    break;
+                }
+                case kClassEnd:
+                {
+                    if ( m_objects.empty() ) fail_stack( "object stack" );
+                    auto [start, end] = m_objects.back();
+                    m_objects.pop_back();
+                    if ( stream.get_cursor() != end )
+                    {
+                        stringstream msg;
+                        msg << "AnyClassReader: Invalid read length for " << m_strings[op.c]
+                            << "! Expect " << end - start << ", got "
+                            << stream.get_cursor() - start;
+                        throw std::runtime_error( msg.str() );
+                    }
+                    break;
+                }
+                case kCall: m_readers[op.a]->read( stream ); break;
+                case kCallMany: m_readers[op.a]->read_many( stream, pop_count() ); break;
+                case kCallMemberwise:
+                    m_readers[op.a]->read_many_memberwise( stream, pop_count() );
+                    break;
+                case kFail: throw std::runtime_error( m_strings[op.c] );
+                default: break;
+                }
+            }
+        }
+
+        /**
+         * @brief Discard the read data.
+         */
+        void reset() override {
+            reset_outputs();
+            for ( auto& reader : m_readers ) reader->reset();
+        }
+
+        /**
+         * @brief Forward the hint to the fallback readers. They share the bytes, so each of
+         * them gets an equal part of `n_bytes`.
+         */
+        void reserve( const uint64_t n_entries, const uint64_t n_bytes ) override {
+            if ( m_readers.empty() ) return;
+            const uint64_t share = n_bytes / m_readers.size();
+            for ( auto& reader : m_readers ) reader->reserve( n_entries, share );
+        }
+
+        /**
+         * @brief Select the layout of the offsets and forward it to the sub-readers.
+         */
+        void set_offsets_format( const OffsetsFormat format ) override {
+            for ( auto& offsets : m_offsets ) offsets->set_format( format );
+            for ( auto& reader : m_readers ) reader->set_offsets_format( format );
+        }
+
+        /**
+         * @brief Get the data read by the reader.
+         *
+         * @return A tuple of (list of columns, list of offsets, list of the data of the
+         * fallback readers).
+         */
+        py::object data() const override {
+            py::list columns, offsets, readers;
+            for ( size_t i = 0; i < m_columns.size(); i++ )
+                columns.append( make_array( m_columns[i] ).attr( "view" )( m_dtypes[i] ) );
+            for ( auto& o : m_offsets ) offsets.append( make_offsets_array( o ) );
+            for ( auto& reader : m_readers ) readers.append( reader->data() );
+            return py::make_tuple( columns, offsets, readers );
+        }
+    };
+
+    /*
+    -----------------------------------------------------------------------------
+    -----------------------------------------------------------------------------
+    -----------------------------------------------------------------------------
+    */
+
+    /**
+     * @brief Clamp an entry range to the entries of a binary stream.
+     *
+     * @param stream The binary stream
+     * @param entry_start First entry to read
+     * @param entry_stop Entry to stop reading at (exclusive). If negative, reads until the
+     * last entry.
+     * @return Clamped `(entry_start, entry_stop)`
+     */
+    std::pair<uint64_t, uint64_t> clamp_entry_range( const BinaryStream& stream,
+                                                     int64_t entry_start,
+                                                     int64_t entry_stop ) {
+        const int64_t n_entries = stream.entries();
+        if ( entry_stop < 0 || entry_stop > n_entries ) entry_stop = n_entries;
+        entry_start = std::clamp<int64_t>( entry_start, 0, entry_stop );
+        return { entry_start, entry_stop };
+    }
+
+    /**
+     * @brief Get the number of payload bytes of an entry range of a binary stream.
+     *
+     * @param stream The binary stream
+     * @param entry_start First entry of the range
+     * @param entry_stop Entry to stop at (exclusive)
+     * @return Number of bytes covered by the entries
+     */
+    uint64_t stream_nbytes( const BinaryStream& stream, const uint64_t entry_start,
+                            const uint64_t entry_stop ) {
+        auto offsets = stream.get_offsets();
+        return offsets[entry_stop] - offsets[entry_start];
+    }
+
+    /**
+     * @brief Read one entry of a binary stream using the provided reader, checking that the
+     * entry is fully consumed. The cursor must be at the beginning of the entry.
+     *
+     * @param stream The binary stream to read from
+     * @param reader Shared pointer to the top-level reader
+     * @param i_evt Index of the entry
+     */
+    void read_entry( BinaryStream& stream, SharedReader reader, const uint64_t i_evt ) {
+        stream.set_current_entry( i_evt );
+        auto start_pos = stream.get_cursor();
+        reader->read( stream );
+        auto end_pos = stream.get_cursor();
+
+        if ( end_pos - start_pos !=
+             stream.get_offsets()[i_evt + 1] - stream.get_offsets()[i_evt] )
+        {
+            stringstream msg;
+            msg << "py_read_data: Invalid read length for " << reader->name() << " at event "
+                << i_evt << "! Expect "
+                << stream.get_offsets()[i_evt + 1] - stream.get_offsets()[i_evt] << ", got "
+                << end_pos - start_pos;
+            throw std::runtime_error( msg.str() );
+        }
+    }
+
+    /**
+     * @brief Read all entries of a binary stream using the provided reader, checking that
+     * each entry is fully consumed. Touches no Python objects, so it can run without holding
+     * the GIL.
+     *
+     * @param stream The binary stream to read from
+     * @param reader Shared pointer to the top-level reader
+     * @param entry_start First entry to read. Entries before it are skipped without parsing,
+     * so the references of their objects are not registered and readers of pointers, e.g.
+     * @ref AnyPointerReader, must start at entry 0.
+     * @param entry_stop Entry to stop reading at (exclusive)
+     */
+    void read_entries( BinaryStream& stream, SharedReader reader, const uint64_t entry_start,
+                       const uint64_t entry_stop ) {
+        stream.skip( stream.get_offsets()[entry_start] - stream.get_offsets()[0] );
+        for ( auto i_evt = entry_start; i_evt < entry_stop; i_evt++ )
+            read_entry( stream, reader, i_evt );
+    }
+
+    /**
+     * @brief Read an entry range of a binary stream and collect the data. The GIL is
+     * released while parsing, and only re-acquired to build the output in @ref
+     * IReader::data().
+     *
+     * @param stream The binary stream to read from
+     * @param reader Shared pointer to the top-level reader
+     * @param entry_start First entry to read
+     * @param entry_stop Entry to stop reading at (exclusive). If negative, reads until the
+     * last entry.
+     * @param profile Whether to record the reader calls, see @ref ReadProfiler.
+     * @return The data read, or a tuple of the data and the profiling report
+     */
+    py::object read_stream( BinaryStream& stream, SharedReader reader, int64_t entry_start,
+                            int64_t entry_stop, bool profile ) {
+        auto [start, stop] = clamp_entry_range( stream, entry_start, entry_stop );
+
+        ReadProfiler profiler;
+        if ( profile ) stream.set_profiler( &profiler );
+
+        {
+            py::gil_scoped_release release;
+            ArenaScope arena;
+            reader->reserve( stop - start, stream_nbytes( stream, start, stop ) );
+            read_entries( stream, reader, start, stop );
+        }
+
+        if ( profile ) return py::make_tuple( reader->data(), profiler.report() );
+        return reader->data();
+    }
+
+    /**
+     * @brief Read data from a binary stream using the provided reader. The GIL is released
+     * while parsing, and only re-acquired to build the output in @ref IReader::data().
+     *
+     * @param data Binary data as a numpy array of uint8_t
+     * @param offsets Offsets for each entry as a numpy array of uint32_t
+     * @param reader Shared pointer to the top-level reader
+     * @param entry_start First entry to read
+     * @param entry_stop Entry to stop reading at (exclusive). If negative, reads until the
+     * last entry.
+     * @param profile Whether to record the reader calls, see @ref ReadProfiler.
+     * @return (Possibly nested) numpy array containing the read data. If `profile` is true, a
+     * tuple of the data and the report of @ref ReadProfiler::report().
+     */
+    py::object py_read_data( py::array_t<uint8_t> data, py::array_t<uint32_t> offsets,
+                             uint32_t cursor_offset, SharedReader reader, int64_t entry_start,
+                             int64_t entry_stop, bool profile ) {
+        BinaryStream stream( data, offsets, cursor_offset );
+        return read_stream( stream, reader, entry_start, entry_stop, profile );
+    }
+
+    /**
+     * @brief Get the pointer to a contiguous 1-d buffer of `T` without copying it.
+     *
+     * @param info The buffer, e.g. requested from a `bytes`, `memoryview` or `mmap` object
+     * @param what Name of the buffer for the error message
+     * @return Pointer to the first item
+     */
+    template <typename T>
+    const T* buffer_ptr( const py::buffer_info& info, const char* what ) {
+        if ( info.itemsize != sizeof( T ) || info.ndim != 1 ||
+             ( info.size > 1 && info.strides[0] != sizeof( T ) ) )
+        {
+            stringstream msg;
+            msg << "read_data: " << what << " must be a contiguous 1-d buffer of "
+                << sizeof( T ) << "-byte items!";
+            throw std::runtime_error( msg.str() );
+        }
+        return static_cast<const T*>( info.ptr );
+    }
+
+    /**
+     * @brief Same as @ref py_read_data(), but accepts any object supporting the buffer
+     * protocol (e.g. `bytes`, `memoryview`, `mmap.mmap`) without copying it into a numpy
+     * array first.
+     */
+    py::object py_read_data_buffer( py::buffer data, py::buffer offsets,
+                                    uint32_t cursor_offset, SharedReader reader,
+                                    int64_t entry_start, int64_t entry_stop, bool profile ) {
+        auto data_info    = data.request();
+        auto offsets_info = offsets.request();
+        if ( offsets_info.size < 1 )
+            throw std::runtime_error( "read_data: offsets must not be empty!" );
+
+        BinaryStream stream( buffer_ptr<uint8_t>( data_info, "data" ),
+                             buffer_ptr<uint32_t>( offsets_info, "offsets" ),
+                             offsets_info.size - 1, cursor_offset, data_info.size );
+        return read_stream( stream, reader, entry_start, entry_stop, profile );
+    }
+
+    /**
+     * @brief Decode a basket fed as successive windows, e.g. chunks of a memory-mapped file
+     * or a network buffer, without assembling the whole basket first. Entries fully
+     * contained in a window are decoded in place; only an entry straddling two windows is
+     * copied, so the extra memory is bounded by the largest entry. The reader and the
+     * stream, including the registered references, keep their state between windows.
+     */
+    class ChunkedDecoder {
+      private:
+        SharedReader m_reader;        ///< the top-level reader
+        vector<uint32_t> m_offsets;   ///< entry offsets of the whole basket
+        BinaryStream m_stream;        ///< stream over the current window
+        uint64_t m_n_fed{ 0 };        ///< number of bytes fed so far
+        uint64_t m_next_entry{ 0 };   ///< index of the next entry to decode
+        vector<uint8_t> m_straddling; ///< bytes received of the entry straddling windows
+        BufferArena* m_arena{ BufferArena::create() }; ///< arena of the output buffers
+
+      public:
+        /**
+         * @brief Construct a new ChunkedDecoder object.
+         *
+         * @param reader Shared pointer to the top-level reader
+         * @param offsets Offsets for each entry of the whole basket
+         * @param cursor_offset Initial cursor position, used for calculating relative
+         * offsets
+         */
+        ChunkedDecoder( SharedReader reader, py::array_t<uint32_t> offsets,
+                        uint32_t cursor_offset )
+            : m_reader( reader )
+            , m_offsets( offsets.data(), offsets.data() + offsets.size() )
+            , m_stream( nullptr, m_offsets.data(), m_offsets.size() - 1, cursor_offset,
+                        0 ) {
+            if ( m_offsets.empty() )
+            {
+                m_arena->release();
+                throw std::runtime_error( "ChunkedDecoder: offsets must not be empty!" );
+            }
+
+            ArenaScope arena( m_arena );
+            m_reader->reserve( m_stream.entries(), m_offsets.back() - m_offsets.front() );
+        }
+
+        ~ChunkedDecoder() { m_arena->release(); }
+
+        ChunkedDecoder( const ChunkedDecoder& )            = delete;
+        ChunkedDecoder& operator=( const ChunkedDecoder& ) = delete;
+
+        /**
+         * @brief Decode the entries completed by the next window of the basket.
+         *
+         * @param window Pointer to the window, which only needs to be valid during the call
+         * @param n_bytes Size of the window
+         * @return Number of entries decoded so far
+         */
+        uint64_t feed( const uint8_t* window, const uint64_t n_bytes ) {
+            ArenaScope arena( m_arena );
+            const uint64_t n_entries = m_stream.entries();
+            const uint64_t begin     = m_n_fed;
+            m_n_fed += n_bytes;
+
+            // complete the entry straddling the previous window
+            if ( !m_straddling.empty() )
+            {
+                const uint64_t entry_end = m_offsets[m_next_entry + 1];
+                const uint64_t n_take    = std::min( entry_end, m_n_fed ) - begin;
+                m_straddling.insert( m_straddling.end(), window, window + n_take );
+                if ( begin + n_take < entry_end ) return m_next_entry;
+
+                m_stream.set_window( m_straddling.data(), m_offsets[m_next_entry],
+                                     m_straddling.size() );
+                read_entry( m_stream, m_reader, m_next_entry++ );
+                m_straddling.clear();
+            }
+
+            // the next entry starts in this window, decode complete entries in place
+            if ( m_next_entry >= n_entries || m_offsets[m_next_entry] > m_n_fed )
+                return m_next_entry;
+
+            const uint32_t entry_begin = m_offsets[m_next_entry];
+            m_stream.set_window( window + ( entry_begin - begin ), entry_begin,
+                                 begin + n_bytes - entry_begin );
+            while ( m_next_entry < n_entries && m_offsets[m_next_entry + 1] <= m_n_fed )
+                read_entry( m_stream, m_reader, m_next_entry++ );
+
+            // keep the head of the next entry
+            if ( m_next_entry < n_entries )
+                m_straddling.assign( window + ( m_offsets[m_next_entry] - begin ),
+                                     window + n_bytes );
+            return m_next_entry;
+        }
+
+        /**
+         * @brief Python binding of @ref feed(). Accepts any object supporting the buffer
+         * protocol without copying it, and releases the GIL while decoding.
+         */
+        uint64_t py_feed( py::buffer window ) {
+            auto info = window.request();
+            auto ptr  = buffer_ptr<uint8_t>( info, "window" );
+            py::gil_scoped_release release;
+            return feed( ptr, info.size );
+        }
+
+        /**
+         * @brief Get the data once the whole basket has been fed.
+         *
+         * @return The data read by the top-level reader
+         */
+        py::object finish() {
+            if ( m_next_entry != m_stream.entries() )
+            {
+                stringstream msg;
+                msg << "ChunkedDecoder: only " << m_next_entry << " of " << m_stream.entries()
+                    << " entries are complete after " << m_n_fed << " bytes!";
+                throw std::runtime_error( msg.str() );
+            }
+            return m_reader->data();
+        }
+    };
+
+    /**
+     * @brief Read multiple baskets in order with a single reader, so that all of them are
+     * appended to the same output buffers. The offsets of the reader keep growing across
+     * baskets, thus the result is the same as concatenating the data of each basket, without
+     * any copy. The GIL is released while parsing.
+     *
+     * @param baskets List of `(data, offsets, cursor_offset, entry_start, entry_stop)` tuples,
+     * one per basket. The entry range is local to the basket, a negative `entry_stop` means
+     * reading until the last entry.
+     * @param reader Shared pointer to the top-level reader
+     * @return (Possibly nested) numpy array containing the read data of all baskets
+     */
+    py::object py_read_data_concat(
+        vector<std::tuple<py::array_t<uint8_t>, py::array_t<uint32_t>, uint32_t, int64_t,
+                          int64_t>>
+            baskets,
+        SharedReader reader ) {
+        vector<BinaryStream> streams;
+        vector<std::pair<uint64_t, uint64_t>> ranges;
+        streams.reserve( baskets.size() );
+        ranges.reserve( baskets.size() );
+        for ( auto& [data, offsets, cursor_offset, entry_start, entry_stop] : baskets )
+        {
+            auto& stream = streams.emplace_back( data, offsets, cursor_offset );
+            ranges.push_back( clamp_entry_range( stream, entry_start, entry_stop ) );
+        }
+
+        {
+            py::gil_scoped_release release;
+            ArenaScope arena;
+
+            // reserve once for all baskets, growing per basket would copy quadratically
+            uint64_t n_entries = 0, n_bytes = 0;
+            for ( size_t i = 0; i < streams.size(); i++ )
+            {
+                auto [start, stop] = ranges[i];
+                n_entries += stop - start;
+                n_bytes += stream_nbytes( streams[i], start, stop );
+            }
+            reader->reserve( n_entries, n_bytes );
+
+            for ( size_t i = 0; i < streams.size(); i++ )
+                read_entries( streams[i], reader, ranges[i].first, ranges[i].second );
+        }
+        return reader->data();
+    }
+
+    /**
+     * @brief Read one member of the objects indexed by @ref MemberSpanReader, in multiple
+     * baskets, into the same output buffers. For each entry, the stream is moved to the start
+     * of the member, which is read once and must end where the next member starts. The
+     * member reader gets the same stream as inside its class, so positions and the end of
+     * the entry are unchanged. The GIL is released while parsing.
+     *
+     * @param baskets List of `(data, offsets, cursor_offset, starts, stops, entry_start,
+     * entry_stop)` tuples, one per basket. `starts` and `stops` hold the span of the member
+     * in each entry of the basket. The entry range is local to the basket, a negative
+     * `entry_stop` means reading until the last entry.
+     * @param reader Shared pointer to the reader of the member
+     * @return (Possibly nested) numpy array containing the read data of all baskets
+     */
+    py::object py_read_data_spans(
+        vector<std::tuple<py::array_t<uint8_t>, py::array_t<uint32_t>, uint32_t,
+                          py::array_t<uint32_t>, py::array_t<uint32_t>, int64_t, int64_t>>
+            baskets,
+        SharedReader reader ) {
+        vector<BinaryStream> streams;
+        vector<std::pair<uint64_t, uint64_t>> ranges;
+        streams.reserve( baskets.size() );
+        for ( auto& [data, offsets, cursor_offset, starts, stops, entry_start, entry_stop] :
+              baskets )
+        {
+            auto& stream = streams.emplace_back( data, offsets, cursor_offset );
+            if ( starts.size() != (ssize_t)stream.entries() ||
+                 stops.size() != (ssize_t)stream.entries() )
+                throw std::runtime_error( "read_data_spans: starts and stops of " +
+                                          reader->name() + " must have one span per entry!" );
+            ranges.push_back( clamp_entry_range( stream, entry_start, entry_stop ) );
+        }
+
+        {
+            py::gil_scoped_release release;
+            ArenaScope arena;
+
+            uint64_t n_entries = 0;
+            for ( auto [start, stop] : ranges ) n_entries += stop - start;
+            reader->reserve( n_entries, 0 );
+
+            for ( size_t i = 0; i < streams.size(); i++ )
+            {
+                auto& stream = streams[i];
+                auto data    = stream.get_data();
+                auto n_bytes = stream.get_end() - data;
+                auto starts  = std::get<3>( baskets[i] ).data();
+                auto stops   = std::get<4>( baskets[i] ).data();
+                for ( auto i_evt = ranges[i].first; i_evt < ranges[i].second; i_evt++ )
+                {
+                    stream.set_current_entry( i_evt );
+                    auto start = std::min<ptrdiff_t>( starts[i_evt], n_bytes );
+                    stream.set_window( data + start, starts[i_evt], n_bytes - start );
+                    reader->read( stream );
+                    if ( stream.get_index() != stops[i_evt] )
+                    {
+                        stringstream msg;
+                        msg << "read_data_spans: Invalid read length for " << reader->name()
+                            << " at event " << i_evt << "! Expect "
+                            << stops[i_evt] - starts[i_evt] << ", got "
+                            << stream.get_index() - starts[i_evt];
+                        throw std::runtime_error( msg.str() );
+                    }
+                }
+            }
+        }
+        return reader->data();
+    }
+
+    /**
+     * @brief Read multiple baskets in parallel. Each worker thread creates one reader tree by
+     * calling `reader_factory`, and reuses it for all baskets it decodes by calling @ref
+     * IReader::reset() in between. Parsing runs without the GIL; it is only acquired to
+     * create readers and to collect @ref IReader::data() of each basket. The first error
+     * stops the workers and is rethrown.
+     *
+     * @param baskets List of `(data, offsets, cursor_offset)` tuples, one per basket
+     * @param reader_factory Callable returning a new top-level reader
+     * @param n_threads Number of worker threads. If not positive, uses the number of
+     * hardware threads.
+     * @return List of the data read from each basket, in the order of `baskets`
+     */
+    py::list py_read_data_many(
+        vector<std::tuple<py::array_t<uint8_t>, py::array_t<uint32_t>, uint32_t>> baskets,
+        py::function reader_factory, int n_threads ) {
+        const size_t n_baskets = baskets.size();
+
+        vector<BinaryStream> streams;
+        streams.reserve( n_baskets );
+        for ( auto& [data, offsets, cursor_offset] : baskets )
+            streams.emplace_back( data, offsets, cursor_offset );
+
+        if ( n_threads <= 0 ) n_threads = std::max( 1u, std::thread::hardware_concurrency() );
+        n_threads = std::min<size_t>( n_threads, n_baskets );
+
+        vector<py::object> results( n_baskets );
+        std::exception_ptr error;
+        {
+            py::gil_scoped_release release;
+
+            std::atomic<size_t> next_basket{ 0 };
+            std::atomic<bool> failed{ false };
+            std::mutex error_mutex;
+            auto worker = [&]() {
+                SharedReader reader;
+                for ( size_t i = next_basket++; !failed && i < n_baskets; i = next_basket++ )
+                {
+                    try
+                    {
+                        if ( !reader )
+                        {
+                            py::gil_scoped_acquire acquire;
+                            reader = reader_factory().cast<SharedReader>();
+                        }
+
+                        ArenaScope arena;
+                        auto n_entries = streams[i].entries();
+                        auto n_bytes   = stream_nbytes( streams[i], 0, n_entries );
+                        reader->reserve( n_entries, n_bytes );
+                        read_entries( streams[i], reader, 0, n_entries );
+
+                        {
+                            py::gil_scoped_acquire acquire;
+                            results[i] = reader->data();
+                        }
+
+                        // readers without reset() support are rebuilt for the next basket
+                        try
+                        {
+                            reader->reset();
+                        } catch ( const std::runtime_error& ) { reader = nullptr; }
+                    } catch ( ... )
+                    {
+                        std::lock_guard<std::mutex> lock( error_mutex );
+                        if ( !error ) error = std::current_exception();
+                        failed = true;
+                    }
+                }
+            };
+
+            vector<std::thread> pool;
+            for ( int i = 1; i < n_threads; i++ ) pool.emplace_back( worker );
+            worker();
+            for ( auto& thread : pool ) thread.join();
+        }
+        if ( error ) std::rethrow_exception( error );
+
+        py::list res;
+        for ( auto& result : results ) res.append( result );
+        return res;
+    }
+
+    /**
+     * @brief Read multiple baskets, possibly of different branches, in parallel. Each job
+     * brings its own reader, so no Python call is made until all jobs are done. Jobs are
+     * dealt to per-thread queues from the largest to the smallest; a thread whose queue is
+     * empty steals from the tail of the others, so that a few large baskets do not leave
+     * the other threads idle. The GIL is released while parsing.
+     *
+     * @param jobs List of `(data, offsets, cursor_offset, reader)` tuples. The readers must
+     * be distinct.
+     * @param n_threads Number of worker threads. If not positive, uses the number of
+     * hardware threads.
+     * @return List of the data read by each job, in the order of `jobs`
+     */
+    py::list py_read_data_batch(
+        vector<std::tuple<py::array_t<uint8_t>, py::array_t<uint32_t>, uint32_t,
+                          SharedReader>>
+            jobs,
+        int n_threads ) {
+        const size_t n_jobs = jobs.size();
+
+        vector<BinaryStream> streams;
+        vector<SharedReader> readers;
+        vector<uint64_t> n_bytes;
+        streams.reserve( n_jobs );
+        for ( auto& [data, offsets, cursor_offset, reader] : jobs )
+        {
+            if ( std::find( readers.begin(), readers.end(), reader ) != readers.end() )
+                throw std::runtime_error( "read_data_batch: reader " + reader->name() +
+                                          " is used by more than one job!" );
+
+            auto& stream = streams.emplace_back( data, offsets, cursor_offset );
+            readers.push_back( reader );
+            n_bytes.push_back( stream_nbytes( stream, 0, stream.entries() ) );
+        }
+
+        if ( n_threads <= 0 ) n_threads = std::max( 1u, std::thread::hardware_concurrency() );
+        n_threads = std::max<size_t>( 1, std::min<size_t>( n_threads, n_jobs ) );
+
+        // deal the jobs round-robin, largest first
+        vector<size_t> order( n_jobs );
+        for ( size_t i = 0; i < n_jobs; i++ ) order[i] = i;
+        std::stable_sort( order.begin(), order.end(),
+                          [&]( size_t a, size_t b ) { return n_bytes[a] > n_bytes[b]; } );
+
+        struct JobQueue {
+            std::mutex mutex;
+            std::deque<size_t> jobs;
+        };
+        vector<JobQueue> queues( n_threads );
+        for ( size_t i = 0; i < n_jobs; i++ )
+            queues[i % n_threads].jobs.push_back( order[i] );
+
+        std::exception_ptr error;
+        {
+            py::gil_scoped_release release;
+
+            std::atomic<bool> failed{ false };
+            std::mutex error_mutex;
+
+            // own queue from the head, other queues from the tail
+            auto next_job = [&]( size_t thread_id, size_t& job ) {
+                for ( size_t k = 0; k < queues.size(); k++ )
+                {
+                    auto& queue = queues[( thread_id + k ) % queues.size()];
+                    std::lock_guard<std::mutex> lock( queue.mutex );
+                    if ( queue.jobs.empty() ) continue;
+                    if ( k == 0 )
+                    {
+                        job = queue.jobs.front();
+                        queue.jobs.pop_front();
+                    }
+                    else
+                    {
+                        job = queue.jobs.back();
+                        queue.jobs.pop_back();
+                    }
+                    return true;
+                }
+                return false;
+            };
+
+            auto worker = [&]( size_t thread_id ) {
+                size_t i = 0;
+                while ( !failed && next_job( thread_id, i ) )
+                {
+                    try
+                    {
+                        ArenaScope arena;
+                        auto n_entries = streams[i].entries();
+                        readers[i]->reserve( n_entries, n_bytes[i] );
+                        read_entries( streams[i], readers[i], 0, n_entries );
+                    } catch ( ... )
+                    {
+                        std::lock_guard<std::mutex> lock( error_mutex );
+                        if ( !error ) error = std::current_exception();
+                        failed = true;
+                    }
+                }
+            };
+
+            vector<std::thread> pool;
+            for ( int i = 1; i < n_threads; i++ ) pool.emplace_back( worker, i );
+            worker( 0 );
+            for ( auto& thread : pool ) thread.join();
+        }
+        if ( error ) std::rethrow_exception( error );
+
+        py::list res;
+        for ( auto& reader : readers ) res.append( reader->data() );
+        return res;
+    }
+
+    /**
+     * @brief Read an entry range of one basket in parallel. The range is split into one
+     * chunk of consecutive entries per reader, of about the same number of bytes since
+     * `offsets` gives where each entry starts, and each chunk is decoded by its own reader
+     * on its own thread. The GIL is released while parsing.
+     *
+     * Readers resolving references between entries, e.g. @ref AnyPointerReader through
+     * @ref BinaryStream::find_ref() and @ref BinaryStream::set_ref(), must not be used,
+     * since each chunk has its own stream.
+     *
+     * @param data The binary data
+     * @param offsets The offsets of each entry
+     * @param cursor_offset The cursor offset of the basket
+     * @param readers One top-level reader per chunk. The readers must be distinct.
+     * @param entry_start First entry to read
+     * @param entry_stop Entry to stop reading at (exclusive). If negative, reads until the
+     * last entry.
+     * @return List of the data read by each reader, in the order of the entries
+     */
+    py::list py_read_data_chunked( py::array_t<uint8_t> data, py::array_t<uint32_t> offsets,
+                                   uint32_t cursor_offset, vector<SharedReader> readers,
+                                   int64_t entry_start, int64_t entry_stop ) {
+        if ( readers.empty() )
+            throw std::runtime_error( "read_data_chunked: at least one reader is needed!" );
+        for ( size_t i = 0; i < readers.size(); i++ )
+            if ( std::find( readers.begin(), readers.begin() + i, readers[i] ) !=
+                 readers.begin() + i )
+                throw std::runtime_error( "read_data_chunked: reader " + readers[i]->name() +
+                                          " is used by more than one chunk!" );
+
+        const size_t n_chunks = readers.size();
+        vector<BinaryStream> streams;
+        streams.reserve( n_chunks );
+        for ( size_t i = 0; i < n_chunks; i++ )
+            streams.emplace_back( data, offsets, cursor_offset );
+
+        // chunk i reads the entries [bounds[i], bounds[i+1]), at least one if there are
+        // enough entries, so that a large entry does not leave a chunk empty
+        auto [start, stop] = clamp_entry_range( streams[0], entry_start, entry_stop );
+        auto entry_offsets = streams[0].get_offsets();
+        vector<uint64_t> bounds( n_chunks + 1, stop );
+        bounds[0] = start;
+        for ( size_t i = 1; i < n_chunks; i++ )
+        {
+            uint64_t n_bytes = entry_offsets[stop] - entry_offsets[start];
+            uint64_t target  = entry_offsets[start] + n_bytes * i / n_chunks;
+            int64_t bound = std::lower_bound( entry_offsets + bounds[i - 1],
+                                              entry_offsets + stop, target ) -
+                            entry_offsets;
+            bound = std::min<int64_t>( bound, int64_t( stop ) - int64_t( n_chunks - i ) );
+            bound = std::max<int64_t>( bound, bounds[i - 1] + 1 );
+            bounds[i] = std::min<int64_t>( bound, stop );
+        }
+
+        std::exception_ptr error;
+        {
+            py::gil_scoped_release release;
+
+            std::mutex error_mutex;
+            auto worker = [&]( size_t i ) {
+                try
+                {
+                    ArenaScope arena;
+                    auto n_bytes = stream_nbytes( streams[i], bounds[i], bounds[i + 1] );
+                    readers[i]->reserve( bounds[i + 1] - bounds[i], n_bytes );
+                    read_entries( streams[i], readers[i], bounds[i], bounds[i + 1] );
+                } catch ( ... )
+                {
+                    std::lock_guard<std::mutex> lock( error_mutex );
+                    if ( !error ) error = std::current_exception();
+                }
+            };
+
+            vector<std::thread> pool;
+            for ( size_t i = 1; i < n_chunks; i++ ) pool.emplace_back( worker, i );
+            worker( 0 );
+            for ( auto& thread : pool ) thread.join();
+        }
+        if ( error ) std::rethrow_exception( error );
+
+        py::list res;
+        for ( auto& reader : readers ) res.append( reader->data() );
+        return res;
+    }
+
+    /// Names of @ref OffsetsFormat in Python
+    const std::array<string, 3> offsets_format_names{ "i64", "i32", "counts" };
+
+    /**
+     * @brief Select the layout of the offsets returned by a reader tree, see @ref
+     * IReader::set_offsets_format().
+     *
+     * @param reader The reader.
+     * @param format `"i64"`, `"i32"` or `"counts"`
+     */
+    void py_set_offsets_format( IReader& reader, const string& format ) {
+        auto begin = offsets_format_names.begin();
+        auto it    = std::find( begin, offsets_format_names.end(), format );
+        if ( it == offsets_format_names.end() )
+            throw std::invalid_argument( "set_offsets_format: unknown offsets format " +
+                                         format + ", expect i64, i32 or counts!" );
+        reader.set_offsets_format( static_cast<OffsetsFormat>( it - begin ) );
     }
 
     PYBIND11_MODULE( cpp, m ) {
         m.doc() = "C++ module for uproot-custom";
 
         m.def( "read_data", &py_read_data, "Read data from a binary stream", py::arg( "data" ),
-               py::arg( "offsets" ), py::arg( "cursor_offset" ), py::arg( "reader" ) );
+               py::arg( "offsets" ), py::arg( "cursor_offset" ), py::arg( "reader" ),
+               py::arg( "entry_start" ) = 0, py::arg( "entry_stop" ) = -1,
+               py::arg( "profile" ) = false );
+
+        m.def( "read_data", &py_read_data_buffer,
+               "Read data from objects supporting the buffer protocol without copying",
+               py::arg( "data" ), py::arg( "offsets" ), py::arg( "cursor_offset" ),
+               py::arg( "reader" ), py::arg( "entry_start" ) = 0, py::arg( "entry_stop" ) = -1,
+               py::arg( "profile" ) = false );
+
+        py::class_<ChunkedDecoder>( m, "ChunkedDecoder" )
+            .def( py::init<SharedReader, py::array_t<uint32_t>, uint32_t>(),
+                  py::arg( "reader" ), py::arg( "offsets" ), py::arg( "cursor_offset" ) )
+            .def( "feed", &ChunkedDecoder::py_feed, py::arg( "window" ) )
+            .def( "finish", &ChunkedDecoder::finish );
+
+        m.def( "read_data_concat", &py_read_data_concat,
+               "Read data from multiple binary streams into the same output buffers",
+               py::arg( "baskets" ), py::arg( "reader" ) );
+
+        m.def( "read_data_spans", &py_read_data_spans,
+               "Read one member of indexed objects from multiple binary streams",
+               py::arg( "baskets" ), py::arg( "reader" ) );
+
+        m.def( "read_data_many", &py_read_data_many,
+               "Read data from multiple binary streams in parallel", py::arg( "baskets" ),
+               py::arg( "reader_factory" ), py::arg( "n_threads" ) = 0 );
+
+        m.def( "read_data_batch", &py_read_data_batch,
+               "Read data from multiple binary streams, each with its own reader, in parallel",
+               py::arg( "jobs" ), py::arg( "n_threads" ) = 0 );
+
+        m.def( "read_data_chunked", &py_read_data_chunked,
+               "Read an entry range of one binary stream in parallel chunks, one per reader",
+               py::arg( "data" ), py::arg( "offsets" ), py::arg( "cursor_offset" ),
+               py::arg( "readers" ), py::arg( "entry_start" ) = 0,
+               py::arg( "entry_stop" ) = -1 );
+
+        m.def( "set_bounds_checks", &BinaryStream::set_default_checked,
+               "Enable or disable the bounds checks of the reads started afterwards by this "
+               "module",
+               py::arg( "enabled" ) );
+
+        m.def( "bounds_checks", &BinaryStream::default_checked,
+               "Whether reads are checked against the end of the data" );
 
         py::class_<IReader, SharedReader>( m, "IReader" )
-            .def( "name", &IReader::name, "Get the name of the reader" );
+            .def( "name", &IReader::name, "Get the name of the reader" )
+            .def( "reset", &IReader::reset, "Discard all accumulated data of the reader" )
+            .def( "reserve", &IReader::reserve, "Hint the amount of data to be read",
+                  py::arg( "n_entries" ), py::arg( "n_bytes" ) )
+            .def( "set_offsets_format", &py_set_offsets_format,
+                  "Select the layout of the offsets returned by the reader tree",
+                  py::arg( "format" ) );
 
         // Basic type readers
         declare_reader<PrimitiveReader<uint8_t>, string>( m, "UInt8Reader" );
@@ -1379,22 +3285,45 @@ namespace uproot_custom {
         declare_reader<STLStringReader, string, bool>( m, "STLStringReader" );
 
         // TArrayReader
-        declare_reader<TArrayReader<int8_t>, string>( m, "TArrayCReader" );
-        declare_reader<TArrayReader<int16_t>, string>( m, "TArraySReader" );
-        declare_reader<TArrayReader<int32_t>, string>( m, "TArrayIReader" );
-        declare_reader<TArrayReader<int64_t>, string>( m, "TArrayLReader" );
-        declare_reader<TArrayReader<float>, string>( m, "TArrayFReader" );
-        declare_reader<TArrayReader<double>, string>( m, "TArrayDReader" );
+        declare_tarray_reader<int8_t>( m, "TArrayCReader" );
+        declare_tarray_reader<int16_t>( m, "TArraySReader" );
+        declare_tarray_reader<int32_t>( m, "TArrayIReader" );
+        declare_tarray_reader<int64_t>( m, "TArrayLReader" );
+        declare_tarray_reader<float>( m, "TArrayFReader" );
+        declare_tarray_reader<double>( m, "TArrayDReader" );
 
         // Other readers
         declare_reader<TStringReader, string, bool>( m, "TStringReader" );
         declare_reader<TObjectReader, string, bool>( m, "TObjectReader" );
         declare_reader<GroupReader, string, vector<SharedReader>>( m, "GroupReader" );
         declare_reader<AnyClassReader, string, vector<SharedReader>>( m, "AnyClassReader" );
-        declare_reader<AnyPointerReader, string, SharedReader>( m, "AnyPointerReader" );
+        declare_reader<PODClassReader, string, vector<string>, vector<uint32_t>>(
+            m, "PODClassReader" );
+        declare_reader<MemberSpanReader, string, vector<SharedReader>>(
+            m, "MemberSpanReader" );
+        py::class_<AnyPointerReader, shared_ptr<AnyPointerReader>, IReader>(
+            m, "AnyPointerReader" )
+            .def( py::init( &CreateReader<AnyPointerReader, string, SharedReader> ) )
+            .def( py::init( &CreateReader<AnyPointerReader, string, SharedReader, bool> ) );
         declare_reader<CStyleArrayReader, string, int64_t, SharedReader>(
             m, "CStyleArrayReader" );
-        declare_reader<EmptyReader, string>( m, "EmptyReader" );
+        py::class_<EmptyReader, shared_ptr<EmptyReader>, IReader>( m, "EmptyReader" )
+            .def( py::init( &CreateReader<EmptyReader, string> ) )
+            .def( py::init( &CreateReader<EmptyReader, string, uint32_t> ) )
+            .def( py::init( &CreateReader<EmptyReader, string, SharedReader, bool> ) )
+            .def( py::init( &CreateReader<EmptyReader, string, SharedReader, bool, bool> ) );
+
+        declare_reader<PlanReader, string, vector<std::array<int64_t, 5>>, vector<string>,
+                       uint32_t, vector<SharedReader>, vector<string>>( m, "PlanReader" );
+
+        // Arrow export
+        py::class_<arrow::ArrowExport>( m, "ArrowExport" )
+            .def( py::init<py::object, py::object>(), py::arg( "raw_data" ),
+                  py::arg( "spec" ) )
+            .def( "__len__", &arrow::ArrowExport::length )
+            .def( "__arrow_c_schema__", &arrow::ArrowExport::c_schema )
+            .def( "__arrow_c_array__", &arrow::ArrowExport::c_array,
+                  py::arg( "requested_schema" ) = py::none() );
     }
 
 } // namespace uproot_custom
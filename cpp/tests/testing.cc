@@ -0,0 +1,302 @@
+/**
+ * @file testing.cc
+ * @brief Test-only module `uproot_custom._testing`, exposing internals of the headers that
+ * are not reachable through the readers. Built when `UPROOT_CUSTOM_BUILD_TESTING` is on.
+ */
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/pytypes.h>
+
+#include "uproot-custom/static-readers.hh"
+#include "uproot-custom/uproot-custom.hh"
+
+#if defined( _MSC_VER )
+#    pragma warning( disable : 4996 ) // get_refs() is deprecated
+#else
+#    pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+namespace uproot_custom {
+    namespace testing {
+        using std::string;
+
+        BinaryStream::Reference::Kind ref_kind( const string& kind ) {
+            if ( kind == "class" ) return BinaryStream::Reference::kClass;
+            if ( kind == "object" ) return BinaryStream::Reference::kObject;
+            throw std::invalid_argument( "unknown reference kind " + kind );
+        }
+
+        py::object ref_tuple( const BinaryStream::Reference& ref ) {
+            return py::make_tuple(
+                ref.kind == BinaryStream::Reference::kClass ? "class" : "object", ref.value );
+        }
+
+        /**
+         * @brief Find a reference, as `(kind, value)` or None.
+         */
+        py::object find_ref( const BinaryStream& stream, const uint32_t key ) {
+            auto ref = stream.find_ref( key );
+            return ref ? ref_tuple( *ref ) : py::none();
+        }
+
+        void set_ref( BinaryStream& stream, const uint32_t key, const string& kind,
+                      const int64_t value ) {
+            stream.set_ref( key, { ref_kind( kind ), value } );
+        }
+
+        /**
+         * @brief Read a string with @ref BinaryStream::read_TString_view(), as `(offset of
+         * the payload in the data, payload)`.
+         */
+        py::tuple read_TString_view( BinaryStream& stream ) {
+            auto [payload, length] = stream.read_TString_view();
+            auto chars             = reinterpret_cast<const char*>( payload );
+            return py::make_tuple( payload - stream.get_data(), py::bytes( chars, length ) );
+        }
+
+        /**
+         * @brief Read `n` bytes with @ref BinaryStream::read_bytes(), as `(offset of the bytes
+         * in the data, bytes)`.
+         */
+        py::tuple read_bytes( BinaryStream& stream, const size_t n ) {
+            auto start = stream.read_bytes( n );
+            auto chars = reinterpret_cast<const char*>( start );
+            return py::make_tuple( start - stream.get_data(), py::bytes( chars, n ) );
+        }
+
+        /**
+         * @brief The map of the deprecated @ref BinaryStream::get_refs(), as a dict of
+         * `(kind, name or index)`.
+         */
+        py::dict legacy_refs( BinaryStream& stream ) {
+            py::dict res;
+            for ( const auto& [key, ref] : stream.get_refs() )
+            {
+                if ( auto cls = std::get_if<BinaryStream::RefCls>( &ref ) )
+                    res[py::int_( key )] = py::make_tuple( "class", cls->name );
+                else
+                    res[py::int_( key )] = py::make_tuple(
+                        "object", std::get<BinaryStream::RefObj>( ref ).index );
+            }
+            return res;
+        }
+
+        /**
+         * @brief Register a reference through the map of the deprecated @ref
+         * BinaryStream::get_refs().
+         */
+        void legacy_set_ref( BinaryStream& stream, const uint32_t key, py::object value ) {
+            auto& refs = stream.get_refs();
+            if ( py::isinstance<py::str>( value ) )
+                refs[key] = BinaryStream::RefCls{ value.cast<string>() };
+            else refs[key] = BinaryStream::RefObj{ value.cast<int64_t>() };
+        }
+
+        /**
+         * @brief Handle on a @ref BufferArena, owning it until @ref close() is called. The
+         * stats must only be queried while the arena is owned or has live buffers.
+         */
+        class ArenaHandle {
+          public:
+            ArenaHandle()                                = default;
+            ArenaHandle( const ArenaHandle& )            = delete;
+            ArenaHandle& operator=( const ArenaHandle& ) = delete;
+            ~ArenaHandle() { close(); }
+
+            uintptr_t allocate( const size_t n_bytes ) {
+                ArenaScope scope( arena() );
+                return reinterpret_cast<uintptr_t>( BufferArena::allocate( n_bytes ) );
+            }
+
+            void deallocate( const uintptr_t ptr ) {
+                BufferArena::deallocate( reinterpret_cast<void*>( ptr ) );
+            }
+
+            /**
+             * @brief A numpy array of `size` bytes allocated from the arena.
+             */
+            py::array_t<uint8_t> array( const size_t size ) {
+                ArenaScope scope( arena() );
+                return make_array( std::make_shared<ArenaVector<uint8_t>>( size, 0 ) );
+            }
+
+            /**
+             * @brief A numpy array of `size` integers pushed back one by one, so that its
+             * storage is reallocated as it grows.
+             */
+            py::array_t<int64_t> grow( const size_t size ) {
+                ArenaScope scope( arena() );
+                auto res = std::make_shared<ArenaVector<int64_t>>();
+                for ( size_t i = 0; i < size; i++ ) res->push_back( i );
+                return make_array( res );
+            }
+
+            py::dict stats() {
+                auto stats = m_arena->stats();
+                py::dict res;
+                res["n_slabs"]       = stats.n_slabs;
+                res["n_bytes"]       = stats.n_bytes;
+                res["n_live_blocks"] = stats.n_live_blocks;
+                res["n_free_blocks"] = stats.n_free_blocks;
+                res["n_reused"]      = stats.n_reused;
+                return res;
+            }
+
+            /**
+             * @brief Read all entries of a basket with `reader` in the arena, calling its
+             * @ref IReader::reserve() first if `reserve` is true. Returns `(data, stats before
+             * reading the entries, stats after)`.
+             */
+            py::tuple read( SharedReader reader, py::array_t<uint8_t> data,
+                            py::array_t<uint32_t> offsets, const bool reserve ) {
+                BinaryStream stream( data, offsets, 0 );
+                py::dict before, after;
+                {
+                    ArenaScope scope( arena() );
+                    auto n_bytes = offsets.data()[stream.entries()] - offsets.data()[0];
+                    if ( reserve ) reader->reserve( stream.entries(), n_bytes );
+
+                    before = stats();
+                    for ( uint64_t i = 0; i < stream.entries(); i++ )
+                    {
+                        stream.set_current_entry( i );
+                        reader->read( stream );
+                    }
+                    after = stats();
+                }
+                return py::make_tuple( reader->data(), before, after );
+            }
+
+            void close() {
+                if ( !m_closed ) m_arena->release();
+                m_closed = true;
+            }
+
+          private:
+            BufferArena* m_arena{ BufferArena::create() };
+            bool m_closed{ false };
+
+            BufferArena* arena() {
+                if ( m_closed ) throw std::runtime_error( "the arena is closed" );
+                return m_arena;
+            }
+        };
+
+        template <size_t Size>
+        py::array_t<uint8_t> bswap_copy_n( const uint8_t* src, const size_t n ) {
+            py::array_t<uint8_t> res( n * Size );
+            bswap_copy<Size>( res.mutable_data(), src, n );
+            return res;
+        }
+
+        /**
+         * @brief Convert `data` from big-endian values of `size` bytes, with @ref
+         * bswap_copy().
+         */
+        py::array_t<uint8_t> py_bswap_copy( py::array_t<uint8_t> data, const size_t size ) {
+            const size_t n = data.size() / size;
+            switch ( size )
+            {
+                case 1: return bswap_copy_n<1>( data.data(), n );
+                case 2: return bswap_copy_n<2>( data.data(), n );
+                case 4: return bswap_copy_n<4>( data.data(), n );
+                case 8: return bswap_copy_n<8>( data.data(), n );
+                default: throw std::invalid_argument( "unsupported size" );
+            }
+        }
+
+        template <size_t KeySize, size_t ValueSize>
+        py::tuple bswap_copy_pairs_n( const uint8_t* src, const size_t n ) {
+            py::array_t<uint8_t> keys( n * KeySize ), values( n * ValueSize );
+            bswap_copy_pairs<KeySize, ValueSize>( keys.mutable_data(), values.mutable_data(),
+                                                  src, n );
+            return py::make_tuple( keys, values );
+        }
+
+        template <size_t KeySize>
+        py::tuple bswap_copy_pairs_k( const uint8_t* src, const size_t n,
+                                      const size_t value_size ) {
+            switch ( value_size )
+            {
+                case 1: return bswap_copy_pairs_n<KeySize, 1>( src, n );
+                case 2: return bswap_copy_pairs_n<KeySize, 2>( src, n );
+                case 4: return bswap_copy_pairs_n<KeySize, 4>( src, n );
+                case 8: return bswap_copy_pairs_n<KeySize, 8>( src, n );
+                default: throw std::invalid_argument( "unsupported value size" );
+            }
+        }
+
+        /**
+         * @brief Split `data` into keys and values of big-endian `(key, value)` pairs, with
+         * @ref bswap_copy_pairs().
+         */
+        py::tuple py_bswap_copy_pairs( py::array_t<uint8_t> data, const size_t key_size,
+                                       const size_t value_size ) {
+            const size_t n = data.size() / ( key_size + value_size );
+            switch ( key_size )
+            {
+                case 1: return bswap_copy_pairs_k<1>( data.data(), n, value_size );
+                case 2: return bswap_copy_pairs_k<2>( data.data(), n, value_size );
+                case 4: return bswap_copy_pairs_k<4>( data.data(), n, value_size );
+                case 8: return bswap_copy_pairs_k<8>( data.data(), n, value_size );
+                default: throw std::invalid_argument( "unsupported key size" );
+            }
+        }
+
+        /// Static counterpart of a `std::vector<std::map<int, std::string>>` reader tree
+        using StaticVecMapReader = StaticReader<static_reader::STLSeq<static_reader::STLMap<
+            static_reader::Primitive<int32_t>, static_reader::STLString<>>>>;
+    } // namespace testing
+} // namespace uproot_custom
+
+PYBIND11_MODULE( _testing, m ) {
+    using namespace uproot_custom;
+    using namespace uproot_custom::testing;
+
+    m.doc() = "Test-only access to the internals of uproot-custom";
+
+    // registers IReader, the base of the readers declared here
+    py::module_::import( "uproot_custom.cpp" );
+
+    py::class_<BinaryStream>( m, "BinaryStream" )
+        .def( py::init<py::array_t<uint8_t>, py::array_t<uint32_t>, uint32_t>(),
+              py::arg( "data" ), py::arg( "offsets" ), py::arg( "cursor_offset" ) = 0,
+              py::keep_alive<1, 2>(), py::keep_alive<1, 3>() )
+        .def( "read_TString_view", &read_TString_view )
+        .def( "read_bytes", &read_bytes, py::arg( "n" ) )
+        .def( "get_index", &BinaryStream::get_index )
+        .def( "find_ref", &find_ref, py::arg( "key" ) )
+        .def( "set_ref", &set_ref, py::arg( "key" ), py::arg( "kind" ), py::arg( "value" ) )
+        .def( "n_refs", &BinaryStream::n_refs )
+        .def( "ref_capacity", &BinaryStream::ref_capacity )
+        .def( "reset_refs", &BinaryStream::reset_refs )
+        .def( "reset_refs_per_entry", &BinaryStream::reset_refs_per_entry )
+        .def( "set_current_entry", &BinaryStream::set_current_entry, py::arg( "entry" ) )
+        .def( "intern_class_name", &BinaryStream::intern_class_name, py::arg( "name" ) )
+        .def( "legacy_refs", &legacy_refs )
+        .def( "legacy_set_ref", &legacy_set_ref, py::arg( "key" ), py::arg( "value" ) );
+
+    py::class_<ArenaHandle>( m, "Arena" )
+        .def( py::init<>() )
+        .def( "allocate", &ArenaHandle::allocate, py::arg( "n_bytes" ) )
+        .def( "deallocate", &ArenaHandle::deallocate, py::arg( "ptr" ) )
+        .def( "array", &ArenaHandle::array, py::arg( "size" ) )
+        .def( "grow", &ArenaHandle::grow, py::arg( "size" ) )
+        .def( "read", &ArenaHandle::read, py::arg( "reader" ), py::arg( "data" ),
+              py::arg( "offsets" ), py::arg( "reserve" ) )
+        .def( "stats", &ArenaHandle::stats )
+        .def( "close", &ArenaHandle::close );
+
+    declare_reader<StaticVecMapReader, string>( m, "StaticVecMapReader" );
+
+    m.def( "bswap_copy", &py_bswap_copy, py::arg( "data" ), py::arg( "size" ) );
+    m.def( "bswap_copy_pairs", &py_bswap_copy_pairs, py::arg( "data" ), py::arg( "key_size" ),
+           py::arg( "value_size" ) );
+}
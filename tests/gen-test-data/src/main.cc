@@ -1,5 +1,6 @@
 #include <TFile.h>
 #include <TTree.h>
+#include <cstdlib>
 #include <iostream>
 
 #include "TBasicTypes.hh"
@@ -20,7 +21,7 @@
 using namespace std;
 
 const char* TREE_NAME = "tree";
-const int NUM_ENTRIES = 10;
+int NUM_ENTRIES       = 10; // can be overridden by the first command line argument
 
 void gen_primitive() {
     TFile f( "test_primitive.root", "RECREATE" );
@@ -260,7 +261,10 @@ void gen_TPureStruct() {
     f.Close();
 }
 
-int main() {
+int main( int argc, char** argv ) {
+    if ( argc > 1 ) NUM_ENTRIES = std::atoi( argv[1] );
+    cout << "Generating " << NUM_ENTRIES << " entries per file" << endl;
+
     cout << "Generating primitive data..." << endl;
     gen_primitive();
 
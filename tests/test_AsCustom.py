@@ -1,3 +1,17 @@
+import pickle
+
+import awkward as ak
+import numpy as np
+import pytest
+from numpy.testing import assert_array_equal
+
+import uproot_custom
+import uproot_custom.factories
+from uproot_custom.cache import DecodedCache, factory_fingerprint, load_raw_data, save_raw_data
+from uproot_custom.distributed import SharedRawData
+from uproot_custom.factories import regularize_basket_offsets
+
+
 def test_to_packed(test_contexts):
     br = test_contexts["primitive"]["file"]["/tree:branch/m_double"]
 
@@ -12,3 +26,203 @@ def test_virtual(test_contexts, subtests):
         for sub_branch in test_branches:
             with subtests.test(test_name=test_name, branch=sub_branch):
                 test_file[sub_branch].arrays(virtual=True)
+
+
+def test_share_basket_buffers(test_contexts, subtests, monkeypatch):
+    monkeypatch.setattr(uproot_custom.factories, "reader_backend", "cpp")
+    for test_name, ctx in test_contexts.items():
+        test_file = ctx["file"]
+        test_branches = ctx["branches"]
+        for sub_branch in test_branches:
+            with subtests.test(test_name=test_name, branch=sub_branch):
+                monkeypatch.setattr(uproot_custom.AsCustom, "share_basket_buffers", False)
+                test_file.file._array_cache = None
+                expected = test_file[sub_branch].array(entry_start=1, entry_stop=-1)
+
+                monkeypatch.setattr(uproot_custom.AsCustom, "share_basket_buffers", True)
+                test_file.file._array_cache = None
+                arr = test_file[sub_branch].array(entry_start=1, entry_stop=-1)
+
+                assert ak.array_equal(arr, expected)
+
+
+def test_intra_basket_threads(test_contexts, subtests, monkeypatch):
+    monkeypatch.setattr(uproot_custom.factories, "reader_backend", "cpp")
+    for test_name, ctx in test_contexts.items():
+        test_file = ctx["file"]
+        test_branches = ctx["branches"]
+        for sub_branch in test_branches:
+            with subtests.test(test_name=test_name, branch=sub_branch):
+                monkeypatch.setattr(uproot_custom.AsCustom, "intra_basket_threads", 1)
+                test_file.file._array_cache = None
+                expected = test_file[sub_branch].array()
+
+                # one chunk per entry, up to 3 per basket
+                monkeypatch.setattr(uproot_custom.AsCustom, "intra_basket_threads", 3)
+                monkeypatch.setattr(uproot_custom.AsCustom, "intra_basket_chunk_bytes", 1)
+                test_file.file._array_cache = None
+                arr = test_file[sub_branch].array()
+
+                assert ak.array_equal(arr, expected)
+
+
+def test_fused_basket_array(test_contexts, subtests, monkeypatch):
+    monkeypatch.setattr(uproot_custom.factories, "reader_backend", "cpp")
+    for test_name, ctx in test_contexts.items():
+        test_file = ctx["file"]
+        test_branches = ctx["branches"]
+        for sub_branch in test_branches:
+            with subtests.test(test_name=test_name, branch=sub_branch):
+                branch = test_file[sub_branch]
+                entry_stop = branch.basket_entry_start_stop(0)[1]
+                expected = branch.array(entry_stop=entry_stop)
+
+                arr = branch.interpretation.fused_basket_array(0)
+                assert ak.array_equal(arr, expected)
+
+
+def test_save_load_raw_data(tmp_path):
+    raw_data = [
+        np.arange(5, dtype=np.int64),
+        (np.arange(3, dtype=">i4"), np.zeros(0, dtype=np.uint8)),
+        None,
+        [np.ones((2, 3), dtype=np.float32)],
+    ]
+    save_raw_data(tmp_path / "basket.ucdc", raw_data)
+    loaded = load_raw_data(tmp_path / "basket.ucdc")
+
+    assert isinstance(loaded, list) and isinstance(loaded[1], tuple)
+    assert_array_equal(loaded[0], raw_data[0])
+    assert_array_equal(loaded[1][0], raw_data[1][0])
+    assert loaded[1][0].dtype == np.dtype(">i4")
+    assert loaded[1][1].size == 0
+    assert loaded[2] is None
+    assert loaded[3][0].shape == (2, 3)
+
+    # arrays are copy-on-write
+    loaded[0][0] = 10
+    assert load_raw_data(tmp_path / "basket.ucdc")[0][0] == 0
+
+
+@pytest.mark.parametrize("spill", [False, True])
+def test_decoded_cache(test_contexts, subtests, monkeypatch, tmp_path, spill):
+    monkeypatch.setattr(uproot_custom.factories, "reader_backend", "cpp")
+    for test_name, ctx in test_contexts.items():
+        test_file = ctx["file"]
+        test_branches = ctx["branches"]
+        for sub_branch in test_branches:
+            with subtests.test(test_name=test_name, branch=sub_branch):
+                test_file.file._array_cache = None
+                expected = test_file[sub_branch].array()
+
+                # without memory, every basket goes to disk
+                cache = DecodedCache(0, tmp_path) if spill else DecodedCache(1024**3)
+                monkeypatch.setattr(uproot_custom.AsCustom, "decoded_cache", cache)
+
+                for _ in range(2):
+                    test_file.file._array_cache = None
+                    arr = test_file[sub_branch].array()
+                    assert ak.array_equal(arr, expected)
+
+                assert cache.misses == test_file[sub_branch].num_baskets
+                assert cache.hits == test_file[sub_branch].num_baskets
+
+
+def test_reader_plan(test_contexts, subtests, monkeypatch):
+    monkeypatch.setattr(uproot_custom.factories, "reader_backend", "cpp")
+    for test_name, ctx in test_contexts.items():
+        test_file = ctx["file"]
+        test_branches = ctx["branches"]
+        for sub_branch in test_branches:
+            with subtests.test(test_name=test_name, branch=sub_branch):
+                branch = test_file[sub_branch]
+                interp = branch.interpretation
+                expected = branch.array(entry_stop=branch.basket_entry_start_stop(0)[1])
+
+                # a worker only receives the plan, and rehydrates it once
+                plan = pickle.loads(pickle.dumps(interp.reader_plan))
+                assert plan is pickle.loads(pickle.dumps(interp.reader_plan))
+                assert plan.factory is not interp.factory
+                assert plan.fingerprint == factory_fingerprint(interp.factory)
+
+                basket = branch.basket(0)
+                offsets = regularize_basket_offsets(
+                    basket.data, basket.byte_offsets, interp.cls_streamer_info
+                )
+                raw_data = plan.read(basket.data, offsets, int(basket.member("fKeylen")))
+
+                # only the name of the shared memory block is pickled
+                shared = SharedRawData(raw_data)
+                received = pickle.loads(pickle.dumps(shared))
+                assert ak.array_equal(plan.array(received.get()), expected)
+                received.close()
+                shared.close()
+                shared.unlink()
+
+
+class FakeBasket:
+    """
+    Basket of objects with members `m_int` (int32) and `m_vec` (`std::vector<double>`).
+    """
+
+    def __init__(self, values):
+        def with_header(body, version):
+            header = np.array([0x40000000 | (2 + len(body))], dtype=">u4").tobytes()
+            return header + np.array([version], dtype=">u2").tobytes() + body
+
+        entries = []
+        for i in values:
+            vec = np.array([i], dtype=">u4").tobytes() + np.arange(i, dtype=">f8").tobytes()
+            body = np.array([i], dtype=">i4").tobytes() + with_header(vec, 9)
+            entries.append(with_header(body, 1))
+
+        self.data = np.frombuffer(b"".join(entries), dtype=np.uint8)
+        self.byte_offsets = np.cumsum([0] + [len(e) for e in entries], dtype=np.int32)
+
+    def member(self, name):
+        return 0
+
+
+class FakeBranch:
+    def __init__(self, file_path, baskets):
+        self.object_path = "/tree:branch"
+        self.file = type("FakeFile", (), {"uuid": "0123", "file_path": str(file_path)})
+        self.baskets = [FakeBasket(values) for values in baskets]
+        self.num_baskets = len(self.baskets)
+        self.entry_offsets = np.cumsum([0] + [len(values) for values in baskets]).tolist()
+
+    def basket(self, basket_num):
+        return self.baskets[basket_num]
+
+
+def test_branch_index(tmp_path):
+    from uproot_custom.factories import AnyClassFactory, PrimitiveFactory, STLSeqFactory
+    from uproot_custom.index import BranchIndex, sidecar_path
+
+    factory = AnyClassFactory(
+        "obj",
+        [
+            PrimitiveFactory("m_int", "int32"),
+            STLSeqFactory("m_vec", True, -1, PrimitiveFactory("m_vec", "float64")),
+        ],
+    )
+    branch = FakeBranch(tmp_path / "file.root", [[0, 1, 2], [3], [4, 5]])
+    path = sidecar_path(branch.file.file_path, branch.object_path)
+    assert path.parent == tmp_path / "file.root.ucidx"
+
+    index = BranchIndex.open(branch, factory)
+    assert path.exists()
+    assert sorted(index.positions) == [0, 1, 2]
+
+    # loaded from the sidecar, rebuilt when the factory changes
+    loaded = BranchIndex.open(branch, factory)
+    assert loaded.matches(branch, factory)
+    assert_array_equal(loaded.positions[2][1], index.positions[2][1])
+    factory.sub_factories[0] = PrimitiveFactory("m_int", "uint32")
+    assert not loaded.matches(branch, factory)
+    factory.sub_factories[0] = PrimitiveFactory("m_int", "int32")
+
+    arr = loaded.read(branch, 2, 5, factory)
+    assert arr.m_int.tolist() == [2, 3, 4]
+    assert arr.m_vec.tolist() == [list(range(i)) for i in (2, 3, 4)]
+    assert len(loaded.read(branch, 6, 10, factory)) == 0
@@ -0,0 +1,284 @@
+"""
+Tests of C++ internals that the readers do not expose, through the test-only module
+`uproot_custom._testing`. Build it with
+`pip install -e . -Ccmake.define.UPROOT_CUSTOM_BUILD_TESTING=ON`.
+"""
+
+import numpy as np
+import pytest
+from numpy.testing import assert_array_equal
+
+import uproot_custom.readers.cpp
+
+_testing = pytest.importorskip("uproot_custom._testing")
+
+
+@pytest.mark.parametrize("size", [1, 2, 4, 8])
+@pytest.mark.parametrize("count", [0, 1, 3, 17, 33])
+def test_bswap_copy(size, count):
+    raw = np.random.default_rng(count).integers(0, 256, size * count + 1, dtype=np.uint8)
+
+    # aligned and unaligned sources
+    for data in [raw[:-1], raw[1:]]:
+        expected = np.frombuffer(data.tobytes(), dtype=f">u{size}").astype(f"u{size}")
+        assert_array_equal(_testing.bswap_copy(data, size).view(f"u{size}"), expected)
+
+
+@pytest.mark.parametrize("key_size, value_size", [(2, 8), (4, 4), (4, 8), (8, 2), (8, 8)])
+@pytest.mark.parametrize("count", [1, 3, 17, 33])
+def test_bswap_copy_pairs(key_size, value_size, count):
+    dtype = np.dtype([("k", f">u{key_size}"), ("v", f">u{value_size}")])
+    rng = np.random.default_rng(count)
+    data = rng.integers(0, 256, dtype.itemsize * count, dtype=np.uint8)
+    pairs = np.frombuffer(data.tobytes(), dtype=dtype)
+
+    keys, values = _testing.bswap_copy_pairs(data, key_size, value_size)
+    assert_array_equal(keys.view(f"u{key_size}"), pairs["k"].astype(f"u{key_size}"))
+    assert_array_equal(values.view(f"u{value_size}"), pairs["v"].astype(f"u{value_size}"))
+
+
+def make_stream(data=b""):
+    data = np.frombuffer(data, dtype=np.uint8)
+    return _testing.BinaryStream(data, np.array([0, data.size], dtype=np.uint32))
+
+
+def test_read_TString_view():
+    # (payload, whether it uses the long form with a uint32 length after 0xFF)
+    strings = [(b"", False), (b"abc", False), (b"x" * 254, False), (b"y" * 255, True)]
+    strings += [(b"z" * 300, True), (b"", True), (b"ab", True)]
+    data = b""
+    for text, long_form in strings:
+        if long_form:
+            data += b"\xff" + np.array([len(text)], dtype=">u4").tobytes()
+        else:
+            data += bytes([len(text)])
+        data += text
+
+    stream = make_stream(data)
+    for text, long_form in strings:
+        start = stream.get_index() + (5 if long_form else 1)
+        assert stream.read_TString_view() == (start, text)
+    assert stream.get_index() == len(data)
+
+    with pytest.raises(RuntimeError, match="out of bounds"):
+        make_stream(b"\x05abc").read_TString_view()
+    with pytest.raises(RuntimeError, match="out of bounds"):
+        make_stream(b"\xff\x00\x00").read_TString_view()
+
+
+def test_read_bytes():
+    stream = make_stream(b"abcdef")
+    assert stream.read_bytes(0) == (0, b"")
+    assert stream.read_bytes(2) == (0, b"ab")
+    assert stream.read_bytes(4) == (2, b"cdef")
+    assert stream.read_bytes(0) == (6, b"")
+
+    with pytest.raises(RuntimeError, match="out of bounds"):
+        stream.read_bytes(1)
+    assert stream.get_index() == 6
+
+
+def ref_slot(key, capacity):
+    # same as BinaryStream::hash_ref_key
+    return ((key * 0x9E3779B97F4A7C15) % 2**64 >> 32) & (capacity - 1)
+
+
+def test_refs_collisions():
+    stream = make_stream()
+    assert stream.find_ref(2) is None
+    assert stream.ref_capacity() == 0
+
+    stream.set_ref(2, "object", 0)
+    capacity = stream.ref_capacity()
+    assert capacity == 16
+
+    # keys probing the same slot, including one wrapping around the end of the table
+    colliding = [k for k in range(3, 100000) if ref_slot(k, capacity) == ref_slot(2, capacity)]
+    last_slot = [k for k in range(3, 100000) if ref_slot(k, capacity) == capacity - 1]
+    keys = [2] + colliding[:3] + last_slot[:2]
+    for value, key in enumerate(keys[1:], 1):
+        stream.set_ref(key, "object", value)
+    assert stream.ref_capacity() == capacity
+    assert stream.n_refs() == len(keys)
+
+    for value, key in enumerate(keys):
+        assert stream.find_ref(key) == ("object", value)
+    assert stream.find_ref(colliding[3]) is None
+
+    # replacing a reference does not register a new one
+    stream.set_ref(colliding[0], "class", stream.intern_class_name("Obj"))
+    assert stream.find_ref(colliding[0]) == ("class", 0)
+    assert stream.n_refs() == len(keys)
+
+
+def test_refs_rehash():
+    stream = make_stream()
+    keys = [10 + 6 * i for i in range(1000)]
+    capacities = []
+    for value, key in enumerate(keys):
+        stream.set_ref(key, "object", value)
+        capacities.append(stream.ref_capacity())
+
+        # the load factor stays at or below 1/2
+        assert stream.n_refs() * 2 <= stream.ref_capacity()
+
+    assert sorted(set(capacities)) == [2**n for n in range(4, 12)]
+    for value, key in enumerate(keys):
+        assert stream.find_ref(key) == ("object", value)
+    assert stream.find_ref(11) is None
+    assert stream.find_ref(keys[-1] + 6) is None
+
+
+def test_refs_reset():
+    stream = make_stream()
+    stream.set_ref(2, "class", stream.intern_class_name("Obj"))
+    stream.set_ref(3, "object", 0)
+
+    # numbering goes on after a reset
+    stream.reset_refs()
+    assert stream.find_ref(2) is None and stream.find_ref(3) is None
+    assert stream.n_refs() == 2
+    stream.set_ref(stream.n_refs() + 1, "object", 1)
+    assert stream.find_ref(3) == ("object", 1)
+    assert stream.n_refs() == 3
+
+    # only the first call of an entry resets
+    stream.set_current_entry(1)
+    stream.reset_refs_per_entry()
+    stream.set_ref(20, "object", 2)
+    stream.reset_refs_per_entry()
+    assert stream.find_ref(20) == ("object", 2)
+    assert stream.intern_class_name("Obj") == 0
+
+
+def test_legacy_get_refs():
+    stream = make_stream()
+    stream.set_ref(2, "class", stream.intern_class_name("Obj"))
+    stream.set_ref(6, "object", 3)
+    assert stream.legacy_refs() == {2: ("class", "Obj"), 6: ("object", 3)}
+
+    # changes to the map are merged back by the next call
+    stream.legacy_set_ref(10, 4)
+    stream.legacy_set_ref(14, "Other")
+    assert stream.legacy_refs()[10] == ("object", 4)
+    assert stream.find_ref(10) == ("object", 4)
+    assert stream.find_ref(14) == ("class", stream.intern_class_name("Other"))
+    assert stream.n_refs() == 4
+
+
+SLAB_SIZE = 1 << 20
+
+
+def test_arena_reuse():
+    arena = _testing.Arena()
+    ptr = arena.allocate(100)
+    arena.deallocate(ptr)
+    assert arena.stats()["n_free_blocks"] == 1
+
+    # a block of the same size class takes the freed one
+    assert arena.allocate(200) == ptr
+    assert arena.stats()["n_reused"] == 1
+    assert arena.stats()["n_free_blocks"] == 0
+    assert arena.allocate(100) != ptr
+    arena.deallocate(ptr)
+
+    # the storage left behind by a growing vector is taken by the next one
+    first = arena.grow(10000)
+    assert_array_equal(first, np.arange(10000))
+    del first
+    stats = arena.stats()
+    assert stats["n_free_blocks"] > 10
+    second = arena.grow(10000)
+    assert_array_equal(second, np.arange(10000))
+    assert arena.stats()["n_bytes"] == stats["n_bytes"]
+    assert arena.stats()["n_reused"] - stats["n_reused"] > 10
+
+
+def test_arena_large_blocks():
+    arena = _testing.Arena()
+    ptr = arena.allocate(SLAB_SIZE)
+    assert arena.stats()["n_slabs"] == 1
+    assert arena.stats()["n_bytes"] > SLAB_SIZE
+    arena.deallocate(ptr)
+
+    # reused if it wastes at most half of it
+    assert arena.allocate(SLAB_SIZE // 2 + 1000) == ptr
+    arena.deallocate(ptr)
+    assert arena.allocate(SLAB_SIZE // 4) != ptr
+    assert arena.stats()["n_slabs"] == 2
+
+
+def test_arena_lifetime():
+    arena = _testing.Arena()
+
+    # 7 blocks of 128 KB per slab
+    arrays = [arena.array(100000) for _ in range(21)]
+    assert arena.stats()["n_slabs"] == 3
+    kept = arrays[10]
+    del arrays
+
+    # empty slabs are kept for reuse while the arena is in use
+    stats = arena.stats()
+    assert stats["n_slabs"] == 3
+    assert stats["n_live_blocks"] == 1
+
+    # then only the slab of the surviving array is held
+    arena.close()
+    stats = arena.stats()
+    assert stats["n_slabs"] == 1
+    assert stats["n_bytes"] == SLAB_SIZE
+    assert stats["n_free_blocks"] == 6
+    assert_array_equal(kept, np.zeros(100000, dtype=np.uint8))
+    with pytest.raises(RuntimeError):
+        arena.array(10)
+
+
+
+def make_reserve_case(kind):
+    """
+    Returns `(make_reader, entries)` for a basket of `kind`.
+    """
+    cpp = uproot_custom.readers.cpp
+    if kind == "vector":
+        entries = []
+        for n in [0, 3, 1, 7, 2, 0, 5]:
+            body = np.array([9], dtype=">u2").tobytes() + np.array([n], dtype=">u4").tobytes()
+            body += np.arange(n, dtype=">f8").tobytes()
+            entries.append(np.array([0x40000000 | len(body)], dtype=">u4").tobytes() + body)
+        return lambda: cpp.STLSeqReader("vec", True, 0, cpp.DoubleReader("x")), entries
+    if kind == "string":
+        entries = [bytes([len(s)]) + s for s in [b"", b"abc", b"x" * 40, b"de"]]
+        return lambda: cpp.STLStringReader("str", False), entries
+    entries = [np.array([i], dtype=">i4").tobytes() for i in range(9)]
+    return lambda: cpp.Int32Reader("i"), entries
+
+
+def flatten_raw_data(raw):
+    if isinstance(raw, np.ndarray):
+        return [raw]
+    return [array for item in raw for array in flatten_raw_data(item)]
+
+
+@pytest.mark.parametrize("kind", ["vector", "string", "primitive"])
+def test_reserve_capacity(kind):
+    make_reader, entries = make_reserve_case(kind)
+    data = np.frombuffer(b"".join(entries), dtype=np.uint8)
+    offsets = np.cumsum([0] + [len(e) for e in entries], dtype=np.uint32)
+
+    # reserved buffers hold the whole basket, so decoding allocates nothing
+    arena = _testing.Arena()
+    reserved, before, after = arena.read(make_reader(), data, offsets, reserve=True)
+    assert after == before
+
+    # without reservation, the buffers grow while decoding
+    arena = _testing.Arena()
+    grown, before, after = arena.read(make_reader(), data, offsets, reserve=False)
+    assert after["n_live_blocks"] > before["n_live_blocks"]
+
+    expected = uproot_custom.readers.cpp.read_data(data, offsets, 0, make_reader())
+    reserved, grown, expected = map(flatten_raw_data, [reserved, grown, expected])
+    assert len(reserved) == len(grown) == len(expected)
+    for r, g, e in zip(reserved, grown, expected):
+        assert r.dtype == g.dtype == e.dtype
+        assert_array_equal(r, e)
+        assert_array_equal(g, e)
@@ -1,8 +1,12 @@
+import lzma
+import zlib
+
 import awkward as ak
 import numpy as np
 import pytest
 from numpy.testing import assert_array_equal
 
+import uproot_custom.compression
 import uproot_custom.factories
 from uproot_custom.readers import _forth
 
@@ -26,6 +30,11 @@ def test_cpp(test_contexts, subtests, monkeypatch):
     _test_helper(test_contexts, subtests)
 
 
+def test_plan(test_contexts, subtests, monkeypatch):
+    monkeypatch.setattr(uproot_custom.factories, "reader_backend", "plan")
+    _test_helper(test_contexts, subtests)
+
+
 def test_forth(test_contexts, subtests, monkeypatch):
     forth_test_names = [
         "primitive",
@@ -137,3 +146,947 @@ def test_numba(test_contexts, subtests, monkeypatch):
     monkeypatch.setattr(uproot_custom.factories, "reader_backend", "numba")
     with pytest.warns(UserWarning):
         _test_helper(numba_contexts, subtests)
+
+
+def test_cpp_tarray_keep_big_endian(test_contexts, monkeypatch):
+    monkeypatch.setattr(uproot_custom.factories, "reader_backend", "cpp")
+    monkeypatch.setattr(
+        uproot_custom.factories.TArrayFactory,
+        "keep_big_endian_itempaths",
+        {"/tree:branch/m_TArrayI", "/tree:branch/m_TArrayL"},
+    )
+
+    test_file = test_contexts["root_objects"]["file"]
+    for sub_branch in ["/tree:branch/m_TArrayI", "/tree:branch/m_TArrayL"]:
+        # factories are cached per interpretation, rebuild them with the new option
+        interp = test_file[sub_branch].interpretation
+        interp.clear_cache()
+        arr = test_file[sub_branch].array()
+        assert ak.all(arr == [0, 1, 2, 3, 4])
+        interp.clear_cache()
+
+
+@pytest.mark.parametrize(
+    "backend, pool", [("cpp", "_cpp_reader_pool"), ("plan", "_plan_pool")]
+)
+def test_cpp_reader_reuse(test_contexts, monkeypatch, backend, pool):
+    monkeypatch.setattr(uproot_custom.factories, "reader_backend", backend)
+
+    test_file = test_contexts["stl_seq_with_obj"]["file"]
+    branch = test_file["/tree:branch/m_vec_simple_object/m_vec_simple_object.m_vec_double"]
+    branch.interpretation.clear_cache()
+
+    arr1 = branch.array()
+    test_file.file._array_cache = None
+    arr2 = branch.array()
+
+    assert len(getattr(branch.interpretation, pool)) > 0
+    assert ak.array_equal(arr1, arr2)
+
+
+def make_vector_double_basket(sizes):
+    """
+    Serialize one `std::vector<double>` per entry, returns `(data, offsets)`.
+    """
+    entries = []
+    for n in sizes:
+        header = np.array([0x40000000 | (6 + 8 * n)], dtype=">u4").tobytes()
+        header += np.array([9], dtype=">u2").tobytes() + np.array([n], dtype=">u4").tobytes()
+        entries.append(header + np.arange(n, dtype=">f8").tobytes())
+
+    data = np.frombuffer(b"".join(entries), dtype=np.uint8)
+    offsets = np.cumsum([0] + [len(e) for e in entries], dtype=np.uint32)
+    return data, offsets
+
+
+def make_vector_double_reader():
+    return uproot_custom.readers.cpp.STLSeqReader(
+        "vec", True, 0, uproot_custom.readers.cpp.DoubleReader("x")
+    )
+
+
+def test_cpp_read_data_profile():
+    sizes = [0, 1, 2, 3, 1, 2]
+    data, offsets = make_vector_double_basket(sizes)
+
+    reader = make_vector_double_reader()
+    (seq_offsets, values), report = uproot_custom.readers.cpp.read_data(
+        data, offsets, 0, reader, profile=True
+    )
+    assert_array_equal(seq_offsets, np.cumsum([0] + sizes))
+
+    vec = report["vec"]
+    assert vec["calls"]["read"] == len(sizes)
+    assert vec["elements"] == len(sizes)
+    assert vec["bytes"] == data.size
+    assert vec["time_ns"] >= vec["self_time_ns"] >= 0
+
+    x = vec["children"]["x"]
+    assert x["calls"]["read_many"] == len(sizes)
+    assert x["elements"] == values.size == sum(sizes)
+    assert x["bytes"] == 8 * sum(sizes)
+    assert x["children"] == {}
+
+
+def test_cpp_read_data_buffer():
+    sizes = [2, 0, 3, 1]
+    data, offsets = make_vector_double_basket(sizes)
+    expected = uproot_custom.readers.cpp.read_data(
+        data, offsets, 0, make_vector_double_reader()
+    )
+
+    res = uproot_custom.readers.cpp.read_data(
+        data.tobytes(), memoryview(offsets), 0, make_vector_double_reader()
+    )
+    for r, e in zip(res, expected):
+        assert_array_equal(r, e)
+
+    with pytest.raises(RuntimeError):
+        uproot_custom.readers.cpp.read_data(
+            data.tobytes(), offsets.astype(np.int64).tobytes(), 0, make_vector_double_reader()
+        )
+
+
+def test_cpp_read_data_bounds_checks():
+    sizes = [2, 0, 3]
+    data, offsets = make_vector_double_basket(sizes)
+    assert uproot_custom.readers.cpp.bounds_checks()
+
+    # the count of the last vector runs past the end of the basket
+    corrupt = data.copy()
+    corrupt[offsets[-2] + 6 : offsets[-2] + 10] = np.frombuffer(
+        np.array([1000], dtype=">u4").tobytes(), dtype=np.uint8
+    )
+    with pytest.raises(RuntimeError, match="out of bounds"):
+        uproot_custom.readers.cpp.read_data(corrupt, offsets, 0, make_vector_double_reader())
+
+    # the data is shorter than the offsets claim
+    with pytest.raises(RuntimeError, match="out of bounds"):
+        uproot_custom.readers.cpp.read_data(
+            data[:-4].tobytes(), offsets, 0, make_vector_double_reader()
+        )
+
+    try:
+        uproot_custom.readers.cpp.set_bounds_checks(False)
+        assert not uproot_custom.readers.cpp.bounds_checks()
+        seq_offsets, _ = uproot_custom.readers.cpp.read_data(
+            data, offsets, 0, make_vector_double_reader()
+        )
+        assert_array_equal(seq_offsets, np.cumsum([0] + sizes))
+    finally:
+        uproot_custom.readers.cpp.set_bounds_checks(True)
+
+
+def test_plan_reader_bounds_checks():
+    from uproot_custom.factories import PrimitiveFactory, STLSeqFactory
+
+    sizes = [2, 0, 3]
+    data, offsets = make_vector_double_basket(sizes)
+    factory = STLSeqFactory("vec", True, -1, PrimitiveFactory("x", "float64"))
+    reader, template = uproot_custom.readers.plan.build_reader(factory)
+
+    # 0x20000001 doubles wrap around to 8 bytes in 32 bits
+    corrupt = data.copy()
+    corrupt[offsets[-2] + 6 : offsets[-2] + 10] = np.frombuffer(
+        np.array([0x20000001], dtype=">u4").tobytes(), dtype=np.uint8
+    )
+    with pytest.raises(RuntimeError, match="out of bounds"):
+        uproot_custom.readers.plan.read_data(corrupt, offsets, 0, reader, template)
+
+    # programs built by hand may pop an empty stack
+    ops = uproot_custom.readers.plan.OPCODES
+    stack_errors = {"pop": "count stack", "loop": "count stack", "class_end": "object stack"}
+    for opcode, match in stack_errors.items():
+        reader = uproot_custom.readers.cpp.PlanReader(
+            "plan", [(ops.index(opcode), 0, 1, 0, 0)], [], 0, [], ["plan"]
+        )
+        with pytest.raises(RuntimeError, match=match):
+            uproot_custom.readers.cpp.read_data(data, offsets, 0, reader)
+
+
+def test_offsets_format():
+    from uproot_custom.cache import factory_fingerprint
+    from uproot_custom.factories import PrimitiveFactory, STLSeqFactory, _build_cpp_reader
+
+    sizes = [2, 0, 300, 1]
+    data, offsets = make_vector_double_basket(sizes)
+    expected = np.cumsum([0] + sizes)
+
+    def make_factory():
+        return STLSeqFactory("vec", True, -1, PrimitiveFactory("x", "float64"))
+
+    default_factory = make_factory()
+    try:
+        uproot_custom.factories.set_offsets_format("i32")
+        factory = make_factory()
+        assert factory.offsets_format == "i32" and default_factory.offsets_format == "i64"
+        assert factory_fingerprint(factory) != factory_fingerprint(default_factory)
+
+        raw = uproot_custom.readers.cpp.read_data(data, offsets, 0, _build_cpp_reader(factory))
+        assert raw[0].dtype == np.int32
+        assert_array_equal(raw[0], expected)
+
+        content = factory.make_awkward_content(raw)
+        assert isinstance(content.offsets, ak.index.Index32)
+        assert content.form == factory.make_awkward_form()
+
+        # factories built before keep their format
+        raw = uproot_custom.readers.cpp.read_data(
+            data, offsets, 0, _build_cpp_reader(default_factory)
+        )
+        assert raw[0].dtype == np.int64
+        assert isinstance(default_factory.make_awkward_content(raw).offsets, ak.index.Index64)
+
+        uproot_custom.factories.set_offsets_format("i64", counts=True)
+        factory = make_factory()
+        assert factory.raw_offsets_format == "counts"
+        assert factory_fingerprint(factory) != factory_fingerprint(default_factory)
+
+        raw = uproot_custom.readers.cpp.read_data(data, offsets, 0, _build_cpp_reader(factory))
+        assert raw[0].dtype == np.uint16
+        assert_array_equal(raw[0], sizes)
+
+        content = factory.make_awkward_content(raw)
+        assert isinstance(content.offsets, ak.index.Index64)
+        assert_array_equal(content.offsets, expected)
+
+        with pytest.raises(ValueError):
+            uproot_custom.factories.set_offsets_format("u8")
+    finally:
+        uproot_custom.factories.set_offsets_format()
+    assert make_factory().raw_offsets_format == "i64"
+
+    reader = make_vector_double_reader()
+    reader.set_offsets_format("i32")
+    assert uproot_custom.readers.cpp.read_data(data, offsets, 0, reader)[0].dtype == np.int32
+    with pytest.raises(ValueError):
+        reader.set_offsets_format("u8")
+
+
+@pytest.mark.parametrize("window_size", [1, 7, 30, 1000])
+def test_cpp_chunked_decoder(window_size):
+    sizes = [2, 0, 3, 1, 4, 0, 0, 2]
+    data, offsets = make_vector_double_basket(sizes)
+    expected = uproot_custom.readers.cpp.read_data(
+        data, offsets, 0, make_vector_double_reader()
+    )
+
+    decoder = uproot_custom.readers.cpp.ChunkedDecoder(make_vector_double_reader(), offsets, 0)
+    buffer = memoryview(data.tobytes())
+    for start in range(0, len(buffer), window_size):
+        n_decoded = decoder.feed(buffer[start : start + window_size])
+        assert offsets[n_decoded] <= start + window_size
+
+    for r, e in zip(decoder.finish(), expected):
+        assert_array_equal(r, e)
+
+    decoder = uproot_custom.readers.cpp.ChunkedDecoder(make_vector_double_reader(), offsets, 0)
+    decoder.feed(buffer[:-1])
+    with pytest.raises(RuntimeError):
+        decoder.finish()
+
+
+def compress_blocks(algorithm, payload, block_size):
+    """
+    Compress a payload into ROOT compression blocks of `block_size` uncompressed bytes.
+    """
+    compressors = {b"ZL": zlib.compress, b"XZ": lzma.compress}
+    blocks = []
+    for start in range(0, len(payload), block_size):
+        block = payload[start : start + block_size]
+        compressed = compressors[algorithm](block)
+        blocks.append(
+            algorithm
+            + b"\x08"
+            + len(compressed).to_bytes(3, "little")
+            + len(block).to_bytes(3, "little")
+            + compressed
+        )
+    return b"".join(blocks)
+
+
+@pytest.mark.parametrize("algorithm", [b"ZL", b"XZ", None])
+@pytest.mark.parametrize("block_size, window_size", [(50, 7), (100, 1000), (10000, 64)])
+def test_read_branch_compressed(algorithm, block_size, window_size, monkeypatch):
+    # blocks must only be streamed, never decompressed as a whole
+    iter_decompressed = uproot_custom.compression.iter_decompressed
+    window_sizes = []
+
+    def record_windows(block, size):
+        for window in iter_decompressed(block, size):
+            window_sizes.append(len(window))
+            yield window
+
+    monkeypatch.setattr(uproot_custom.compression, "iter_decompressed", record_windows)
+    monkeypatch.setattr(uproot_custom.compression, "decompress", None)
+
+    sizes = [2, 0, 3, 1, 4, 0, 0, 2]
+    data, offsets = make_vector_double_basket(sizes)
+
+    # entry offsets are stored after the entry data, shifted by the key length
+    key_length = 70
+    raw_offsets = np.concatenate([[len(sizes) + 1], offsets[:-1] + key_length, [0]])
+    payload = data.tobytes() + raw_offsets.astype(">i4").tobytes()
+
+    factory = uproot_custom.factories.STLSeqFactory(
+        "vec", True, 0, uproot_custom.factories.PrimitiveFactory("x", "float64")
+    )
+    raw_data = uproot_custom.readers.cpp.read_data(
+        data, offsets, key_length, factory.build_cpp_reader()
+    )
+    expected = factory.make_awkward_content(raw_data)
+
+    if algorithm is not None:
+        payload = compress_blocks(algorithm, payload, block_size)
+
+    basket = uproot_custom.compression.BasketPayload(
+        memoryview(payload),
+        compressed=algorithm is not None,
+        border=data.size,
+        key_length=key_length,
+    )
+    content = uproot_custom.factories.read_branch_compressed(
+        basket, factory, {}, window_size=window_size
+    )
+    assert ak.array_equal(ak.Array(content), ak.Array(expected))
+    assert max(window_sizes, default=0) <= window_size
+
+
+def test_cpp_read_data_many():
+    baskets, expected = [], []
+    for i in range(8):
+        values = np.arange(i * 100, (i + 1) * 100, dtype=np.float64)
+        data = values.astype(">f8").view(np.uint8)
+        offsets = np.arange(values.size + 1, dtype=np.uint32) * 8
+        baskets.append((data, offsets, 0))
+        expected.append(values)
+
+    results = uproot_custom.readers.cpp.read_data_many(
+        baskets, lambda: uproot_custom.readers.cpp.DoubleReader("x"), 4
+    )
+
+    assert len(results) == len(expected)
+    for res, exp in zip(results, expected):
+        assert_array_equal(res, exp)
+
+    # the first error stops the remaining baskets
+    n_calls = 0
+
+    def failing_factory():
+        nonlocal n_calls
+        n_calls += 1
+        raise ValueError("no reader")
+
+    with pytest.raises(ValueError, match="no reader"):
+        uproot_custom.readers.cpp.read_data_many(baskets, failing_factory, 1)
+    assert n_calls == 1
+
+
+def test_read_baskets_batch():
+    from uproot_custom.factories import PrimitiveFactory, STLSeqFactory
+
+    # baskets of very different sizes from two branches
+    vec_factory = STLSeqFactory("vec", True, -1, PrimitiveFactory("x", "float64"))
+    int_factory = PrimitiveFactory("i", "int32")
+
+    jobs, expected = [], []
+    for sizes in ([1000] * 50, [0, 2, 1], [5] * 20):
+        data, offsets = make_vector_double_basket(sizes)
+        jobs.append((data, offsets, 0, vec_factory))
+        expected.append([list(range(n)) for n in sizes])
+    for n in (3, 300):
+        values = np.arange(n, dtype=np.int32)
+        offsets = np.arange(n + 1, dtype=np.uint32) * 4
+        jobs.append((values.astype(">i4").view(np.uint8), offsets, 0, int_factory))
+        expected.append(values.tolist())
+
+    contents = uproot_custom.factories.read_baskets_batch(jobs, n_threads=3)
+    assert [ak.Array(c).tolist() for c in contents] == expected
+
+    reader = uproot_custom.readers.cpp.Int32Reader("i")
+    with pytest.raises(RuntimeError, match="more than one job"):
+        uproot_custom.readers.cpp.read_data_batch(
+            [(d, o, c, reader) for d, o, c, _ in jobs[3:]]
+        )
+
+
+def test_read_branch_chunked():
+    from uproot_custom.factories import PrimitiveFactory, STLSeqFactory
+
+    cpp = uproot_custom.readers.cpp
+    sizes = [1000, 0, 3, 1, 1, 200, 7, 7, 0, 50]
+    data, offsets = make_vector_double_basket(sizes)
+
+    # chunks of about the same number of bytes, in the order of the entries
+    readers = [make_vector_double_reader() for _ in range(3)]
+    chunks = cpp.read_data_chunked(data, offsets, 0, readers, 1, -1)
+    assert [len(seq_offsets) - 1 for seq_offsets, _ in chunks] == [5, 1, 3]
+    assert_array_equal(
+        np.concatenate([values for _, values in chunks]),
+        np.concatenate([np.arange(n, dtype=np.float64) for n in sizes[1:]]),
+    )
+
+    with pytest.raises(RuntimeError, match="more than one chunk"):
+        cpp.read_data_chunked(data, offsets, 0, [readers[0], readers[0]])
+
+    factory = STLSeqFactory("vec", True, -1, PrimitiveFactory("x", "float64"))
+    pool = []
+    for entry_start, entry_stop in [(0, -1), (2, 9), (4, 5)]:
+        content = uproot_custom.factories.read_branch_chunked(
+            data, offsets, 0, factory, 4, 1, pool, entry_start, entry_stop
+        )
+        stop = len(sizes) if entry_stop < 0 else entry_stop
+        assert ak.Array(content).tolist() == [list(range(n)) for n in sizes[entry_start:stop]]
+    assert len(pool) == 4
+
+
+@pytest.mark.parametrize("backend", ["cpp", "python"])
+def test_read_data_entry_range(backend):
+    values = np.arange(10, dtype=np.float64)
+    data = values.astype(">f8").view(np.uint8)
+    offsets = np.arange(values.size + 1, dtype=np.uint32) * 8
+
+    def make_reader():
+        if backend == "cpp":
+            return uproot_custom.readers.cpp.DoubleReader("x")
+        else:
+            return uproot_custom.readers.python.PrimitiveReader("x", "float64")
+
+    read_data = getattr(uproot_custom.readers, backend).read_data
+
+    res = read_data(data, offsets, 0, make_reader(), 3, 7)
+    assert_array_equal(res, values[3:7])
+
+    res = read_data(data, offsets, 0, make_reader(), 8)
+    assert_array_equal(res, values[8:])
+
+
+@pytest.mark.parametrize("backend", ["cpp", "python"])
+def test_jagged_array_stops_at_entry_end(backend):
+    # `Double_t fArr[fN]` members of entries of different sizes, read up to the end of
+    # the current entry
+    sizes = [3, 0, 1, 5, 0, 0, 2, 4]
+    values = [np.arange(n, dtype=np.float64) + 10 * i for i, n in enumerate(sizes)]
+    data = np.concatenate(values).astype(">f8").view(np.uint8)
+    offsets = np.cumsum([0] + sizes, dtype=np.uint32) * 8
+
+    readers = getattr(uproot_custom.readers, backend)
+    element_factory = uproot_custom.factories.PrimitiveFactory("x", "float64")
+
+    def make_reader():
+        element_reader = getattr(element_factory, f"build_{backend}_reader")()
+        return readers.CStyleArrayReader("arr", -1, element_reader)
+
+    for start, stop in [(0, len(sizes)), (1, 4), (3, 7), (6, len(sizes))]:
+        array_offsets, array_values = readers.read_data(
+            data, offsets, 0, make_reader(), start, stop
+        )
+        assert_array_equal(array_offsets, np.cumsum([0] + sizes[start:stop]))
+        assert_array_equal(array_values, np.concatenate([[], *values[start:stop]]))
+
+    if backend == "cpp":
+        expected = readers.read_data(data, offsets, 0, make_reader())
+        decoder = readers.ChunkedDecoder(make_reader(), offsets, 0)
+        buffer = memoryview(data.tobytes())
+        for window in range(0, len(buffer), 20):
+            decoder.feed(buffer[window : window + 20])
+        for r, e in zip(decoder.finish(), expected):
+            assert_array_equal(r, e)
+
+
+def make_pointer_basket(entries, with_size=False):
+    """
+    Serialize int32 objects of class `Obj` written through pointers, one list of pointers
+    per entry. A pointer is `("new", value, byte_count)` for an object of a new class,
+    `("obj", value, class_tag, byte_count)` for an object of a known class, `("ref", tag)`
+    for an object already written, or `("null",)`. With `with_size`, each entry starts
+    with its number of pointers, as a `std::vector` without header.
+    """
+
+    def u4(value):
+        return np.array([value], dtype=">u4").tobytes()
+
+    def with_byte_count(body, byte_count):
+        return u4(0x40000000 | len(body)) + body if byte_count else body
+
+    chunks = []
+    for pointers in entries:
+        chunk = u4(len(pointers)) if with_size else b""
+        for kind, *args in pointers:
+            if kind == "new":
+                value, byte_count = args
+                body = u4(0xFFFFFFFF) + b"Obj\0" + np.array([value], ">i4").tobytes()
+                chunk += with_byte_count(body, byte_count)
+            elif kind == "obj":
+                value, class_tag, byte_count = args
+                body = u4(0x80000000 | class_tag) + np.array([value], ">i4").tobytes()
+                chunk += with_byte_count(body, byte_count)
+            elif kind == "ref":
+                chunk += u4(args[0])
+            else:
+                chunk += u4(0)
+        chunks.append(chunk)
+
+    data = np.frombuffer(b"".join(chunks), dtype=np.uint8)
+    offsets = np.cumsum([0] + [len(c) for c in chunks], dtype=np.uint32)
+    return data, offsets
+
+
+@pytest.mark.parametrize("backend", ["cpp", "python"])
+def test_read_pointer_entry_range(backend, monkeypatch):
+    from uproot_custom.factories import AnyPointerFactory, PrimitiveFactory
+
+    monkeypatch.setattr(uproot_custom.factories, "reader_backend", backend)
+    factory = AnyPointerFactory("p", PrimitiveFactory("x", "int32"))
+
+    # entry 1 refers to the object of entry 0, registered at its byte count position
+    data, offsets = make_pointer_basket([[("new", 10, True)], [("ref", 2)], [("null",)]])
+    content = uproot_custom.factories.read_branch(
+        None, data, offsets, 0, {}, {}, factory=factory, entry_start=1
+    )
+    assert ak.Array(content).tolist() == [10, None]
+
+    content = uproot_custom.factories.read_branch(
+        None, data, offsets, 0, {}, {}, factory=factory, entry_start=1, entry_stop=2
+    )
+    assert ak.Array(content).tolist() == [10]
+
+    if backend == "cpp":
+        baskets = [(data, offsets, 0, 1, -1), (data, offsets, 0, 0, 2)]
+        content = uproot_custom.factories.read_branch_concat(baskets, factory)
+        assert ak.Array(content).tolist() == [10, None, 10, 10]
+
+
+@pytest.mark.parametrize("backend", ["cpp", "python"])
+@pytest.mark.parametrize("reset_refs", [False, True])
+def test_read_pointer_reset_refs(backend, reset_refs, monkeypatch):
+    from uproot_custom.factories import AnyPointerFactory, PrimitiveFactory, STLSeqFactory
+
+    monkeypatch.setattr(uproot_custom.factories, "reader_backend", backend)
+    pointer = AnyPointerFactory("p", PrimitiveFactory("x", "int32"), reset_refs)
+    factory = STLSeqFactory("v", False, -1, pointer)
+
+    # objects without byte count are tagged by the number of references so far (class 1
+    # and object 2 in entry 0, object 3 in entry 1), also when the references of previous
+    # entries are discarded
+    data, offsets = make_pointer_basket(
+        [[("new", 10, False), ("ref", 2)], [("obj", 20, 1, False), ("ref", 3), ("null",)]],
+        with_size=True,
+    )
+    content = uproot_custom.factories.read_branch(
+        None, data, offsets, 0, {}, {}, factory=factory
+    )
+    assert ak.Array(content).tolist() == [[10, 10], [20, 20, None]]
+
+
+@pytest.mark.parametrize("backend", ["cpp", "python"])
+def test_read_pointer_mixed_byte_counts(backend, monkeypatch):
+    from uproot_custom.factories import AnyPointerFactory, PrimitiveFactory, STLSeqFactory
+
+    monkeypatch.setattr(uproot_custom.factories, "reader_backend", backend)
+    pointer = AnyPointerFactory("p", PrimitiveFactory("x", "int32"))
+    factory = STLSeqFactory("v", False, -1, pointer)
+
+    # objects with a byte count are tagged by its position + 2, the others by the number
+    # of references so far: class 1 and object 2 at 4, object 18 at 16, then object 4 at
+    # 40 and object 50 at 48 in the second entry
+    data, offsets = make_pointer_basket(
+        [
+            [("new", 10, False), ("obj", 20, 1, True), ("ref", 2), ("ref", 18)],
+            [
+                ("obj", 30, 1, False),
+                ("obj", 40, 1, True),
+                ("ref", 4),
+                ("ref", 50),
+                ("ref", 18),
+                ("ref", 2),
+                ("null",),
+            ],
+        ],
+        with_size=True,
+    )
+    content = uproot_custom.factories.read_branch(
+        None, data, offsets, 0, {}, {}, factory=factory
+    )
+    assert ak.Array(content).tolist() == [[10, 20, 10, 20], [30, 40, 30, 40, 20, 10, None]]
+
+    content = uproot_custom.factories.read_branch(
+        None, data, offsets, 0, {}, {}, factory=factory, entry_start=1
+    )
+    assert ak.Array(content).tolist() == [[30, 40, 30, 40, 20, 10, None]]
+
+
+def make_projected_object_basket(n_entries):
+    """
+    Serialize one object per entry with members `m_int` (int32), `m_double` (float64),
+    `m_inner` (a class holding an int16) and `m_vec` (`std::vector<double>`).
+    """
+
+    def with_header(body, version=1):
+        header = np.array([0x40000000 | (2 + len(body))], dtype=">u4").tobytes()
+        return header + np.array([version], dtype=">u2").tobytes() + body
+
+    entries = []
+    for i in range(n_entries):
+        inner = with_header(np.array([-i], dtype=">i2").tobytes())
+        vec = with_header(
+            np.array([i], dtype=">u4").tobytes() + np.arange(i, dtype=">f8").tobytes(), 9
+        )
+        body = np.array([i], dtype=">i4").tobytes() + np.array([i / 2], dtype=">f8").tobytes()
+        entries.append(with_header(body + inner + vec))
+
+    data = np.frombuffer(b"".join(entries), dtype=np.uint8)
+    offsets = np.cumsum([0] + [len(e) for e in entries], dtype=np.uint32)
+    return data, offsets
+
+
+@pytest.mark.parametrize("backend", ["cpp", "python"])
+def test_empty_factory_skips_members(backend):
+    from uproot_custom.factories import (
+        AnyClassFactory,
+        EmptyFactory,
+        PrimitiveFactory,
+        STLSeqFactory,
+    )
+
+    skipped = [
+        EmptyFactory("m_double", PrimitiveFactory("m_double", "float64")),
+        EmptyFactory("m_inner", AnyClassFactory("m_inner", [PrimitiveFactory("x", "int16")])),
+        EmptyFactory(
+            "m_vec", STLSeqFactory("m_vec", True, -1, PrimitiveFactory("m_vec", "float64"))
+        ),
+    ]
+    assert [s.element_size for s in skipped] == [8, 0, 0]
+    assert [s.jump_by_byte_count for s in skipped] == [False, True, True]
+    assert [s.shared_byte_count for s in skipped] == [False, False, True]
+
+    factory = AnyClassFactory("obj", [PrimitiveFactory("m_int", "int32"), *skipped])
+    data, offsets = make_projected_object_basket(5)
+
+    reader = getattr(factory, f"build_{backend}_reader")()
+    raw = getattr(uproot_custom.readers, backend).read_data(data, offsets, 0, reader)
+    arr = ak.Array(factory.make_awkward_content(raw))
+
+    assert arr.fields == ["m_int"]
+    assert arr.m_int.tolist() == [0, 1, 2, 3, 4]
+    assert factory.make_awkward_form().fields == ["m_int"]
+
+
+@pytest.mark.parametrize("backend", ["cpp", "python"])
+def test_empty_reader_shared_byte_count(backend):
+    from uproot_custom.factories import PrimitiveFactory, STLSeqFactory
+
+    readers = getattr(uproot_custom.readers, backend)
+
+    def make_empty_reader(element_reader):
+        if backend == "cpp":
+            return readers.EmptyReader("skip", element_reader, True, True)
+        return readers.EmptyReader(
+            "skip",
+            element_reader=element_reader,
+            jump_by_byte_count=True,
+            shared_byte_count=True,
+        )
+
+    # the number of elements sharing the byte count is only known by parsing them
+    with pytest.raises((RuntimeError, ValueError), match="requires an element reader"):
+        make_empty_reader(None)
+
+    # jagged arrays of `std::vector<double>` sharing one header per entry
+    counts = [2, 0, 1]
+    entries = []
+    for n in counts:
+        bodies = b"".join(
+            np.array([i], dtype=">u4").tobytes() + np.arange(i, dtype=">f8").tobytes()
+            for i in range(1, n + 1)
+        )
+        header = np.array([0x40000000 | (2 + len(bodies))], dtype=">u4").tobytes()
+        entries.append(header + np.array([9], dtype=">u2").tobytes() + bodies if n else b"")
+    data = np.frombuffer(b"".join(entries), dtype=np.uint8)
+    offsets = np.cumsum([0] + [len(e) for e in entries], dtype=np.uint32)
+
+    element_factory = STLSeqFactory("v", True, -1, PrimitiveFactory("x", "float64"))
+    element_reader = getattr(element_factory, f"build_{backend}_reader")()
+    reader = readers.CStyleArrayReader("arr", -1, make_empty_reader(element_reader))
+    array_offsets, _ = readers.read_data(data, offsets, 0, reader)
+    assert_array_equal(array_offsets, np.cumsum([0] + counts))
+
+
+def test_any_class_filter_itempaths(monkeypatch):
+    keeps_member = uproot_custom.factories.AnyClassFactory.keeps_member
+    monkeypatch.setattr(
+        uproot_custom.factories.AnyClassFactory,
+        "filter_itempaths",
+        {"/tree:branch.m_obj.m_x", "/tree:branch.m_v*"},
+    )
+
+    assert keeps_member("/tree:branch", "/tree:branch.m_obj")
+    assert keeps_member("/tree:branch", "/tree:branch.m_vec")
+    assert not keeps_member("/tree:branch", "/tree:branch.m_int")
+    assert keeps_member("/tree:branch.m_obj", "/tree:branch.m_obj.m_x")
+    assert not keeps_member("/tree:branch.m_obj", "/tree:branch.m_obj.m_y")
+
+    # classes without listed members are read in full
+    assert keeps_member("/tree:other", "/tree:other.m_int")
+    assert keeps_member("/tree:branch.m_vec", "/tree:branch.m_vec.m_y")
+
+
+def test_lazy_class_content():
+    from uproot_custom.factories import AnyClassFactory, PrimitiveFactory, STLSeqFactory
+    from uproot_custom.lazy import index_basket, lazy_class_content, supports_lazy_decoding
+
+    factory = AnyClassFactory(
+        "obj",
+        [
+            PrimitiveFactory("m_int", "int32"),
+            PrimitiveFactory("m_double", "float64"),
+            AnyClassFactory("m_inner", [PrimitiveFactory("x", "int16")]),
+            STLSeqFactory("m_vec", True, -1, PrimitiveFactory("m_vec", "float64")),
+        ],
+    )
+    assert supports_lazy_decoding(factory)
+
+    data, offsets = make_projected_object_basket(6)
+    basket = index_basket(data, offsets, 0, factory)
+    assert len(basket) == 6
+    assert_array_equal(basket.positions[0], offsets[:-1] + 6)  # fNBytes + fVersion
+    assert_array_equal(basket.positions[-1], offsets[1:])
+
+    raw = uproot_custom.readers.cpp.read_data(data, offsets, 0, factory.build_cpp_reader())
+    expected = ak.Array(factory.make_awkward_content(raw)).tolist()
+
+    lazy = ak.Array(lazy_class_content(factory, [(basket, 1, 6), (basket, 0, 2)]))
+    assert lazy.fields == ["m_int", "m_double", "m_inner", "m_vec"]
+    assert lazy.m_vec.tolist() == [e["m_vec"] for e in expected[1:] + expected[:2]]
+    assert lazy.tolist() == expected[1:] + expected[:2]
+
+
+def test_read_branch_arrow():
+    pa = pytest.importorskip("pyarrow")
+    from uproot_custom.factories import (
+        AnyClassFactory,
+        EmptyFactory,
+        PrimitiveFactory,
+        STLSeqFactory,
+    )
+
+    factory = AnyClassFactory(
+        "obj",
+        [
+            PrimitiveFactory("m_int", "int32"),
+            EmptyFactory("m_double", PrimitiveFactory("m_double", "float64")),
+            AnyClassFactory("m_inner", [PrimitiveFactory("x", "int16")]),
+            STLSeqFactory("m_vec", True, -1, PrimitiveFactory("m_vec", "float64")),
+        ],
+    )
+    assert factory.make_arrow_spec() == (
+        "struct",
+        [
+            ("m_int", ("primitive", "i")),
+            ("m_double", None),
+            ("m_inner", ("struct", [("x", ("primitive", "s"))])),
+            ("m_vec", ("list", 1, ("primitive", "g"))),
+        ],
+    )
+
+    data, offsets = make_projected_object_basket(5)
+    exported = uproot_custom.factories.read_branch_arrow(
+        None, data, offsets, 0, {}, {}, factory=factory
+    )
+    arrow_array = pa.array(exported)
+    assert len(exported) == len(arrow_array) == 5
+    assert arrow_array.type.field("m_vec").type == pa.large_list(pa.float64())
+
+    raw = uproot_custom.readers.cpp.read_data(data, offsets, 0, factory.build_cpp_reader())
+    expected = ak.Array(factory.make_awkward_content(raw))
+    assert ak.from_arrow(arrow_array).tolist() == expected.tolist()
+
+
+def test_read_branch_arrow_counts():
+    pa = pytest.importorskip("pyarrow")
+    from uproot_custom.factories import PrimitiveFactory, STLSeqFactory
+
+    sizes = [2, 0, 3, 1]
+    data, offsets = make_vector_double_basket(sizes)
+    try:
+        uproot_custom.factories.set_offsets_format("i32", counts=True)
+        factory = STLSeqFactory("vec", True, -1, PrimitiveFactory("x", "float64"))
+        exported = uproot_custom.factories.read_branch_arrow(
+            None, data, offsets, 0, {}, {}, factory=factory
+        )
+        arrow_array = pa.array(exported)
+    finally:
+        uproot_custom.factories.set_offsets_format()
+
+    assert arrow_array.to_pylist() == [list(range(n)) for n in sizes]
+
+
+def test_cpp_pod_class_reader_memberwise():
+    cpp = uproot_custom.readers.cpp
+    sizes = [3, 0, 2]
+    columns = [("a", ">i4"), ("b", ">f8"), ("c", ">u2"), ("d", ">i1")]
+
+    entries = []
+    for i, n in enumerate(sizes):
+        blocks = b"".join(np.arange(i, i + n, dtype=t).tobytes() for _, t in columns)
+        body = np.array([0x4000 | 9, 1], dtype=">u2").tobytes()  # member-wise, element version
+        body += np.array([n], dtype=">u4").tobytes() + blocks
+        entries.append(np.array([0x40000000 | len(body)], dtype=">u4").tobytes() + body)
+    data = np.frombuffer(b"".join(entries), dtype=np.uint8)
+    offsets = np.cumsum([0] + [len(e) for e in entries], dtype=np.uint32)
+
+    def make_reader(pod):
+        if pod:
+            element = cpp.PODClassReader("obj", ["int32", "", "uint16", "int8"], [4, 8, 2, 1])
+        else:
+            element = cpp.AnyClassReader(
+                "obj",
+                [
+                    cpp.Int32Reader("a"),
+                    cpp.EmptyReader("b", 8),
+                    cpp.UInt16Reader("c"),
+                    cpp.Int8Reader("d"),
+                ],
+            )
+        return cpp.STLSeqReader("vec", True, -1, element)
+
+    pod_offsets, pod_data = cpp.read_data(data, offsets, 0, make_reader(True))
+    exp_offsets, exp_data = cpp.read_data(data, offsets, 0, make_reader(False))
+
+    assert_array_equal(pod_offsets, exp_offsets)
+    assert pod_data[1] is None and exp_data[1] is None
+    for i in (0, 2, 3):
+        assert pod_data[i].dtype == exp_data[i].dtype
+        assert_array_equal(pod_data[i], exp_data[i])
+    assert_array_equal(pod_data[0], [0, 1, 2, 2, 3])
+
+
+def test_cpp_stl_map_reader_primitive_pairs():
+    cpp = uproot_custom.readers.cpp
+    maps = [{1: 0.5, 2: -1.0}, {}, {-7: 3.25, 0: 0.0, 9: 1e10}]
+
+    entries = []
+    for m in maps:
+        pairs = np.array(list(m.items()), dtype=[("k", ">i4"), ("v", ">f8")]).tobytes()
+        body = np.array([9, 1], dtype=">u2").tobytes()  # object-wise, element version
+        body += np.array([len(m)], dtype=">u4").tobytes() + pairs
+        entries.append(np.array([0x40000000 | len(body)], dtype=">u4").tobytes() + body)
+    data = np.frombuffer(b"".join(entries), dtype=np.uint8)
+    offsets = np.cumsum([0] + [len(e) for e in entries], dtype=np.uint32)
+
+    reader = cpp.STLMapReader("map", True, 0, cpp.Int32Reader("k"), cpp.DoubleReader("v"))
+    map_offsets, keys, values = cpp.read_data(data, offsets, 0, reader)
+
+    assert_array_equal(map_offsets, np.cumsum([0] + [len(m) for m in maps]))
+    assert keys.dtype == np.int32 and values.dtype == np.float64
+    assert_array_equal(keys, [k for m in maps for k in m])
+    assert_array_equal(values, [v for m in maps for v in m.values()])
+
+
+def test_static_reader_matches_virtual():
+    _testing = pytest.importorskip("uproot_custom._testing")
+    cpp = uproot_custom.readers.cpp
+
+    def tstring(text):
+        if len(text) < 255:
+            return bytes([len(text)]) + text
+        return b"\xff" + np.array([len(text)], dtype=">u4").tobytes() + text
+
+    vectors = [[{1: b"a", -2: b""}], [], [{}, {7: b"x" * 300, 8: b"yz", 9: b"w"}]]
+    entries = []
+    for vec in vectors:
+        body = np.array([9], dtype=">u2").tobytes()
+        body += np.array([len(vec)], dtype=">u4").tobytes()
+        for m in vec:
+            body += np.array([len(m)], dtype=">u4").tobytes()
+            for key, value in m.items():
+                body += np.array([key], dtype=">i4").tobytes() + tstring(value)
+        entries.append(np.array([0x40000000 | len(body)], dtype=">u4").tobytes() + body)
+    data = np.frombuffer(b"".join(entries), dtype=np.uint8)
+    offsets = np.cumsum([0] + [len(e) for e in entries], dtype=np.uint32)
+
+    map_reader = cpp.STLMapReader(
+        "map", False, 0, cpp.Int32Reader("k"), cpp.STLStringReader("v", False)
+    )
+    virtual = cpp.STLSeqReader("vec", True, 0, map_reader)
+    expected = cpp.read_data(data, offsets, 0, virtual)
+    actual = cpp.read_data(data, offsets, 0, _testing.StaticVecMapReader("vec"))
+    assert_raw_data_equal(actual, expected)
+
+    vec_offsets, (map_offsets, keys, (value_offsets, values)) = actual
+    assert_array_equal(vec_offsets, [0, 1, 1, 3])
+    assert_array_equal(map_offsets, [0, 2, 2, 5])
+    assert_array_equal(keys, [1, -2, 7, 8, 9])
+    assert_array_equal(value_offsets, [0, 1, 1, 301, 303, 304])
+    assert values.tobytes() == b"a" + b"x" * 300 + b"yzw"
+
+
+def assert_raw_data_equal(actual, expected):
+    if isinstance(expected, np.ndarray):
+        assert actual.dtype == expected.dtype
+        assert_array_equal(actual, expected)
+    elif isinstance(expected, (list, tuple)):
+        assert type(actual) is type(expected) and len(actual) == len(expected)
+        for a, e in zip(actual, expected):
+            assert_raw_data_equal(a, e)
+    else:
+        assert actual == expected
+
+
+def make_plan_basket(n_entries):
+    """
+    Serialize one `{int a; vector<P> v; string s; TString t;}` object per entry, with
+    `struct P {int x; float y;}` streamed member-wise, returns `(data, offsets)`.
+    """
+    entries = []
+    for i in range(n_entries):
+        n = i % 3
+        vec = np.array([0x4000 | 9, 1], dtype=">u2").tobytes()  # member-wise, P version
+        vec += np.array([n], dtype=">u4").tobytes()
+        vec += np.arange(n, dtype=">i4").tobytes()
+        vec += np.linspace(0, 1, n, dtype=">f4").tobytes()
+
+        body = np.array([1], dtype=">u2").tobytes() + np.array([i], dtype=">i4").tobytes()
+        body += np.array([0x40000000 | len(vec)], dtype=">u4").tobytes() + vec
+        for text in [b"s" * i, b"t" * n]:
+            body += bytes([len(text)]) + text
+        entries.append(np.array([0x40000000 | len(body)], dtype=">u4").tobytes() + body)
+
+    data = np.frombuffer(b"".join(entries), dtype=np.uint8)
+    offsets = np.cumsum([0] + [len(e) for e in entries], dtype=np.uint32)
+    return data, offsets
+
+
+def test_plan_reader_matches_cpp():
+    fac = uproot_custom.factories
+    factory = fac.AnyClassFactory(
+        "C",
+        [
+            fac.PrimitiveFactory("a", "int32"),
+            fac.STLSeqFactory(
+                "v",
+                True,
+                -1,
+                fac.AnyClassFactory(
+                    "P",
+                    [fac.PrimitiveFactory("x", "int32"), fac.PrimitiveFactory("y", "float32")],
+                ),
+            ),
+            fac.STLStringFactory("s", False),
+            fac.TStringFactory("t", False),  # not lowered, read by its C++ reader
+        ],
+    )
+    data, offsets = make_plan_basket(7)
+
+    reader, template = uproot_custom.readers.plan.build_reader(factory)
+    actual = uproot_custom.readers.plan.read_data(data, offsets, 0, reader, template, 2, 6)
+    expected = uproot_custom.readers.cpp.read_data(
+        data, offsets, 0, factory.build_cpp_reader(), 2, 6
+    )
+    assert_raw_data_equal(actual, expected)
+
+    # the vector does not accept member-wise data
+    factory.sub_factories[1].objwise_or_memberwise = 0
+    reader, template = uproot_custom.readers.plan.build_reader(factory)
+    with pytest.raises(RuntimeError, match="Expect obj-wise, got member-wise"):
+        uproot_custom.readers.plan.read_data(data, offsets, 0, reader, template)
@@ -7,13 +7,67 @@ import uproot.behaviors.TBranch
 import uproot.interpretation.custom
 from uproot.behaviors.TBranch import _branch_clean_name
 
-from uproot_custom.factories import read_branch, read_branch_awkward_form
+import uproot_custom.factories
+from uproot_custom.cache import DecodedCache, factory_fingerprint
+from uproot_custom.compression import read_basket_payload
+from uproot_custom.distributed import ReaderPlan
+from uproot_custom.factories import (
+    Factory,
+    build_factory,
+    read_branch,
+    read_branch_chunked,
+    read_branch_compressed,
+    read_branch_raw,
+    read_branch_concat,
+    regularize_basket_offsets,
+)
+from uproot_custom.lazy import (
+    LazyBasket,
+    index_basket,
+    lazy_class_content,
+    supports_lazy_decoding,
+)
 from uproot_custom.utils import get_dims_from_branch, regularize_object_path
 
 
+class RawBasket:
+    """
+    Undecoded basket data, returned by `AsCustom.basket_array` when
+    `AsCustom.share_basket_buffers` is enabled. All baskets are decoded together in
+    `AsCustom.final_array`.
+    """
+
+    def __init__(self, data: np.ndarray, offsets: np.ndarray, cursor_offset: int):
+        self.data = data
+        self.offsets = offsets
+        self.cursor_offset = cursor_offset
+
+    def __len__(self) -> int:
+        return len(self.offsets) - 1
+
+
 class AsCustom(uproot.interpretation.custom.CustomInterpretation):
     target_branches: set[str] = set()
 
+    # With the C++ backend, decode all baskets of a read into one set of output buffers
+    # in `final_array`, instead of decoding each basket separately and concatenating them.
+    share_basket_buffers: bool = False
+
+    # Cache of decoded baskets shared by all interpretations, e.g.
+    # `DecodedCache(2 * 1024**3, spill_dir="/tmp/decoded")`. Baskets found in the cache
+    # are not decoded again, see `uproot_custom.cache`.
+    decoded_cache: DecodedCache | None = None
+
+    # With the C++ backend, only index the members of class branches when reading
+    # baskets, and decode each member when it is first accessed, see `uproot_custom.lazy`.
+    lazy_decoding: bool = False
+
+    # With the C++ backend, decode each basket in chunks of entries on up to this many
+    # threads, see `read_branch_chunked`. If not positive, uses the number of CPUs.
+    # Chunks are at least `intra_basket_chunk_bytes` large, so small baskets stay serial.
+    intra_basket_threads: int = 1
+    intra_basket_chunk_bytes: int = 4 * 1024**2
+
     def __init__(
         self,
         branch: uproot.behaviors.TBranch.TBranch,
@@ -66,6 +120,12 @@ class AsCustom(uproot.interpretation.custom.CustomInterpretation):
             cur_infos = [i.all_members for i in next(iter(v.values())).member("fElements")]
             self.all_streamer_info[k] = cur_infos
 
+        # built lazily and shared by all baskets, see `factory`
+        self._factory: Factory | None = None
+        self._cache_key: str | None = None
+        self._cpp_reader_pool: list = []
+        self._plan_pool: list = []
+
     @classmethod
     def match_branch(
         cls,
@@ -110,9 +170,87 @@ class AsCustom(uproot.interpretation.custom.CustomInterpretation):
     @property
     def cache_key(self) -> str:
         """
-        The cache key of the interpretation.
+        The cache key of the interpretation. It is derived from the factory, so that
+        interpretations reading a branch the same way share cached arrays, also across
+        files and processes.
+        """
+        if self._cache_key is None:
+            self._cache_key = f"{self!r}:{factory_fingerprint(self.factory)}"
+        return self._cache_key
+
+    def decoded_cache_key(self, basket_num: int) -> str:
+        """
+        The key of a basket of the branch in `decoded_cache`.
+        """
+        branch_path = regularize_object_path(self._branch.object_path)
+        return f"{self._branch.file.uuid}:{branch_path}:{basket_num}:{self.cache_key}"
+
+    @property
+    def cls_streamer_info(self) -> dict:
+        """
+        The streamer information of the branch's top-level item.
+        """
+        if self._branch.streamer is None:
+            return {
+                "fName": self._branch.name,
+                "fTypeName": self.typename,
+            }
+        else:
+            return self._branch.streamer.all_members
+
+    @property
+    def factory(self) -> Factory:
+        """
+        The factory of the branch. It is built on first access and reused for all
+        baskets. Call `clear_cache` to rebuild it, e.g. after changing factory
+        options such as `TObjectFactory.keep_data_itempaths`.
+        """
+        if self._factory is None:
+            self._factory = build_factory(
+                self.cls_streamer_info,
+                self.all_streamer_info,
+                regularize_object_path(self._branch.object_path),
+                called_from_top=True,
+                branch=self._branch,
+            )
+        return self._factory
+
+    @property
+    def reader_plan(self) -> ReaderPlan:
+        """
+        The picklable plan of `factory`, to decode baskets of the branch in other
+        processes without their streamer information, see `uproot_custom.distributed`.
+        """
+        return ReaderPlan(self.factory)
+
+    def clear_cache(self) -> None:
+        """
+        Discard the cached factory and the idle C++ readers built from it.
+        """
+        self._factory = None
+        self._cache_key = None
+        self._cpp_reader_pool = []
+        self._plan_pool = []
+
+    def fused_basket_array(self, basket_num: int) -> ak.Array:
         """
-        return id(self)
+        Read a basket of the branch, decompressing and decoding it in one pass with the
+        C++ backend. Unlike reading through uproot, the whole decompressed basket is never
+        held in memory (except for LZ4 blocks), see
+        `uproot_custom.factories.read_branch_compressed`.
+
+        Args:
+            basket_num (int): Index of the basket in the branch.
+        """
+        payload = read_basket_payload(self._branch, basket_num)
+        return ak.Array(
+            read_branch_compressed(
+                payload,
+                self.factory,
+                self.cls_streamer_info,
+                cpp_reader_pool=self._cpp_reader_pool,
+            )
+        )
 
     def __repr__(self) -> str:
         """
@@ -140,6 +278,30 @@ class AsCustom(uproot.interpretation.custom.CustomInterpretation):
         basket_end_idx = np.where(basket_entry_stops >= entry_stop)[0].min()
 
         arr_to_concat = [basket_arrays[i] for i in range(basket_start_idx, basket_end_idx + 1)]
+
+        # entry range of each basket, for baskets decoded here
+        local_ranges = []
+        for i in range(basket_start_idx, basket_end_idx + 1):
+            local_start = max(entry_start - basket_entry_starts[i], 0)
+            local_stop = min(entry_stop, basket_entry_stops[i]) - basket_entry_starts[i]
+            local_ranges.append((int(local_start), int(local_stop)))
+
+        if all(isinstance(arr, RawBasket) for arr in arr_to_concat):
+            # decode only the requested entries of each basket, nothing to slice afterwards
+            baskets = [
+                (arr.data, arr.offsets, arr.cursor_offset, start, stop)
+                for arr, (start, stop) in zip(arr_to_concat, local_ranges)
+            ]
+            return ak.Array(
+                read_branch_concat(baskets, self.factory, cpp_reader_pool=self._cpp_reader_pool)
+            )
+
+        if all(isinstance(arr, LazyBasket) for arr in arr_to_concat):
+            baskets = [
+                (arr, start, stop) for arr, (start, stop) in zip(arr_to_concat, local_ranges)
+            ]
+            return ak.Array(lazy_class_content(self.factory, baskets))
+
         tot_array = ak.concatenate(arr_to_concat)
 
         relative_entry_start = entry_start - basket_entry_starts[basket_start_idx]
@@ -161,24 +323,59 @@ class AsCustom(uproot.interpretation.custom.CustomInterpretation):
         assert library.name == "ak", "Only awkward arrays are supported"
         assert branch is self._branch, "Branch mismatch"
 
-        full_branch_path = regularize_object_path(self._branch.object_path)
+        if self.decoded_cache is not None:
+            key = self.decoded_cache_key(basket.basket_num)
+            raw_data = self.decoded_cache.get(key)
+            if raw_data is None:
+                raw_data = read_branch_raw(
+                    self._branch,
+                    data,
+                    byte_offsets,
+                    cursor_offset,
+                    self.cls_streamer_info,
+                    self.all_streamer_info,
+                    factory=self.factory,
+                    cpp_reader_pool=self._cpp_reader_pool,
+                    plan_pool=self._plan_pool,
+                )
+                self.decoded_cache.put(key, raw_data)
+            return self.factory.make_awkward_content(raw_data)
 
-        if self._branch.streamer is None:
-            cls_streamer_info = {
-                "fName": self._branch.name,
-                "fTypeName": self.typename,
-            }
-        else:
-            cls_streamer_info = self._branch.streamer.all_members
+        if (
+            self.lazy_decoding
+            and uproot_custom.factories.reader_backend == "cpp"
+            and supports_lazy_decoding(self.factory)
+        ):
+            offsets = regularize_basket_offsets(data, byte_offsets, self.cls_streamer_info)
+            return index_basket(data, offsets, cursor_offset, self.factory)
+
+        if self.share_basket_buffers and uproot_custom.factories.reader_backend == "cpp":
+            offsets = regularize_basket_offsets(data, byte_offsets, self.cls_streamer_info)
+            return RawBasket(data, offsets, cursor_offset)
+
+        if self.intra_basket_threads != 1 and uproot_custom.factories.reader_backend == "cpp":
+            offsets = regularize_basket_offsets(data, byte_offsets, self.cls_streamer_info)
+            return read_branch_chunked(
+                data,
+                offsets,
+                cursor_offset,
+                self.factory,
+                self.intra_basket_threads,
+                self.intra_basket_chunk_bytes,
+                cpp_reader_pool=self._cpp_reader_pool,
+            )
 
         return read_branch(
             self._branch,
             data,
             byte_offsets,
             cursor_offset,
-            cls_streamer_info,
+            self.cls_streamer_info,
             self.all_streamer_info,
-            full_branch_path,
+            regularize_object_path(self._branch.object_path),
+            factory=self.factory,
+            cpp_reader_pool=self._cpp_reader_pool,
+            plan_pool=self._plan_pool,
         )
 
     def awkward_form(
@@ -191,20 +388,4 @@ class AsCustom(uproot.interpretation.custom.CustomInterpretation):
         breadcrumbs=(),
     ):
         assert file is self._branch.file, "File mismatch"
-
-        full_branch_path = regularize_object_path(self._branch.object_path)
-
-        if self._branch.streamer is None:
-            cls_streamer_info = {
-                "fName": self._branch.name,
-                "fTypeName": self.typename,
-            }
-        else:
-            cls_streamer_info = self._branch.streamer.all_members
-
-        return read_branch_awkward_form(
-            self._branch,
-            cls_streamer_info,
-            self.all_streamer_info,
-            full_branch_path,
-        )
+        return self.factory.make_awkward_form()
@@ -0,0 +1,285 @@
+"""
+Cache of decoded baskets, so that branches read repeatedly are only decoded once.
+
+The cache stores the raw output of the readers (`IReader.data()`), i.e. nested lists and
+tuples of numpy arrays, before it is turned into awkward contents. Entries are evicted in
+least-recently-used order once the cache holds more than `max_bytes`. With a `spill_dir`,
+evicted entries are written to disk, and read back with `mmap` instead of being decoded
+again. Spilled files are kept across processes, so they are found by later runs too.
+
+A spilled file holds:
+
+- the magic bytes `UCDC0001`;
+- the size of the header (uint64, little-endian);
+- the header, a JSON description of the nested structure and of each array;
+- the array buffers, each aligned to 64 bytes.
+"""
+
+from __future__ import annotations
+
+import hashlib
+import json
+import mmap
+import os
+import threading
+from collections import OrderedDict
+from pathlib import Path
+from typing import Any, Union
+
+import numpy as np
+
+from uproot_custom.factories import Factory
+
+MAGIC = b"UCDC0001"
+ALIGNMENT = 64
+
+
+def raw_data_nbytes(raw_data: Any) -> int:
+    """
+    Total size of the numpy arrays in a reader output.
+    """
+    if isinstance(raw_data, np.ndarray):
+        return raw_data.nbytes
+    if isinstance(raw_data, (list, tuple)):
+        return sum(raw_data_nbytes(i) for i in raw_data)
+    return 0
+
+
+def _describe(raw_data: Any, arrays: list[np.ndarray]) -> Any:
+    if isinstance(raw_data, np.ndarray):
+        if raw_data.dtype.hasobject or raw_data.dtype.names is not None:
+            raise TypeError(f"Arrays of {raw_data.dtype} cannot be spilled to disk.")
+        arrays.append(np.ascontiguousarray(raw_data))
+        return {"array": len(arrays) - 1}
+    if isinstance(raw_data, list):
+        return {"list": [_describe(i, arrays) for i in raw_data]}
+    if isinstance(raw_data, tuple):
+        return {"tuple": [_describe(i, arrays) for i in raw_data]}
+    if isinstance(raw_data, dict) and all(isinstance(k, str) for k in raw_data):
+        return {"dict": {k: _describe(v, arrays) for k, v in raw_data.items()}}
+    if raw_data is None or isinstance(raw_data, (bool, int, float, str)):
+        return {"value": raw_data}
+    if isinstance(raw_data, np.generic):
+        return {"value": raw_data.item()}
+    raise TypeError(f"Cannot spill {type(raw_data).__name__} to disk.")
+
+
+def _rebuild(node: dict, arrays: list[np.ndarray]) -> Any:
+    if "array" in node:
+        return arrays[node["array"]]
+    if "list" in node:
+        return [_rebuild(i, arrays) for i in node["list"]]
+    if "tuple" in node:
+        return tuple(_rebuild(i, arrays) for i in node["tuple"])
+    if "dict" in node:
+        return {k: _rebuild(v, arrays) for k, v in node["dict"].items()}
+    return node["value"]
+
+
+def _aligned(n: int) -> int:
+    return (n + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+
+
+def save_raw_data(path: Union[str, Path], raw_data: Any) -> None:
+    """
+    Write a reader output to `path`, see the module documentation for the layout. Besides
+    numpy arrays, Python scalars, lists, tuples and dicts with string keys are stored.
+    """
+    arrays: list[np.ndarray] = []
+    tree = _describe(raw_data, arrays)
+
+    # the offsets are part of the header, so place the buffers until the header fits
+    specs = [{"dtype": a.dtype.str, "shape": list(a.shape), "offset": 0} for a in arrays]
+    data_start = 0
+    while True:
+        offset = data_start
+        for spec, a in zip(specs, arrays):
+            spec["offset"] = offset
+            offset = _aligned(offset + a.nbytes)
+
+        header = json.dumps({"tree": tree, "arrays": specs}).encode()
+        header_end = _aligned(len(MAGIC) + 8 + len(header))
+        if header_end <= data_start:
+            break
+        data_start = header_end
+
+    path = Path(path)
+    tmp_path = path.with_name(f"{path.name}.{os.getpid()}.{threading.get_ident()}.tmp")
+    with open(tmp_path, "wb") as f:
+        f.write(MAGIC)
+        f.write(len(header).to_bytes(8, "little"))
+        f.write(header)
+        for spec, a in zip(specs, arrays):
+            f.seek(spec["offset"])
+            f.write(a.tobytes())
+        f.truncate(offset)
+    os.replace(tmp_path, path)
+
+
+def load_raw_data(path: Union[str, Path]) -> Any:
+    """
+    Map a file written by `save_raw_data` into memory. The arrays are copy-on-write views
+    of the file, changing them does not change the file.
+    """
+    with open(path, "rb") as f:
+        buffer = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_COPY)
+
+    if buffer[: len(MAGIC)] != MAGIC:
+        raise ValueError(f"{path} is not a decoded basket file.")
+
+    header_size = int.from_bytes(buffer[len(MAGIC) : len(MAGIC) + 8], "little")
+    header_start = len(MAGIC) + 8
+    header = json.loads(buffer[header_start : header_start + header_size])
+
+    arrays = []
+    for spec in header["arrays"]:
+        dtype = np.dtype(spec["dtype"])
+        count = int(np.prod(spec["shape"], dtype=np.int64))
+        arr = np.frombuffer(buffer, dtype=dtype, count=count, offset=spec["offset"])
+        arrays.append(arr.reshape(spec["shape"]))
+    return _rebuild(header["tree"], arrays)
+
+
+class DecodedCache:
+    """
+    Size-bounded LRU cache of reader outputs, optionally spilling evicted entries to disk.
+    See the module documentation. The cache can be shared by threads.
+    """
+
+    def __init__(self, max_bytes: int, spill_dir: Union[None, str, Path] = None):
+        """
+        Args:
+            max_bytes (int): Maximum size of the arrays held in memory.
+            spill_dir (str | Path | None): Directory to write evicted entries to. If
+                `None`, evicted entries are dropped.
+        """
+        self.max_bytes = max_bytes
+        self.spill_dir = None if spill_dir is None else Path(spill_dir)
+        if self.spill_dir is not None:
+            self.spill_dir.mkdir(parents=True, exist_ok=True)
+
+        self._entries: OrderedDict[str, tuple[Any, int]] = OrderedDict()
+        self._nbytes = 0
+        self._lock = threading.Lock()
+
+        self.hits = 0
+        self.misses = 0
+
+    @property
+    def nbytes(self) -> int:
+        """
+        Size of the arrays held in memory.
+        """
+        return self._nbytes
+
+    def __len__(self) -> int:
+        return len(self._entries)
+
+    def __contains__(self, key: str) -> bool:
+        with self._lock:
+            if key in self._entries:
+                return True
+        path = self._spill_path(key)
+        return path is not None and path.exists()
+
+    def _spill_path(self, key: str) -> Union[None, Path]:
+        if self.spill_dir is None:
+            return None
+        return self.spill_dir / f"{hashlib.sha1(key.encode()).hexdigest()}.ucdc"
+
+    def get(self, key: str) -> Any:
+        """
+        Return the reader output stored under `key`, or `None` if there is none.
+        """
+        with self._lock:
+            entry = self._entries.get(key)
+            if entry is not None:
+                self._entries.move_to_end(key)
+                self.hits += 1
+                return entry[0]
+
+        path = self._spill_path(key)
+        if path is not None and path.exists():
+            try:
+                raw_data = load_raw_data(path)
+            except (OSError, ValueError):
+                # e.g. removed or replaced by another process meanwhile
+                pass
+            else:
+                with self._lock:
+                    self.hits += 1
+                return raw_data
+
+        with self._lock:
+            self.misses += 1
+        return None
+
+    def put(self, key: str, raw_data: Any) -> None:
+        """
+        Store a reader output under `key`, evicting the least recently used entries if
+        the cache becomes too large. Outputs larger than the whole cache are only spilled.
+        """
+        nbytes = raw_data_nbytes(raw_data)
+        evicted = []
+        with self._lock:
+            old = self._entries.pop(key, None)
+            if old is not None:
+                self._nbytes -= old[1]
+
+            if nbytes <= self.max_bytes:
+                self._entries[key] = (raw_data, nbytes)
+                self._nbytes += nbytes
+            else:
+                evicted.append((key, raw_data))
+
+            while self._nbytes > self.max_bytes:
+                old_key, (old_data, old_nbytes) = self._entries.popitem(last=False)
+                self._nbytes -= old_nbytes
+                evicted.append((old_key, old_data))
+
+        for old_key, old_data in evicted:
+            self._spill(old_key, old_data)
+
+    def _spill(self, key: str, raw_data: Any) -> None:
+        path = self._spill_path(key)
+        if path is None or path.exists():
+            return
+
+        try:
+            save_raw_data(path, raw_data)
+        except TypeError:
+            # not made of numpy arrays only, e.g. from a custom reader
+            pass
+
+    def clear(self) -> None:
+        """
+        Drop all entries held in memory. Spilled files are kept.
+        """
+        with self._lock:
+            self._entries.clear()
+            self._nbytes = 0
+
+
+def _describe_factory(obj: Any) -> Any:
+    if isinstance(obj, Factory):
+        cls = type(obj)
+        members = {k: _describe_factory(v) for k, v in sorted(vars(obj).items())}
+        return [f"{cls.__module__}.{cls.__qualname__}", members]
+    if isinstance(obj, (list, tuple)):
+        return [_describe_factory(i) for i in obj]
+    if isinstance(obj, dict):
+        return {str(k): _describe_factory(v) for k, v in obj.items()}
+    if isinstance(obj, np.ndarray):
+        return obj.tolist()
+    if isinstance(obj, np.generic):
+        return obj.item()
+    return repr(obj)
+
+
+def factory_fingerprint(factory: Factory) -> str:
+    """
+    Hash of the configuration of a factory tree. Factories reading the same data into
+    the same raw data have the same fingerprint, also in different processes.
+    """
+    description = json.dumps(_describe_factory(factory), sort_keys=True)
+    return hashlib.sha1(description.encode()).hexdigest()
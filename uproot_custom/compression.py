@@ -0,0 +1,166 @@
+"""
+Block-wise decompression of ROOT basket payloads, so that baskets can be decoded while
+they are decompressed instead of after the whole payload is in memory.
+
+A compressed payload is a sequence of independently compressed blocks, each starting with
+a 9-byte header: the algorithm (2 bytes), the method (1 byte), then the compressed and
+uncompressed sizes of the block (3 bytes each, little-endian).
+"""
+
+from __future__ import annotations
+
+import lzma
+import zlib
+from collections.abc import Iterator
+from typing import NamedTuple, Union
+
+import numpy as np
+
+BLOCK_HEADER_SIZE = 9
+
+# decompressed windows fed to the readers, small enough to stay in L2 cache
+DEFAULT_WINDOW_SIZE = 256 * 1024
+
+BufferLike = Union[bytes, bytearray, memoryview, np.ndarray]
+
+
+class BasketPayload(NamedTuple):
+    """
+    Raw payload of a basket as stored in the file, see `read_basket_payload`.
+    """
+
+    data: memoryview  # compressed payload, or the payload itself if not compressed
+    compressed: bool
+    border: int  # size of the entry data, followed by the entry offsets
+    key_length: int  # size of the basket header (TKey and TBasket members)
+
+
+def read_basket_payload(branch, basket_num: int) -> BasketPayload:
+    """
+    Read the payload of a basket from the file without decompressing it.
+    """
+    seek = int(branch.member("fBasketSeek")[basket_num])
+    n_bytes = int(branch.member("fBasketBytes")[basket_num])
+    if seek == 0 or n_bytes == 0:
+        raise ValueError(f"Basket {basket_num} of {branch.object_path} is not in the file.")
+
+    raw = memoryview(branch.file.source.chunk(seek, seek + n_bytes).raw_data).cast("B")
+
+    # TKey: fNbytes (4), fVersion (2), fObjlen (4), fDatime (4), fKeylen (2), ...
+    obj_length = int.from_bytes(raw[6:10], "big")
+    key_length = int.from_bytes(raw[16:18], "big")
+
+    # the key ends with the TBasket members: ..., fLast (4), flag (1)
+    last = int.from_bytes(raw[key_length - 5 : key_length - 1], "big")
+
+    payload = raw[key_length:]
+    return BasketPayload(
+        payload,
+        compressed=len(payload) != obj_length,
+        border=last - key_length,
+        key_length=key_length,
+    )
+
+
+class CompressedBlock(NamedTuple):
+    algorithm: bytes
+    data: memoryview
+    uncompressed_start: int
+    uncompressed_size: int
+
+
+def iter_blocks(payload: BufferLike) -> Iterator[CompressedBlock]:
+    """
+    Iterate over the compressed blocks of a payload without decompressing them.
+    """
+    payload = memoryview(payload).cast("B")
+    pos, uncompressed_start = 0, 0
+    while pos < len(payload):
+        header = payload[pos : pos + BLOCK_HEADER_SIZE].tobytes()
+        if len(header) < BLOCK_HEADER_SIZE:
+            raise ValueError(f"Truncated compression block header at byte {pos}.")
+
+        algorithm = header[:2]
+        compressed_size = int.from_bytes(header[3:6], "little")
+        uncompressed_size = int.from_bytes(header[6:9], "little")
+
+        start = pos + BLOCK_HEADER_SIZE
+        yield CompressedBlock(
+            algorithm,
+            payload[start : start + compressed_size],
+            uncompressed_start,
+            uncompressed_size,
+        )
+
+        pos = start + compressed_size
+        uncompressed_start += uncompressed_size
+
+
+def _iter_zlib(data: memoryview, window_size: int) -> Iterator[bytes]:
+    decompressor = zlib.decompressobj()
+    out = decompressor.decompress(data, window_size)
+    while out:
+        yield out
+        out = decompressor.decompress(decompressor.unconsumed_tail, window_size)
+    out = decompressor.flush()
+    if out:
+        yield out
+
+
+def _iter_lzma(data: memoryview, window_size: int) -> Iterator[bytes]:
+    decompressor = lzma.LZMADecompressor()
+    out = decompressor.decompress(data, window_size)
+    while out:
+        yield out
+        if decompressor.eof:
+            break
+        out = decompressor.decompress(b"", window_size)
+
+
+def _iter_zstd(data: memoryview, window_size: int) -> Iterator[bytes]:
+    try:
+        import zstandard
+    except ImportError as e:
+        raise ImportError("Install zstandard to decompress ZSTD baskets.") from e
+
+    with zstandard.ZstdDecompressor().stream_reader(data) as reader:
+        out = reader.read(window_size)
+        while out:
+            yield out
+            out = reader.read(window_size)
+
+
+def _iter_lz4(data: memoryview, uncompressed_size: int) -> Iterator[bytes]:
+    try:
+        import lz4.block
+    except ImportError as e:
+        raise ImportError("Install lz4 to decompress LZ4 baskets.") from e
+
+    # LZ4 blocks start with an 8-byte checksum, and can only be decompressed as a whole
+    yield lz4.block.decompress(data[8:], uncompressed_size=uncompressed_size)
+
+
+def iter_decompressed(
+    block: CompressedBlock, window_size: int = DEFAULT_WINDOW_SIZE
+) -> Iterator[bytes]:
+    """
+    Decompress a block piece by piece. Except for LZ4, which only supports whole blocks,
+    each piece holds at most `window_size` bytes.
+    """
+    if block.algorithm == b"ZL":
+        return _iter_zlib(block.data, window_size)
+    elif block.algorithm == b"XZ":
+        return _iter_lzma(block.data, window_size)
+    elif block.algorithm == b"ZS":
+        return _iter_zstd(block.data, window_size)
+    elif block.algorithm == b"L4":
+        return _iter_lz4(block.data, block.uncompressed_size)
+    else:
+        raise ValueError(f"Unsupported compression algorithm: {block.algorithm!r}.")
+
+
+def decompress(block: CompressedBlock) -> bytes:
+    """
+    Decompress a whole block.
+    """
+    return b"".join(iter_decompressed(block, max(block.uncompressed_size, 1)))
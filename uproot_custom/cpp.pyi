@@ -7,10 +7,18 @@ classes used in uproot for parsing ROOT file formats.
 
 from __future__ import annotations
 
+from typing import Callable, Union, overload
+
 import numpy as np
 
+# objects supporting the buffer protocol, e.g. bytes, memoryview, mmap.mmap
+Buffer = Union[np.ndarray, bytes, bytearray, memoryview]
+
 class IReader:
     def data(self): ...
+    def reset(self) -> None: ...
+    def reserve(self, n_entries: int, n_bytes: int) -> None: ...
+    def set_offsets_format(self, format: str) -> None: ...
 
 class UInt8Reader(IReader):
     def __init__(self, name: str) -> None: ...
@@ -69,22 +77,22 @@ class STLStringReader(IReader):
     ) -> None: ...
 
 class TArrayCReader(IReader):
-    def __init__(self, name: str) -> None: ...
+    def __init__(self, name: str, keep_big_endian: bool = False) -> None: ...
 
 class TArraySReader(IReader):
-    def __init__(self, name: str) -> None: ...
+    def __init__(self, name: str, keep_big_endian: bool = False) -> None: ...
 
 class TArrayIReader(IReader):
-    def __init__(self, name: str) -> None: ...
+    def __init__(self, name: str, keep_big_endian: bool = False) -> None: ...
 
 class TArrayLReader(IReader):
-    def __init__(self, name: str) -> None: ...
+    def __init__(self, name: str, keep_big_endian: bool = False) -> None: ...
 
 class TArrayFReader(IReader):
-    def __init__(self, name: str) -> None: ...
+    def __init__(self, name: str, keep_big_endian: bool = False) -> None: ...
 
 class TArrayDReader(IReader):
-    def __init__(self, name: str) -> None: ...
+    def __init__(self, name: str, keep_big_endian: bool = False) -> None: ...
 
 class TStringReader(IReader):
     def __init__(self, name: str) -> None: ...
@@ -106,11 +114,27 @@ class AnyClassReader(IReader):
         sub_readers: list[IReader],
     ) -> None: ...
 
+class PODClassReader(IReader):
+    def __init__(
+        self,
+        name: str,
+        dtypes: list[str],
+        sizes: list[int],
+    ) -> None: ...
+
+class MemberSpanReader(IReader):
+    def __init__(
+        self,
+        name: str,
+        skippers: list[IReader],
+    ) -> None: ...
+
 class AnyPointerReader(IReader):
     def __init__(
         self,
         name: str,
         element_reader: IReader,
+        reset_refs: bool = False,
     ) -> None: ...
 
 class CStyleArrayReader(IReader):
@@ -123,6 +147,75 @@ class CStyleArrayReader(IReader):
     ) -> None: ...
 
 class EmptyReader(IReader):
+    @overload
     def __init__(self, name: str) -> None: ...
+    @overload
+    def __init__(self, name: str, element_size: int) -> None: ...
+    @overload
+    def __init__(
+        self,
+        name: str,
+        element_reader: IReader,
+        jump_by_byte_count: bool,
+        shared_byte_count: bool = False,
+    ) -> None: ...
+
+class PlanReader(IReader):
+    def __init__(
+        self,
+        name: str,
+        ops: list[tuple[int, int, int, int, int]],
+        dtypes: list[str],
+        n_offsets: int,
+        readers: list[IReader],
+        strings: list[str],
+    ) -> None: ...
 
-def read_data(data: np.ndarray, offsets: np.ndarray, cursor_offset: int, reader: IReader): ...
+def read_data(
+    data: Buffer,
+    offsets: Buffer,
+    cursor_offset: int,
+    reader: IReader,
+    entry_start: int = 0,
+    entry_stop: int = -1,
+    profile: bool = False,
+): ...
+
+def read_data_concat(
+    baskets: list[tuple[np.ndarray, np.ndarray, int, int, int]],
+    reader: IReader,
+): ...
+def read_data_many(
+    baskets: list[tuple[np.ndarray, np.ndarray, int]],
+    reader_factory: Callable[[], IReader],
+    n_threads: int = 0,
+) -> list: ...
+def read_data_spans(
+    baskets: list[tuple[np.ndarray, np.ndarray, int, np.ndarray, np.ndarray, int, int]],
+    reader: IReader,
+): ...
+def read_data_batch(
+    jobs: list[tuple[np.ndarray, np.ndarray, int, IReader]],
+    n_threads: int = 0,
+) -> list: ...
+def read_data_chunked(
+    data: np.ndarray,
+    offsets: np.ndarray,
+    cursor_offset: int,
+    readers: list[IReader],
+    entry_start: int = 0,
+    entry_stop: int = -1,
+) -> list: ...
+def set_bounds_checks(enabled: bool) -> None: ...
+def bounds_checks() -> bool: ...
+
+class ChunkedDecoder:
+    def __init__(self, reader: IReader, offsets: np.ndarray, cursor_offset: int) -> None: ...
+    def feed(self, window: Buffer) -> int: ...
+    def finish(self): ...
+
+class ArrowExport:
+    def __init__(self, raw_data, spec: tuple) -> None: ...
+    def __len__(self) -> int: ...
+    def __arrow_c_schema__(self) -> object: ...
+    def __arrow_c_array__(self, requested_schema: object = None) -> tuple[object, object]: ...
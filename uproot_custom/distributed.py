@@ -0,0 +1,228 @@
+"""
+Reader plans and shared-memory outputs, for decoding baskets in other processes.
+
+A `ReaderPlan` is the compact, picklable form of a factory tree: the class and the options
+of each factory, without the streamer information the tree was built from. Unpickling a
+plan instantiates the factories again, which is much cheaper than building them from
+streamer information. Unpickled plans are cached per process by the fingerprint of the
+tree (see `factory_fingerprint`), so that a plan sent with every task is only rehydrated
+once per worker, and the C++ readers built from it are reused by later tasks.
+
+`SharedRawData` passes reader outputs between processes of one node without pickling
+their arrays: the arrays are copied once into a `multiprocessing.shared_memory` block,
+and only the name of the block and the layout of the arrays are pickled.
+"""
+
+from __future__ import annotations
+
+import importlib
+import threading
+from multiprocessing import resource_tracker, shared_memory
+from typing import Any, Union
+
+import awkward as ak
+import numpy as np
+
+from uproot_custom.cache import _aligned, _describe, _rebuild, factory_fingerprint
+from uproot_custom.factories import Factory, read_branch_raw
+
+_plans: dict[str, ReaderPlan] = {}
+_plans_lock = threading.Lock()
+
+
+def _describe_plan(obj: Any) -> Any:
+    if isinstance(obj, Factory):
+        cls = type(obj)
+        members = {k: _describe_plan(v) for k, v in vars(obj).items()}
+        return ("factory", cls.__module__, cls.__qualname__, members)
+    if isinstance(obj, list):
+        return [_describe_plan(i) for i in obj]
+    if isinstance(obj, tuple):
+        return ("tuple", [_describe_plan(i) for i in obj])
+    if isinstance(obj, dict):
+        return ("dict", {k: _describe_plan(v) for k, v in obj.items()})
+    if obj is None or isinstance(obj, (bool, int, float, str, np.ndarray, np.generic)):
+        return ("value", obj)
+    raise TypeError(f"{type(obj).__name__} cannot be part of a reader plan.")
+
+
+def _rehydrate(node: Any) -> Any:
+    if isinstance(node, list):
+        return [_rehydrate(i) for i in node]
+    if node[0] == "factory":
+        _, module, qualname, members = node
+        cls = importlib.import_module(module)
+        for name in qualname.split("."):
+            cls = getattr(cls, name)
+
+        factory = cls.__new__(cls)
+        factory.__dict__.update({k: _rehydrate(v) for k, v in members.items()})
+        return factory
+    if node[0] == "tuple":
+        return tuple(_rehydrate(i) for i in node[1])
+    if node[0] == "dict":
+        return {k: _rehydrate(v) for k, v in node[1].items()}
+    return node[1]
+
+
+def _load_plan(fingerprint: str, description: Any) -> ReaderPlan:
+    with _plans_lock:
+        plan = _plans.get(fingerprint)
+        if plan is None:
+            plan = ReaderPlan(_rehydrate(description), fingerprint, description)
+            _plans[fingerprint] = plan
+    return plan
+
+
+class ReaderPlan:
+    """
+    Picklable factory tree with a pool of the C++ readers built from it, see the module
+    documentation.
+    """
+
+    def __init__(
+        self,
+        factory: Factory,
+        fingerprint: Union[None, str] = None,
+        description: Any = None,
+    ):
+        """
+        Args:
+            factory (Factory): The factory tree. Its factories must only hold factories,
+                Python scalars, strings, lists, tuples, dicts and numpy arrays.
+            fingerprint (str): `factory_fingerprint` of the tree, computed if `None`.
+            description (Any): Compact form of the tree, computed if `None`.
+        """
+        self.factory = factory
+        self.fingerprint = fingerprint or factory_fingerprint(factory)
+        self._description = description or _describe_plan(factory)
+        self._cpp_reader_pool: list = []
+        self._plan_pool: list = []
+
+    def __reduce__(self):
+        return (_load_plan, (self.fingerprint, self._description))
+
+    def read(
+        self,
+        data: np.ndarray,
+        offsets: np.ndarray,
+        cursor_offset: int,
+        entry_start: int = 0,
+        entry_stop: int = -1,
+    ) -> Any:
+        """
+        Read a basket and return the raw data of the reader, with the selected backend.
+        C++ readers and `PlanReader`s are taken from and returned to the pools of the plan.
+
+        Args:
+            data (np.ndarray): Data of the basket.
+            offsets (np.ndarray): Entry offsets of the basket, see
+                `regularize_basket_offsets`.
+            cursor_offset (int): Cursor offset of the basket.
+            entry_start (int): First entry of the basket to read. Branches whose
+                objects contain pointers are read from the first entry, see
+                `uproot_custom.factories.read_branch_raw`.
+            entry_stop (int): Entry of the basket to stop reading at (exclusive).
+        """
+        return read_branch_raw(
+            None,
+            data,
+            offsets,
+            cursor_offset,
+            {},
+            {},
+            factory=self.factory,
+            cpp_reader_pool=self._cpp_reader_pool,
+            entry_start=entry_start,
+            entry_stop=entry_stop,
+            plan_pool=self._plan_pool,
+        )
+
+    def array(self, raw_data: Any) -> ak.Array:
+        """
+        Build the awkward array of raw data returned by `read`.
+        """
+        return ak.Array(self.factory.make_awkward_content(raw_data))
+
+
+def _attach(name: str) -> shared_memory.SharedMemory:
+    try:
+        return shared_memory.SharedMemory(name=name, track=False)
+    except TypeError:
+        # before Python 3.13, attaching registers the block to be removed at exit
+        shm = shared_memory.SharedMemory(name=name)
+        resource_tracker.unregister(shm._name, "shared_memory")
+        return shm
+
+
+class SharedRawData:
+    """
+    Reader output stored in a shared memory block, see the module documentation. Pickling
+    it only pickles the name of the block, whatever the size of the arrays.
+
+    The block is removed by `unlink`, which must be called once, by any process, when the
+    data is not needed anymore. Each process releases its own mapping with `close`.
+    """
+
+    def __init__(self, raw_data: Any):
+        """
+        Copy the arrays of `raw_data` into a new shared memory block.
+
+        Args:
+            raw_data (Any): Reader output, e.g. returned by `ReaderPlan.read`.
+        """
+        arrays: list[np.ndarray] = []
+        self._tree = _describe(raw_data, arrays)
+
+        self._specs = []
+        offset = 0
+        for a in arrays:
+            self._specs.append({"dtype": a.dtype.str, "shape": a.shape, "offset": offset})
+            offset = _aligned(offset + a.nbytes)
+
+        self._shm = shared_memory.SharedMemory(create=True, size=max(offset, 1))
+        for spec, a in zip(self._specs, arrays):
+            dst = np.ndarray(a.shape, a.dtype, buffer=self._shm.buf, offset=spec["offset"])
+            dst[...] = a
+
+    @classmethod
+    def _from_block(cls, name: str, tree: Any, specs: list[dict]) -> SharedRawData:
+        shared = cls.__new__(cls)
+        shared._tree = tree
+        shared._specs = specs
+        shared._shm = _attach(name)
+        return shared
+
+    def __reduce__(self):
+        return (SharedRawData._from_block, (self.name, self._tree, self._specs))
+
+    @property
+    def name(self) -> str:
+        """
+        Name of the shared memory block.
+        """
+        return self._shm.name
+
+    def get(self) -> Any:
+        """
+        Return the reader output, with arrays viewing the shared memory block. The views
+        must be released before calling `close`.
+        """
+        buffer = self._shm.buf
+        arrays = [
+            np.ndarray(spec["shape"], spec["dtype"], buffer=buffer, offset=spec["offset"])
+            for spec in self._specs
+        ]
+        return _rebuild(self._tree, arrays)
+
+    def close(self) -> None:
+        """
+        Release the mapping of the block in this process.
+        """
+        self._shm.close()
+
+    def unlink(self) -> None:
+        """
+        Remove the block. Processes that mapped it keep their mapping until `close`.
+        """
+        self._shm.unlink()
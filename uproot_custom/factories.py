@@ -1,7 +1,9 @@
 from __future__ import annotations
 
+import fnmatch
+import os
 import warnings
-from typing import Any, Literal, Union
+from typing import Any, Iterator, Literal, Union
 
 import awkward as ak
 import awkward.contents
@@ -10,8 +12,10 @@ import awkward.index
 import numpy as np
 import uproot
 
+import uproot_custom.compression
 import uproot_custom.readers._forth
 import uproot_custom.readers.cpp
+import uproot_custom.readers.plan
 import uproot_custom.readers.python
 from uproot_custom.utils import (
     get_dims_from_branch,
@@ -26,7 +30,66 @@ except ImportError:
     pass
 
 registered_factories: set[type["Factory"]] = set()
-reader_backend: Literal["cpp", "python", "forth", "numba"] = "cpp"
+reader_backend: Literal["cpp", "plan", "python", "forth", "numba"] = "cpp"
+
+# Layout of the list offsets of the factories built afterwards, see `set_offsets_format`.
+offsets_format: Literal["i64", "i32"] = "i64"
+offsets_counts: bool = False
+
+
+def set_offsets_format(index: Literal["i64", "i32"] = "i64", counts: bool = False) -> None:
+    """
+    Select the layout of the list offsets, e.g. of STL sequences and strings. Each factory
+    keeps the layout selected when it is built and passes it to its readers, so it only
+    applies to factories built afterwards. Call `AsCustom.clear_cache` to rebuild the
+    factories of an interpretation already used.
+
+    Args:
+        index (str): Integer type of the offsets of the awkward arrays, `"i64"` (the
+            default) or `"i32"`. With `"i32"`, the C++ readers return int32 offsets too,
+            and reading a basket with more than 2**31 - 1 items in one list array is an
+            error.
+        counts (bool): Whether the C++ readers return the number of elements of each item,
+            as uint8, uint16 or uint32, instead of offsets. This shrinks the raw data,
+            e.g. held by `DecodedCache` or `SharedRawData`, and the offsets are computed
+            when building the awkward arrays.
+    """
+    global offsets_format, offsets_counts
+    if index not in ("i64", "i32"):
+        raise ValueError(f"Unknown offsets format: {index}.")
+
+    offsets_format = index
+    offsets_counts = bool(counts)
+
+
+def list_offsets_index(
+    offsets: np.ndarray,
+    divisor: int = 1,
+    index_format: Literal["i64", "i32"] = "i64",
+) -> ak.index.Index:
+    """
+    Build the index of a list array from the offsets of a reader. Unsigned arrays hold
+    the number of elements of each item instead, see `set_offsets_format`.
+
+    Args:
+        offsets (np.ndarray): Offsets or counts of the items.
+        divisor (int): Number of elements of the reader per element of the list.
+        index_format (str): Integer type of the index, usually the `offsets_format` of
+            the factory.
+    """
+    offsets = np.asarray(offsets)
+    if offsets.dtype.kind == "u":
+        offsets = np.concatenate([[0], np.cumsum(offsets, dtype=np.int64)])
+    if divisor != 1:
+        offsets = offsets // divisor
+
+    if index_format == "i32":
+        if offsets.dtype != np.int32:
+            if offsets.size and offsets[-1] > np.iinfo(np.int32).max:
+                raise OverflowError(f"Offset {offsets[-1]} does not fit in int32 offsets.")
+            offsets = offsets.astype(np.int32)
+        return ak.index.Index32(offsets)
+    return ak.index.Index64(offsets.astype(np.int64, copy=False))
 
 
 def _objwise_or_memberwise_to_text(
@@ -83,7 +146,109 @@ def build_factory(
     raise ValueError(f"Unknown type: {cur_streamer_info['fTypeName']} for {item_path}")
 
 
-def read_branch(
+def build_member_factories(
+    sub_streamers: list[dict],
+    all_streamer_info: dict,
+    item_path: str,
+) -> list["Factory"]:
+    """
+    Generate factories of the members of a class. Members excluded by
+    `AnyClassFactory.filter_itempaths` are skipped by an `EmptyFactory` when reading.
+
+    Args:
+        sub_streamers (list[dict]): Streamer information of the members.
+        all_streamer_info (dict): All streamer information.
+        item_path (str): Path to the class.
+
+    Returns:
+        A list of `Factory` instances, one per member.
+    """
+    sub_factories = []
+    for s in sub_streamers:
+        factory = build_factory(s, all_streamer_info, item_path)
+        if not AnyClassFactory.keeps_member(item_path, f"{item_path}.{s['fName']}"):
+            factory = EmptyFactory(factory.name, element_factory=factory)
+        sub_factories.append(factory)
+    return sub_factories
+
+
+def regularize_basket_offsets(
+    data: np.ndarray[np.uint8],
+    offsets: Union[None, np.ndarray],
+    cur_streamer_info: dict,
+) -> np.ndarray:
+    """
+    Return the entry offsets of a basket. Baskets of fixed-size items have no offsets,
+    so they are generated from the item size.
+    """
+    if offsets is None:
+        nbyte = cur_streamer_info["fSize"]
+        offsets = np.arange(data.size // nbyte + 1, dtype=np.uint32) * nbyte
+    return offsets
+
+
+def _build_cpp_reader(factory: "Factory") -> uproot_custom.readers.cpp.IReader:
+    reader = factory.build_cpp_reader()
+    reader.set_offsets_format(factory.raw_offsets_format)
+    return reader
+
+
+def _take_cpp_reader(factory: "Factory", cpp_reader_pool: Union[None, list]):
+    reader = None
+    if cpp_reader_pool:
+        try:
+            reader = cpp_reader_pool.pop()
+        except IndexError:
+            # another thread took the last idle reader
+            pass
+
+    if reader is None:
+        reader = _build_cpp_reader(factory)
+    return reader
+
+
+def _release_cpp_reader(reader, cpp_reader_pool: Union[None, list]) -> None:
+    if cpp_reader_pool is None:
+        return
+
+    try:
+        reader.reset()
+    except RuntimeError:
+        # reader (or one of its sub-readers) does not support reset
+        pass
+    else:
+        cpp_reader_pool.append(reader)
+
+
+def _take_plan_reader(factory: "Factory", plan_pool: Union[None, list]):
+    entry = None
+    if plan_pool:
+        try:
+            entry = plan_pool.pop()
+        except IndexError:
+            # another thread took the last idle reader
+            pass
+
+    if entry is None:
+        entry = uproot_custom.readers.plan.build_reader(factory)
+        entry[0].set_offsets_format(factory.raw_offsets_format)
+    return entry
+
+
+def _release_plan_reader(entry: tuple, plan_pool: Union[None, list]) -> None:
+    if plan_pool is None:
+        return
+
+    try:
+        entry[0].reset()
+    except RuntimeError:
+        # one of the fallback readers does not support reset
+        pass
+    else:
+        plan_pool.append(entry)
+
+
+def read_branch_raw(
     branch: uproot.TBranch,
     data: np.ndarray[np.uint8],
     offsets: np.ndarray,
@@ -91,26 +256,51 @@ def read_branch(
     cur_streamer_info: dict,
     all_streamer_info: dict[str, list[dict]],
     item_path: str = "",
+    factory: Union[None, "Factory"] = None,
+    cpp_reader_pool: Union[None, list] = None,
+    entry_start: int = 0,
+    entry_stop: int = -1,
+    plan_pool: Union[None, list] = None,
 ):
-    factory = build_factory(
-        cur_streamer_info,
-        all_streamer_info,
-        item_path,
-        called_from_top=True,
-        branch=branch,
-    )
+    """
+    Read a basket of a branch and return the raw data of the reader, i.e. the input of
+    `Factory.make_awkward_content`. See `read_branch` for the arguments. The forth and
+    numba backends ignore `entry_start` and `entry_stop`, and branches whose objects
+    contain pointers are always read from the first entry of the basket, since a pointer
+    may refer to an object read in an earlier entry.
+    """
+    if factory is None:
+        factory = build_factory(
+            cur_streamer_info,
+            all_streamer_info,
+            item_path,
+            called_from_top=True,
+            branch=branch,
+        )
 
-    if offsets is None:
-        nbyte = cur_streamer_info["fSize"]
-        offsets = np.arange(data.size // nbyte + 1, dtype=np.uint32) * nbyte
+    offsets = regularize_basket_offsets(data, offsets, cur_streamer_info)
+    if _has_references(factory):
+        entry_start = 0
 
     if reader_backend == "cpp":
-        reader = factory.build_cpp_reader()
-        raw_data = uproot_custom.readers.cpp.read_data(data, offsets, cursor_offset, reader)
+        reader = _take_cpp_reader(factory, cpp_reader_pool)
+        raw_data = uproot_custom.readers.cpp.read_data(
+            data, offsets, cursor_offset, reader, entry_start, entry_stop
+        )
+        _release_cpp_reader(reader, cpp_reader_pool)
+
+    elif reader_backend == "plan":
+        entry = _take_plan_reader(factory, plan_pool)
+        raw_data = uproot_custom.readers.plan.read_data(
+            data, offsets, cursor_offset, *entry, entry_start, entry_stop
+        )
+        _release_plan_reader(entry, plan_pool)
 
     elif reader_backend == "python":
         reader = factory.build_python_reader()
-        raw_data = uproot_custom.readers.python.read_data(data, offsets, cursor_offset, reader)
+        raw_data = uproot_custom.readers.python.read_data(
+            data, offsets, cursor_offset, reader, entry_start, entry_stop
+        )
 
     elif reader_backend == "forth":
         warnings.warn(
@@ -137,6 +327,346 @@ def read_branch(
     else:
         raise ValueError(f"Unknown reader backend: {reader_backend}.")
 
+    return raw_data
+
+
+def read_branch(
+    branch: uproot.TBranch,
+    data: np.ndarray[np.uint8],
+    offsets: np.ndarray,
+    cursor_offset: int,
+    cur_streamer_info: dict,
+    all_streamer_info: dict[str, list[dict]],
+    item_path: str = "",
+    factory: Union[None, "Factory"] = None,
+    cpp_reader_pool: Union[None, list] = None,
+    entry_start: int = 0,
+    entry_stop: int = -1,
+    plan_pool: Union[None, list] = None,
+):
+    """
+    Read a basket of a branch and return the awkward content.
+
+    Args:
+        factory (Factory): Pre-built factory of the branch. If `None`, a new one is
+            built from the streamer information.
+        cpp_reader_pool (list): Pool of idle C++ reader trees built from `factory`.
+            When given, the C++ backend takes a reader from the pool (building one if
+            the pool is empty), and puts it back after calling `reset()` on it.
+        entry_start (int): First entry of the basket to read.
+        entry_stop (int): Entry of the basket to stop reading at (exclusive). If
+            negative, reads until the last entry. The C++ and Python backends skip
+            entries outside the range without decoding them, except the entries before
+            the range of branches whose objects contain pointers.
+        plan_pool (list): Pool of idle `PlanReader`s built from `factory`, with their
+            templates, used by the plan backend like `cpp_reader_pool`. Lowering the
+            factory tree is only done when the pool is empty.
+    """
+    if factory is None:
+        factory = build_factory(
+            cur_streamer_info,
+            all_streamer_info,
+            item_path,
+            called_from_top=True,
+            branch=branch,
+        )
+
+    raw_data = read_branch_raw(
+        branch,
+        data,
+        offsets,
+        cursor_offset,
+        cur_streamer_info,
+        all_streamer_info,
+        item_path,
+        factory=factory,
+        cpp_reader_pool=cpp_reader_pool,
+        entry_start=entry_start,
+        entry_stop=entry_stop,
+        plan_pool=plan_pool,
+    )
+
+    content = factory.make_awkward_content(raw_data)
+    if reader_backend in ("forth", "numba") and (entry_start != 0 or entry_stop >= 0):
+        # these backends always decode the whole basket
+        stop = len(content) if entry_stop < 0 else entry_stop
+        content = content[entry_start:stop]
+    elif entry_start > 0 and _has_references(factory):
+        # decoded from the first entry, see `read_branch_raw`
+        content = content[entry_start:]
+    return content
+
+
+def read_branch_arrow(
+    branch: uproot.TBranch,
+    data: np.ndarray[np.uint8],
+    offsets: np.ndarray,
+    cursor_offset: int,
+    cur_streamer_info: dict,
+    all_streamer_info: dict[str, list[dict]],
+    item_path: str = "",
+    factory: Union[None, "Factory"] = None,
+    cpp_reader_pool: Union[None, list] = None,
+    entry_start: int = 0,
+    entry_stop: int = -1,
+) -> uproot_custom.readers.cpp.ArrowExport:
+    """
+    Read a basket of a branch and export it as an Arrow array in one C++ call, without
+    building awkward contents. The result implements the Arrow PyCapsule interface, e.g.
+    `pyarrow.array(result)` or `ak.from_arrow(pyarrow.array(result))`. See `read_branch`
+    for the arguments. Only the C++ backend supports entry ranges.
+    """
+    if factory is None:
+        factory = build_factory(
+            cur_streamer_info,
+            all_streamer_info,
+            item_path,
+            called_from_top=True,
+            branch=branch,
+        )
+
+    spec = factory.make_arrow_spec()
+    if spec is None:
+        raise ValueError(f"{factory.name} has no data to export.")
+
+    raw_data = read_branch_raw(
+        branch,
+        data,
+        offsets,
+        cursor_offset,
+        cur_streamer_info,
+        all_streamer_info,
+        item_path,
+        factory=factory,
+        cpp_reader_pool=cpp_reader_pool,
+        entry_start=entry_start,
+        entry_stop=entry_stop,
+    )
+    return uproot_custom.readers.cpp.ArrowExport(raw_data, spec)
+
+
+def read_branch_concat(
+    baskets: list[tuple[np.ndarray, np.ndarray, int, int, int]],
+    factory: "Factory",
+    cpp_reader_pool: Union[None, list] = None,
+):
+    """
+    Read several baskets of a branch in order into one set of output buffers with the
+    C++ backend, and return the awkward content of all of them. This is equivalent to
+    concatenating the results of `read_branch` on each basket, without the copy.
+
+    Args:
+        baskets (list): `(data, offsets, cursor_offset, entry_start, entry_stop)` of
+            each basket, with offsets already regularized by `regularize_basket_offsets`.
+            The entry range is local to the basket, see `read_branch`.
+        factory (Factory): Factory of the branch.
+        cpp_reader_pool (list): Pool of idle C++ reader trees, see `read_branch`.
+    """
+    skipped = [0] * len(baskets)
+    if _has_references(factory):
+        # read each basket from its first entry, see `read_branch_raw`
+        skipped = [max(start, 0) for _, _, _, start, _ in baskets]
+        baskets = [(d, o, c, 0, stop) for d, o, c, _, stop in baskets]
+
+    reader = _take_cpp_reader(factory, cpp_reader_pool)
+    raw_data = uproot_custom.readers.cpp.read_data_concat(baskets, reader)
+    _release_cpp_reader(reader, cpp_reader_pool)
+    content = factory.make_awkward_content(raw_data)
+    if not any(skipped):
+        return content
+
+    slices, pos = [], 0
+    for (_, offsets, _, _, stop), start in zip(baskets, skipped):
+        n_entries = len(offsets) - 1
+        n_read = n_entries if stop < 0 else min(stop, n_entries)
+        slices.append(content[pos + min(start, n_read) : pos + n_read])
+        pos += n_read
+    return ak.concatenate(slices, highlevel=False)
+
+
+def read_baskets_batch(
+    jobs: list[tuple[np.ndarray, np.ndarray, int, "Factory"]],
+    n_threads: int = 0,
+) -> list:
+    """
+    Read baskets of several branches with the C++ backend in a single call, and return
+    the awkward content of each basket. The baskets are decoded in parallel without the
+    GIL, see `uproot_custom.readers.cpp.read_data_batch`.
+
+    Args:
+        jobs (list): `(data, offsets, cursor_offset, factory)` of each basket, with
+            offsets already regularized by `regularize_basket_offsets`. Baskets of the
+            same branch may share the factory.
+        n_threads (int): Number of worker threads. If not positive, uses the number of
+            hardware threads.
+    """
+    raw_data = uproot_custom.readers.cpp.read_data_batch(
+        [(d, o, c, _build_cpp_reader(f)) for d, o, c, f in jobs], n_threads
+    )
+    return [f.make_awkward_content(r) for (_, _, _, f), r in zip(jobs, raw_data)]
+
+
+def _walk_factories(factory: "Factory") -> Iterator["Factory"]:
+    yield factory
+    for value in vars(factory).values():
+        children = value if isinstance(value, (list, tuple)) else [value]
+        for child in children:
+            if isinstance(child, Factory):
+                yield from _walk_factories(child)
+
+
+def _has_references(factory: "Factory") -> bool:
+    # Pointers refer to objects by their tag in the reference table of the basket, and
+    # objects written without byte count are numbered by the size of that table. Such
+    # branches can neither skip entries nor be split into chunks.
+    return any(isinstance(f, AnyPointerFactory) for f in _walk_factories(factory))
+
+
+def read_branch_chunked(
+    data: np.ndarray[np.uint8],
+    offsets: np.ndarray,
+    cursor_offset: int,
+    factory: "Factory",
+    n_threads: int = 0,
+    min_chunk_bytes: int = 4 * 1024**2,
+    cpp_reader_pool: Union[None, list] = None,
+    entry_start: int = 0,
+    entry_stop: int = -1,
+):
+    """
+    Read a basket with the C++ backend, splitting its entries into chunks of consecutive
+    entries decoded in parallel, and return the awkward content. Each chunk is decoded by
+    its own reader tree, see `uproot_custom.readers.cpp.read_data_chunked`, and the
+    contents of the chunks are concatenated.
+
+    Branches whose objects contain pointers are decoded in one chunk, because a pointer
+    may refer to an object read in another entry.
+
+    Args:
+        offsets (np.ndarray): Entry offsets of the basket, already regularized by
+            `regularize_basket_offsets`.
+        factory (Factory): Factory of the branch.
+        n_threads (int): Maximum number of chunks. If not positive, uses the number of
+            CPUs.
+        min_chunk_bytes (int): Minimum size of a chunk, smaller baskets are decoded in
+            fewer chunks.
+        cpp_reader_pool (list): Pool of idle C++ reader trees, see `read_branch`.
+        entry_start (int): First entry of the basket to read.
+        entry_stop (int): Entry of the basket to stop reading at (exclusive). If
+            negative, reads until the last entry.
+    """
+    n_entries = len(offsets) - 1
+    stop = n_entries if entry_stop < 0 else min(entry_stop, n_entries)
+    start = min(max(entry_start, 0), stop)
+
+    if n_threads <= 0:
+        n_threads = os.cpu_count() or 1
+    n_bytes = int(offsets[stop]) - int(offsets[start])
+    n_chunks = max(1, min(n_threads, n_bytes // max(min_chunk_bytes, 1), stop - start))
+    if _has_references(factory):
+        n_chunks = 1
+
+    readers = [_take_cpp_reader(factory, cpp_reader_pool) for _ in range(n_chunks)]
+    raw_data = uproot_custom.readers.cpp.read_data_chunked(
+        data, offsets, cursor_offset, readers, start, stop
+    )
+    contents = [factory.make_awkward_content(r) for r in raw_data]
+    for reader in readers:
+        _release_cpp_reader(reader, cpp_reader_pool)
+
+    if len(contents) == 1:
+        return contents[0]
+    return ak.concatenate(contents, highlevel=False)
+
+
+def _basket_entry_offsets(
+    tail: bytes, key_length: int, border: int, cur_streamer_info: dict
+) -> np.ndarray:
+    """
+    Convert the entry offsets stored after the entry data of a basket to offsets relative
+    to the payload, as `TBasket.byte_offsets` of uproot. Baskets of fixed-size items have
+    no offsets, see `regularize_basket_offsets`.
+    """
+    if len(tail) == 0:
+        nbyte = cur_streamer_info["fSize"]
+        return np.arange(border // nbyte + 1, dtype=np.uint32) * nbyte
+
+    raw = np.frombuffer(tail, dtype=">i4")
+    offsets = (raw[1:] - key_length).astype(np.uint32)
+    offsets[-1] = border
+    return offsets
+
+
+def read_branch_compressed(
+    payload: uproot_custom.compression.BasketPayload,
+    factory: "Factory",
+    cur_streamer_info: dict,
+    cpp_reader_pool: Union[None, list] = None,
+    window_size: int = uproot_custom.compression.DEFAULT_WINDOW_SIZE,
+):
+    """
+    Decompress and decode a basket in one pass with the C++ backend, and return the
+    awkward content. The payload is decompressed in windows of `window_size` bytes which
+    are decoded right away, so the whole decompressed basket is never held in memory.
+
+    The entry offsets, stored at the end of the payload, are needed before decoding
+    starts: the blocks holding them are streamed once to pick out the offsets, then
+    again to decode the entry data they hold. As ROOT blocks hold up to 16 MB, this is
+    usually the whole basket, decompressed twice but never stored. LZ4 blocks can only be
+    decompressed as a whole, so with LZ4 one whole block is held in memory at a time.
+
+    Args:
+        payload (BasketPayload): Payload of the basket, see
+            `uproot_custom.compression.read_basket_payload`.
+        factory (Factory): Factory of the branch.
+        cur_streamer_info (dict): Streamer information of the branch's top-level item.
+        cpp_reader_pool (list): Pool of idle C++ reader trees, see `read_branch`.
+        window_size (int): Size of the decompressed windows fed to the readers.
+    """
+    border = payload.border
+
+    if payload.compressed:
+        blocks = list(uproot_custom.compression.iter_blocks(payload.data))
+    else:
+        blocks = []
+
+    # the entry offsets follow the entry data, only keep the windows past the border
+    if payload.compressed:
+        tail = []
+        for block in blocks:
+            if block.uncompressed_start + block.uncompressed_size <= border:
+                continue
+
+            pos = block.uncompressed_start
+            for window in uproot_custom.compression.iter_decompressed(block, window_size):
+                if pos + len(window) > border:
+                    tail.append(bytes(memoryview(window)[max(border - pos, 0) :]))
+                pos += len(window)
+        tail = b"".join(tail)
+    else:
+        tail = payload.data[border:]
+
+    offsets = _basket_entry_offsets(tail, payload.key_length, border, cur_streamer_info)
+
+    reader = _take_cpp_reader(factory, cpp_reader_pool)
+    decoder = uproot_custom.readers.cpp.ChunkedDecoder(reader, offsets, payload.key_length)
+
+    if not payload.compressed:
+        decoder.feed(payload.data[:border])
+
+    for block in blocks:
+        if block.uncompressed_start >= border:
+            break
+
+        pos = block.uncompressed_start
+        for window in uproot_custom.compression.iter_decompressed(block, window_size):
+            if pos >= border:
+                break
+            decoder.feed(memoryview(window)[: border - pos])
+            pos += len(window)
+
+    raw_data = decoder.finish()
+    _release_cpp_reader(reader, cpp_reader_pool)
     return factory.make_awkward_content(raw_data)
 
 
@@ -202,8 +732,23 @@ class Factory:
         """
         return None
 
+    # Layout of the list offsets, a snapshot of the module defaults when the factory is
+    # built, see `set_offsets_format`.
+    offsets_format: Literal["i64", "i32"] = "i64"
+    offsets_counts: bool = False
+
     def __init__(self, name: str):
         self.name = name
+        self.offsets_format = offsets_format
+        self.offsets_counts = offsets_counts
+
+    @property
+    def raw_offsets_format(self) -> Literal["i64", "i32", "counts"]:
+        """
+        Layout of the offsets returned by the C++ readers of this factory, see
+        `uproot_custom.readers.cpp.IReader.set_offsets_format`.
+        """
+        return "counts" if self.offsets_counts else self.offsets_format
 
     def build_cpp_reader(self) -> uproot_custom.readers.cpp.IReader:
         """
@@ -253,6 +798,25 @@ class Factory:
         """
         raise NotImplementedError("build_numba_reader not implemented.")
 
+    def build_plan(
+        self,
+        plan: uproot_custom.readers.plan.PlanBuilder,
+        mode: uproot_custom.readers.plan.Mode,
+    ) -> Any:
+        """
+        Lower the reader into the ops of a `PlanReader`, see `uproot_custom.readers.plan`.
+        By default, the program calls the reader of `build_cpp_reader`.
+
+        Args:
+            plan: The plan being built.
+            mode (str): Reader method the ops replace, `"one"`, `"many"` or
+                `"memberwise"`.
+
+        Returns:
+            Template of the raw data of the reader.
+        """
+        return plan.fallback(self, mode)
+
     def make_awkward_content(
         self,
         raw_data: Any,
@@ -277,6 +841,18 @@ class Factory:
         """
         raise NotImplementedError("gen_awkward_form not implemented.")
 
+    def make_arrow_spec(self) -> Union[None, tuple]:
+        """
+        Describe how the C++ reader data is exported as an Arrow array, see
+        `cpp/include/uproot-custom/arrow-export.hh` for the layout.
+
+        Returns:
+            The spec of current item, or `None` if it is left out of the array.
+        """
+        raise NotImplementedError(
+            f"make_arrow_spec not implemented for {type(self).__name__}."
+        )
+
 
 class PrimitiveFactory(Factory):
     typename2dtype = {
@@ -322,6 +898,20 @@ class PrimitiveFactory(Factory):
         "Double_t": "float64",
     }
 
+    dtype2arrow_format = {
+        "bool": "b",
+        "int8": "c",
+        "uint8": "C",
+        "int16": "s",
+        "uint16": "S",
+        "int32": "i",
+        "uint32": "I",
+        "int64": "l",
+        "uint64": "L",
+        "float32": "f",
+        "float64": "g",
+    }
+
     ftype2dtype = {
         1: "int8",
         2: "int16",
@@ -376,12 +966,27 @@ class PrimitiveFactory(Factory):
         return cls(name=cur_streamer_info["fName"], dtype=dtype)
 
     def __init__(self, name: str, dtype: str):
-        self.name = name
+        super().__init__(name)
         self.dtype = dtype
 
     def build_cpp_reader(self):
         return self.cpp_reader_map[self.dtype](self.name)
 
+    def build_plan(self, plan, mode):
+        if not uproot_custom.readers.plan.reads_like(self, PrimitiveFactory):
+            return plan.fallback(self, mode)
+
+        # booleans are read as uint8, like UInt8Reader
+        dtype = np.dtype("uint8" if self.dtype == "bool" else self.dtype)
+        column = plan.column(self, dtype.name)
+        if mode == "one":
+            plan.emit("primitive", dtype.itemsize, column)
+        elif mode == "many":
+            plan.emit("primitive_array", dtype.itemsize, column)
+        else:
+            plan.fail(f"{self.name}::read_many_memberwise is not implemented.")
+        return ("column", column)
+
     def build_python_reader(self):
         return uproot_custom.readers.python.PrimitiveReader(self.name, self.dtype)
 
@@ -407,6 +1012,9 @@ class PrimitiveFactory(Factory):
     def make_awkward_form(self):
         return ak.forms.NumpyForm(self.dtype)
 
+    def make_arrow_spec(self):
+        return ("primitive", self.dtype2arrow_format[self.dtype])
+
 
 stl_typenames = {
     "vector",
@@ -485,7 +1093,7 @@ class STLSeqFactory(Factory):
         objwise_or_memberwise: Literal[-1, 0, 1],
         element_factory: Factory,
     ):
-        self.name = name
+        super().__init__(name)
         self.with_header = with_header
         self.objwise_or_memberwise = objwise_or_memberwise
         self.element_factory = element_factory
@@ -499,6 +1107,49 @@ class STLSeqFactory(Factory):
             element_reader,
         )
 
+    def build_plan(self, plan, mode):
+        plan_module = uproot_custom.readers.plan
+        if not plan_module.reads_like(self, STLSeqFactory):
+            return plan.fallback(self, mode)
+
+        if mode == "memberwise":
+            # the ops after the failure only allocate the outputs
+            plan.fail(f"{self.name}::read_many_memberwise is not implemented.")
+            mode = "many"
+
+        offsets = plan.offsets(self)
+
+        def body(element_mode):
+            plan.emit("count", a=offsets)
+            return self.element_factory.build_plan(plan, element_mode)
+
+        flags = {
+            -1: 0,
+            0: plan_module.kObjwiseOnly,
+            1: plan_module.kMemberwiseOnly,
+        }[self.objwise_or_memberwise]
+        name = plan.string(self.name)
+
+        # object-wise ops first, the header jumps to the member-wise ops
+        if mode == "one":
+            header = plan.emit("seq_header", flags, c=name)
+            template = body("many")
+            end = plan.emit("jump")
+            plan.patch(header, plan.here())
+            body("memberwise")
+        else:
+            flags |= plan_module.kMany | (plan_module.kWithHeader if self.with_header else 0)
+            zero = plan.emit("zero")
+            header = plan.emit("seq_header", flags, c=name)
+            template = plan.loop(lambda: body("many"))
+            end = plan.emit("jump")
+            plan.patch(header, plan.here())
+            plan.loop(lambda: body("memberwise"))
+            plan.patch(zero, plan.here())
+        plan.patch(end, plan.here())
+
+        return ("tuple", [("offsets", offsets), template])
+
     def build_python_reader(self):
         objwise_or_memberwise = _objwise_or_memberwise_to_text(self.objwise_or_memberwise)
         element_reader = self.element_factory.build_python_reader()
@@ -541,17 +1192,20 @@ class STLSeqFactory(Factory):
         offsets, element_raw_data = raw_data
         element_content = self.element_factory.make_awkward_content(element_raw_data)
         return ak.contents.ListOffsetArray(
-            ak.index.Index64(offsets),
+            list_offsets_index(offsets, index_format=self.offsets_format),
             element_content,
         )
 
     def make_awkward_form(self):
         element_form = self.element_factory.make_awkward_form()
         return ak.forms.ListOffsetForm(
-            "i64",
+            self.offsets_format,
             element_form,
         )
 
+    def make_arrow_spec(self):
+        return ("list", 1, self.element_factory.make_arrow_spec())
+
 
 class STLMapFactory(Factory):
     """
@@ -608,7 +1262,7 @@ class STLMapFactory(Factory):
         key_factory: Factory,
         val_factory: Factory,
     ):
-        self.name = name
+        super().__init__(name)
         self.with_header = with_header
         self.objwise_or_memberwise = objwise_or_memberwise
         self.key_factory = key_factory
@@ -703,7 +1357,7 @@ class STLMapFactory(Factory):
         val_content = self.val_factory.make_awkward_content(val_raw_data)
 
         return ak.contents.ListOffsetArray(
-            ak.index.Index64(offsets),
+            list_offsets_index(offsets, index_format=self.offsets_format),
             ak.contents.RecordArray(
                 [key_content, val_content],
                 [self.key_factory.name, self.val_factory.name],
@@ -714,13 +1368,22 @@ class STLMapFactory(Factory):
         key_form = self.key_factory.make_awkward_form()
         val_form = self.val_factory.make_awkward_form()
         return ak.forms.ListOffsetForm(
-            "i64",
+            self.offsets_format,
             ak.forms.RecordForm(
                 [key_form, val_form],
                 [self.key_factory.name, self.val_factory.name],
             ),
         )
 
+    def make_arrow_spec(self):
+        return (
+            "map",
+            self.key_factory.name,
+            self.key_factory.make_arrow_spec(),
+            self.val_factory.name,
+            self.val_factory.make_arrow_spec(),
+        )
+
 
 class STLStringFactory(Factory):
     """
@@ -745,7 +1408,7 @@ class STLStringFactory(Factory):
         )
 
     def __init__(self, name: str, with_header: bool):
-        self.name = name
+        super().__init__(name)
         self.with_header = with_header
 
     def build_cpp_reader(self):
@@ -754,6 +1417,26 @@ class STLStringFactory(Factory):
             self.with_header,
         )
 
+    def build_plan(self, plan, mode):
+        if not uproot_custom.readers.plan.reads_like(self, STLStringFactory):
+            return plan.fallback(self, mode)
+
+        offsets = plan.offsets(self)
+        column = plan.column(self, "uint8")
+        if mode == "one":
+            if self.with_header:
+                plan.emit("obj_header")
+            plan.emit("string", a=offsets, b=column)
+        elif mode == "many":
+            zero = plan.emit("zero")
+            if self.with_header:
+                plan.emit("obj_header")
+            plan.loop(lambda: plan.emit("string", a=offsets, b=column))
+            plan.patch(zero, plan.here())
+        else:
+            plan.fail(f"{self.name}::read_many_memberwise is not implemented.")
+        return ("tuple", [("offsets", offsets), ("column", column)])
+
     def build_python_reader(self):
         return uproot_custom.readers.python.STLStringReader(
             self.name,
@@ -783,18 +1466,21 @@ class STLStringFactory(Factory):
     def make_awkward_content(self, raw_data):
         offsets, data = raw_data
         return awkward.contents.ListOffsetArray(
-            awkward.index.Index64(offsets),
+            list_offsets_index(offsets, index_format=self.offsets_format),
             awkward.contents.NumpyArray(data, parameters={"__array__": "char"}),
             parameters={"__array__": "string"},
         )
 
     def make_awkward_form(self):
         return ak.forms.ListOffsetForm(
-            "i64",
+            self.offsets_format,
             ak.forms.NumpyForm("uint8", parameters={"__array__": "char"}),
             parameters={"__array__": "string"},
         )
 
+    def make_arrow_spec(self):
+        return ("string",)
+
 
 class TArrayFactory(Factory):
     """
@@ -802,8 +1488,15 @@ class TArrayFactory(Factory):
 
     TArray includes TArrayC, TArrayS, TArrayI, TArrayL, TArrayL64, TArrayF, and TArrayD.
     Corresponding dtype is int8, int16, int32, int64, int64, float32, and float64 respectively.
+
+    Items listed in `keep_big_endian_itempaths` are read by the C++ reader without
+    byte-swapping. Their raw data is a numpy view with big-endian dtype, which is only
+    converted to native byte order when building the awkward content.
     """
 
+    # Whether keep TArray data in big-endian byte order.
+    keep_big_endian_itempaths: set[str] = set()
+
     typename2dtype = {
         "TArrayC": "int8",
         "TArrayS": "int16",
@@ -830,11 +1523,16 @@ class TArrayFactory(Factory):
             return None
 
         dtype = cls.typename2dtype[top_type_name]
-        return cls(name=cur_streamer_info["fName"], dtype=dtype)
+        return cls(
+            name=cur_streamer_info["fName"],
+            dtype=dtype,
+            keep_big_endian=item_path in cls.keep_big_endian_itempaths,
+        )
 
-    def __init__(self, name: str, dtype: str):
+    def __init__(self, name: str, dtype: str, keep_big_endian: bool = False):
         super().__init__(name)
         self.dtype = dtype
+        self.keep_big_endian = keep_big_endian
 
     def build_cpp_reader(self):
         return {
@@ -844,7 +1542,7 @@ class TArrayFactory(Factory):
             "int64": uproot_custom.readers.cpp.TArrayLReader,
             "float32": uproot_custom.readers.cpp.TArrayFReader,
             "float64": uproot_custom.readers.cpp.TArrayDReader,
-        }[self.dtype](self.name)
+        }[self.dtype](self.name, self.keep_big_endian)
 
     def build_python_reader(self):
         return uproot_custom.readers.python.TArrayReader(self.name, self.dtype)
@@ -863,13 +1561,19 @@ class TArrayFactory(Factory):
 
     def make_awkward_content(self, raw_data):
         offsets, data = raw_data
+        if not data.dtype.isnative:
+            data = data.astype(data.dtype.newbyteorder("="))
+
         return awkward.contents.ListOffsetArray(
-            awkward.index.Index64(offsets),
+            list_offsets_index(offsets, index_format=self.offsets_format),
             awkward.contents.NumpyArray(data),
         )
 
     def make_awkward_form(self):
-        return ak.forms.ListOffsetForm("i64", ak.forms.NumpyForm(self.dtype))
+        return ak.forms.ListOffsetForm(self.offsets_format, ak.forms.NumpyForm(self.dtype))
+
+    def make_arrow_spec(self):
+        return ("list", 1, ("primitive", PrimitiveFactory.dtype2arrow_format[self.dtype]))
 
 
 class TStringFactory(Factory):
@@ -921,18 +1625,21 @@ class TStringFactory(Factory):
     def make_awkward_content(self, raw_data):
         offsets, data = raw_data
         return awkward.contents.ListOffsetArray(
-            awkward.index.Index64(offsets),
+            list_offsets_index(offsets, index_format=self.offsets_format),
             awkward.contents.NumpyArray(data, parameters={"__array__": "char"}),
             parameters={"__array__": "string"},
         )
 
     def make_awkward_form(self):
         return ak.forms.ListOffsetForm(
-            "i64",
+            self.offsets_format,
             ak.forms.NumpyForm("uint8", parameters={"__array__": "char"}),
             parameters={"__array__": "string"},
         )
 
+    def make_arrow_spec(self):
+        return ("string",)
+
 
 class TObjectFactory(Factory):
     """
@@ -1018,7 +1725,7 @@ class TObjectFactory(Factory):
                 awkward.contents.NumpyArray(unique_ids),
                 awkward.contents.NumpyArray(bits),
                 awkward.contents.ListOffsetArray(
-                    awkward.index.Index64(pidf_offsets),
+                    list_offsets_index(pidf_offsets, index_format=self.offsets_format),
                     awkward.contents.NumpyArray(pidf),
                 ),
             ],
@@ -1034,13 +1741,20 @@ class TObjectFactory(Factory):
                 ak.forms.NumpyForm("int32"),  # fUniqueID
                 ak.forms.NumpyForm("uint32"),  # fBits
                 ak.forms.ListOffsetForm(
-                    "i64",
+                    self.offsets_format,
                     ak.forms.NumpyForm("uint16"),  # pidf
                 ),
             ],
             ["fUniqueID", "fBits", "pidf"],
         )
 
+    def make_arrow_spec(self):
+        if not self.keep_data:
+            return None
+
+        # the offsets of pidf follow its data, which the export does not support
+        return super().make_arrow_spec()
+
 
 class CStyleArrayFactory(Factory):
     """
@@ -1196,12 +1910,9 @@ class CStyleArrayFactory(Factory):
             shape = ()
 
         if self.flat_size < 0:
-            offsets = raw_data[0]
-            for s in shape:
-                offsets = offsets / s
-
+            divisor = int(np.prod(shape, dtype=np.int64))
             return ak.contents.ListOffsetArray(
-                ak.index.Index64(offsets),
+                list_offsets_index(raw_data[0], divisor, self.offsets_format),
                 element_content,
             )
         else:
@@ -1216,12 +1927,25 @@ class CStyleArrayFactory(Factory):
 
         if self.flat_size < 0:
             return ak.forms.ListOffsetForm(
-                "i64",
+                self.offsets_format,
                 element_form,
             )
         else:
             return element_form
 
+    def make_arrow_spec(self):
+        element_spec = self.element_factory.make_arrow_spec()
+        shape = ()
+        if self.fArrayDim is not None and self.fMaxIndex is not None:
+            shape = [int(self.fMaxIndex[i]) for i in range(self.fArrayDim)]
+            for s in shape[::-1]:
+                element_spec = ("fixed_list", s, element_spec)
+
+        if self.flat_size < 0:
+            return ("list", int(np.prod(shape, dtype=np.int64)), element_spec)
+        else:
+            return element_spec
+
 
 class GroupFactory(Factory):
     """
@@ -1306,6 +2030,12 @@ class GroupFactory(Factory):
         else:
             return ak.forms.RecordForm(sub_contents, sub_fields)
 
+    def make_arrow_spec(self):
+        sub_specs = [(s.name, s.make_arrow_spec()) for s in self.sub_factories]
+        if all(spec is None for _, spec in sub_specs):
+            return None
+        return ("struct", sub_specs)
+
 
 class BaseObjectFactory(GroupFactory):
     """
@@ -1331,7 +2061,7 @@ class BaseObjectFactory(GroupFactory):
 
         fName = cls_streamer_info["fName"]
         sub_streamers: list[dict] = all_streamer_info[fName]
-        sub_factories = [build_factory(s, all_streamer_info, item_path) for s in sub_streamers]
+        sub_factories = build_member_factories(sub_streamers, all_streamer_info, item_path)
 
         return cls(name=fName, sub_factories=sub_factories)
 
@@ -1354,12 +2084,35 @@ class BaseObjectFactory(GroupFactory):
 class AnyClassFactory(GroupFactory):
     """
     This class tries to read any class object that is not handled by other factories.
+
+    When `filter_itempaths` lists members of a class, the other members of that class are
+    skipped without being stored, and are left out of the awkward array. Patterns may
+    contain shell-style wildcards, e.g. `/tree:branch.m_*`. Classes without listed members
+    are read in full.
     """
 
+    # Item paths of the class members to read.
+    filter_itempaths: set[str] = set()
+
     @classmethod
     def priority(cls):
         return 0  # This reader should be called last
 
+    @classmethod
+    def keeps_member(cls, class_path: str, member_path: str) -> bool:
+        """
+        Whether a member of the class at `class_path` is read, see `filter_itempaths`.
+        Parents of the listed members are read as well.
+        """
+        patterns = [p for p in cls.filter_itempaths if p.startswith(f"{class_path}.")]
+        if not patterns:
+            return True
+
+        return any(
+            fnmatch.fnmatchcase(member_path, p) or p.startswith(f"{member_path}.")
+            for p in patterns
+        )
+
     @classmethod
     def build_factory(
         cls,
@@ -1374,13 +2127,79 @@ class AnyClassFactory(GroupFactory):
             return None
 
         sub_streamers: list = all_streamer_info[top_type_name]
-        sub_factories = [build_factory(s, all_streamer_info, item_path) for s in sub_streamers]
+        sub_factories = build_member_factories(sub_streamers, all_streamer_info, item_path)
         return cls(name=top_type_name, sub_factories=sub_factories)
 
+    def pod_layout(self) -> Union[None, tuple[list[str], list[int]]]:
+        """
+        Return the dtypes and sizes of the members if they are all primitives or skipped
+        members of fixed size, `None` otherwise. Skipped members have an empty dtype.
+        """
+        dtypes, sizes = [], []
+        for s in self.sub_factories:
+            if isinstance(s, PrimitiveFactory):
+                dtypes.append(s.dtype)
+                sizes.append(np.dtype(s.dtype).itemsize)
+            elif isinstance(s, EmptyFactory) and (s.element_size or s.element_factory is None):
+                dtypes.append("")
+                sizes.append(s.element_size)
+            else:
+                return None
+        return dtypes, sizes
+
     def build_cpp_reader(self):
+        # classes of primitives are read by one reader, without a reader per member
+        pod_layout = self.pod_layout()
+        if pod_layout is not None:
+            return uproot_custom.readers.cpp.PODClassReader(self.name, *pod_layout)
+
         sub_readers = [s.build_cpp_reader() for s in self.sub_factories]
         return uproot_custom.readers.cpp.AnyClassReader(self.name, sub_readers)
 
+    def build_plan(self, plan, mode):
+        if not uproot_custom.readers.plan.reads_like(self, AnyClassFactory):
+            return plan.fallback(self, mode)
+
+        if mode == "one":
+            plan.emit("class_begin")
+            template = [s.build_plan(plan, "one") for s in self.sub_factories]
+            plan.emit("class_end", c=plan.string(self.name))
+            return template
+
+        if mode == "many":
+            return plan.loop(lambda: self.build_plan(plan, "one"))
+
+        # member-wise: each member reads all objects in turn
+        if not self.sub_factories:
+            plan.emit("pop")
+        template = []
+        for i, s in enumerate(self.sub_factories):
+            if i < len(self.sub_factories) - 1:
+                plan.emit("dup")
+            template.append(s.build_plan(plan, "many"))
+        return template
+
+    def build_cpp_span_reader(self):
+        """
+        Build a C++ reader recording where each member of the objects starts, without
+        decoding them, see `uproot_custom.lazy`.
+        """
+        skippers = []
+        for s in self.sub_factories:
+            # each member is read once per object, so STL containers have a byte count
+            if isinstance(s, (STLSeqFactory, STLMapFactory)) or (
+                isinstance(s, STLStringFactory) and s.with_header
+            ):
+                skipper = uproot_custom.readers.cpp.EmptyReader(
+                    s.name, s.build_cpp_reader(), True
+                )
+            elif isinstance(s, EmptyFactory):
+                skipper = s.build_cpp_reader()
+            else:
+                skipper = EmptyFactory(s.name, s).build_cpp_reader()
+            skippers.append(skipper)
+        return uproot_custom.readers.cpp.MemberSpanReader(self.name, skippers)
+
     def build_python_reader(self):
         sub_readers = [s.build_python_reader() for s in self.sub_factories]
         return uproot_custom.readers.python.AnyClassReader(self.name, sub_readers)
@@ -1414,6 +2233,11 @@ class AnyPointerFactory(Factory):
     # kObjectp=63, kObjectP=64, kAnyp=68, kAnyP=69
     _POINTER_FTYPES = {63, 64, 68, 69}
 
+    # Pointers whose references are discarded at each new entry, which keeps the
+    # reference table small. Only valid when no pointer refers to an object of another
+    # entry of the basket.
+    reset_refs_itempaths: set[str] = set()
+
     @classmethod
     def priority(cls):
         return 15
@@ -1444,19 +2268,25 @@ class AnyPointerFactory(Factory):
         return cls(
             name=cur_streamer_info["fName"],
             element_factory=element_factory,
+            reset_refs=item_path in cls.reset_refs_itempaths,
         )
 
-    def __init__(self, name: str, element_factory: Factory):
+    def __init__(self, name: str, element_factory: Factory, reset_refs: bool = False):
         super().__init__(name)
         self.element_factory = element_factory
+        self.reset_refs = reset_refs
 
     def build_cpp_reader(self):
         element_reader = self.element_factory.build_cpp_reader()
-        return uproot_custom.readers.cpp.AnyPointerReader(self.name, element_reader)
+        return uproot_custom.readers.cpp.AnyPointerReader(
+            self.name, element_reader, self.reset_refs
+        )
 
     def build_python_reader(self):
         element_reader = self.element_factory.build_python_reader()
-        return uproot_custom.readers.python.AnyPointerReader(self.name, element_reader)
+        return uproot_custom.readers.python.AnyPointerReader(
+            self.name, element_reader, self.reset_refs
+        )
 
     def make_awkward_content(self, raw_data):
         element_data, element_idxs = raw_data
@@ -1473,7 +2303,10 @@ class AnyPointerFactory(Factory):
 
 class EmptyFactory(Factory):
     """
-    This factory does nothing. It's just a place holder.
+    This factory reads nothing into the awkward array. Without `element_factory`, it's
+    just a place holder. Otherwise, it skips the items `element_factory` would read:
+    by their size if it is fixed, by their `fNBytes` byte count if they are classes or
+    STL containers with a header, or else by parsing them and discarding the data.
     """
 
     @classmethod
@@ -1491,22 +2324,96 @@ class EmptyFactory(Factory):
         """
         return None
 
+    def __init__(self, name: str, element_factory: Union[None, Factory] = None):
+        super().__init__(name)
+
+        # TObject data is parsed anyway, but does not need to be stored
+        if isinstance(element_factory, TObjectFactory):
+            element_factory = TObjectFactory(element_factory.name, keep_data=False)
+
+        self.element_factory = element_factory
+        self.element_size = self._fixed_size(element_factory)
+
+        # the header of STL containers covers all items read at once, see `read_many`
+        self.shared_byte_count = isinstance(
+            element_factory, (STLSeqFactory, STLMapFactory, STLStringFactory)
+        ) and bool(element_factory.with_header)
+        self.jump_by_byte_count = self.shared_byte_count or isinstance(
+            element_factory, AnyClassFactory
+        )
+
+    @staticmethod
+    def _fixed_size(factory: Union[None, Factory]) -> int:
+        """
+        Size in bytes of the items read by `factory`, or 0 if it is not fixed.
+        """
+        if isinstance(factory, PrimitiveFactory):
+            return np.dtype(factory.dtype).itemsize
+        if (
+            isinstance(factory, CStyleArrayFactory)
+            and factory.flat_size > 0
+            and isinstance(factory.element_factory, PrimitiveFactory)
+        ):
+            return int(factory.flat_size) * np.dtype(factory.element_factory.dtype).itemsize
+        return 0
+
     def build_cpp_reader(self):
-        return uproot_custom.readers.cpp.EmptyReader(self.name)
+        if self.element_factory is None:
+            return uproot_custom.readers.cpp.EmptyReader(self.name)
+        if self.element_size:
+            return uproot_custom.readers.cpp.EmptyReader(self.name, self.element_size)
+        return uproot_custom.readers.cpp.EmptyReader(
+            self.name,
+            self.element_factory.build_cpp_reader(),
+            self.jump_by_byte_count,
+            self.shared_byte_count,
+        )
+
+    def build_plan(self, plan, mode):
+        if not uproot_custom.readers.plan.reads_like(self, EmptyFactory) or (
+            self.element_factory is not None and not self.element_size
+        ):
+            return plan.fallback(self, mode)
+
+        if mode == "memberwise":
+            plan.fail(f"{self.name}::read_many_memberwise is not implemented.")
+        elif self.element_factory is None:
+            if mode == "many":
+                plan.emit("pop")
+        elif mode == "one":
+            plan.emit("skip", self.element_size)
+        else:
+            plan.emit("skip_array", self.element_size)
+        return None
 
     def build_python_reader(self):
-        return uproot_custom.readers.python.EmptyReader(self.name)
+        return uproot_custom.readers.python.EmptyReader(
+            self.name,
+            element_size=self.element_size,
+            element_reader=(
+                None
+                if self.element_factory is None or self.element_size
+                else self.element_factory.build_python_reader()
+            ),
+            jump_by_byte_count=self.jump_by_byte_count,
+            shared_byte_count=self.shared_byte_count,
+        )
 
     def build_forth_reader(
         self,
         buffer_holder: uproot_custom.readers._forth.BufferHolder,
     ):
+        # skipped items are parsed, their data is dropped in `make_awkward_content`
+        if self.element_factory is not None:
+            return self.element_factory.build_forth_reader(buffer_holder)
         return uproot_custom.readers._forth.EmptyReader(self.name, buffer_holder)
 
     def build_numba_reader(
         self,
         ctx: uproot_custom.readers._numba.CompilationContext,
     ):
+        if self.element_factory is not None:
+            return self.element_factory.build_numba_reader(ctx)
         return uproot_custom.readers._numba.EmptyReader(self.name, ctx)
 
     def make_awkward_content(self, raw_data):
@@ -1515,6 +2422,9 @@ class EmptyFactory(Factory):
     def make_awkward_form(self):
         return ak.forms.EmptyForm()
 
+    def make_arrow_spec(self):
+        return None
+
 
 registered_factories |= {
     PrimitiveFactory,
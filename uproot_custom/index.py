@@ -0,0 +1,231 @@
+"""
+Persistent structural index of class branches, for repeated random access to entries.
+
+An index holds, for each basket of a branch, where each member of each object starts,
+as recorded by `AnyClassFactory.build_cpp_span_reader` (see `uproot_custom.lazy`). Reading
+entries through the index decodes only the requested members of the requested entries:
+the stream is moved directly to each member, without parsing the members before it.
+
+Indexes are stored as sidecar files next to the ROOT file, in the format of
+`uproot_custom.cache.save_raw_data`, and are memory-mapped when loaded. A sidecar is only
+used for the file (by UUID) and the factory configuration it was built for.
+"""
+
+from __future__ import annotations
+
+import hashlib
+from pathlib import Path
+from typing import Union
+
+import awkward as ak
+import numpy as np
+import uproot
+
+from uproot_custom.cache import factory_fingerprint, load_raw_data, save_raw_data
+from uproot_custom.factories import AnyClassFactory
+from uproot_custom.lazy import LazyBasket, index_basket, lazy_class_content
+from uproot_custom.utils import regularize_object_path
+
+INDEX_VERSION = 1
+
+
+def sidecar_path(file_path: Union[str, Path], branch_path: str) -> Path:
+    """
+    Path of the index of a branch, in the `<file>.ucidx` directory next to the ROOT file.
+    """
+    file_path = Path(file_path)
+    name = hashlib.sha1(regularize_object_path(branch_path).encode()).hexdigest()
+    return file_path.with_name(f"{file_path.name}.ucidx") / f"{name}.ucdc"
+
+
+class BranchIndex:
+    """
+    Member positions of each basket of a class branch, see the module documentation.
+    """
+
+    def __init__(
+        self,
+        file_uuid: str,
+        branch_path: str,
+        fingerprint: str,
+        entry_offsets: np.ndarray,
+        positions: dict[int, list[np.ndarray]],
+    ):
+        """
+        Args:
+            file_uuid (str): UUID of the ROOT file.
+            branch_path (str): Object path of the branch.
+            fingerprint (str): `factory_fingerprint` of the factory of the branch.
+            entry_offsets (np.ndarray): First entry of each basket, then the number of
+                entries of the branch.
+            positions (dict): Positions of the members in each basket, keyed on the basket
+                index, see `MemberSpanReader`.
+        """
+        self.file_uuid = file_uuid
+        self.branch_path = regularize_object_path(branch_path)
+        self.fingerprint = fingerprint
+        self.entry_offsets = np.asarray(entry_offsets, dtype=np.int64)
+        self.positions = positions
+
+    @staticmethod
+    def _branch_factory(branch: uproot.TBranch, factory: Union[None, AnyClassFactory]):
+        if factory is None:
+            factory = branch.interpretation.factory
+        if not isinstance(factory, AnyClassFactory):
+            raise TypeError(
+                f"Only branches read by AnyClassFactory can be indexed, "
+                f"{branch.object_path} is read by {type(factory).__name__}."
+            )
+        return factory
+
+    @staticmethod
+    def _load_basket(branch: uproot.TBranch, basket_num: int):
+        basket = branch.basket(basket_num)
+        offsets = basket.byte_offsets
+        if offsets is None:
+            raise ValueError(f"Basket {basket_num} of {branch.object_path} has no offsets.")
+        return basket.data, offsets.astype(np.uint32), int(basket.member("fKeylen"))
+
+    @classmethod
+    def build(
+        cls,
+        branch: uproot.TBranch,
+        factory: Union[None, AnyClassFactory] = None,
+    ) -> BranchIndex:
+        """
+        Index all baskets of a branch. Each basket is read, decompressed and scanned once.
+
+        Args:
+            branch (uproot.TBranch): The branch.
+            factory (AnyClassFactory): Factory of the branch. If `None`, the factory of
+                the branch's `AsCustom` interpretation.
+        """
+        factory = cls._branch_factory(branch, factory)
+
+        positions = {}
+        for i in range(branch.num_baskets):
+            data, offsets, cursor_offset = cls._load_basket(branch, i)
+            positions[i] = index_basket(data, offsets, cursor_offset, factory).positions
+
+        return cls(
+            str(branch.file.uuid),
+            branch.object_path,
+            factory_fingerprint(factory),
+            branch.entry_offsets,
+            positions,
+        )
+
+    def save(self, path: Union[str, Path]) -> None:
+        """
+        Write the index to `path`, creating its directory if needed.
+        """
+        path = Path(path)
+        path.parent.mkdir(parents=True, exist_ok=True)
+        save_raw_data(
+            path,
+            {
+                "version": INDEX_VERSION,
+                "file_uuid": self.file_uuid,
+                "branch_path": self.branch_path,
+                "fingerprint": self.fingerprint,
+                "entry_offsets": self.entry_offsets,
+                "positions": {str(k): v for k, v in self.positions.items()},
+            },
+        )
+
+    @classmethod
+    def load(cls, path: Union[str, Path]) -> BranchIndex:
+        """
+        Map an index written by `save` into memory.
+        """
+        content = load_raw_data(path)
+        if not isinstance(content, dict) or content.get("version") != INDEX_VERSION:
+            raise ValueError(f"{path} is not a branch index of version {INDEX_VERSION}.")
+
+        return cls(
+            content["file_uuid"],
+            content["branch_path"],
+            content["fingerprint"],
+            content["entry_offsets"],
+            {int(k): v for k, v in content["positions"].items()},
+        )
+
+    def matches(self, branch: uproot.TBranch, factory: AnyClassFactory) -> bool:
+        """
+        Whether the index was built for this branch of this file, read by this factory.
+        """
+        return (
+            self.file_uuid == str(branch.file.uuid)
+            and self.branch_path == regularize_object_path(branch.object_path)
+            and self.fingerprint == factory_fingerprint(factory)
+        )
+
+    @classmethod
+    def open(
+        cls,
+        branch: uproot.TBranch,
+        factory: Union[None, AnyClassFactory] = None,
+        path: Union[None, str, Path] = None,
+    ) -> BranchIndex:
+        """
+        Load the sidecar index of a branch, or build and save it if it is missing or
+        stale.
+
+        Args:
+            branch (uproot.TBranch): The branch.
+            factory (AnyClassFactory): Factory of the branch, see `build`.
+            path (str | Path): Path of the index. If `None`, see `sidecar_path`.
+        """
+        factory = cls._branch_factory(branch, factory)
+        if path is None:
+            path = sidecar_path(branch.file.file_path, branch.object_path)
+
+        if Path(path).exists():
+            try:
+                index = cls.load(path)
+            except (OSError, ValueError):
+                pass
+            else:
+                if index.matches(branch, factory):
+                    return index
+
+        index = cls.build(branch, factory)
+        index.save(path)
+        return index
+
+    def read(
+        self,
+        branch: uproot.TBranch,
+        entry_start: int,
+        entry_stop: int,
+        factory: Union[None, AnyClassFactory] = None,
+    ) -> ak.Array:
+        """
+        Read an entry range of the branch. Only the baskets holding the entries are read,
+        and members are decoded, for the requested entries only, on first access.
+
+        Args:
+            branch (uproot.TBranch): The branch the index was built for.
+            entry_start (int): First entry to read.
+            entry_stop (int): Entry to stop reading at (exclusive).
+            factory (AnyClassFactory): Factory of the branch, see `build`.
+        """
+        factory = self._branch_factory(branch, factory)
+        n_entries = int(self.entry_offsets[-1])
+        entry_start = min(max(entry_start, 0), n_entries)
+        entry_stop = min(max(entry_stop, entry_start), n_entries)
+
+        baskets = []
+        first = int(np.searchsorted(self.entry_offsets, entry_start, side="right")) - 1
+        for i in range(max(first, 0), len(self.entry_offsets) - 1):
+            basket_start, basket_stop = self.entry_offsets[i], self.entry_offsets[i + 1]
+            if basket_start >= entry_stop:
+                break
+
+            data, offsets, cursor_offset = self._load_basket(branch, i)
+            basket = LazyBasket(data, offsets, cursor_offset, self.positions[i])
+            local_start = max(entry_start, basket_start) - basket_start
+            local_stop = min(entry_stop, basket_stop) - basket_start
+            baskets.append((basket, int(local_start), int(local_stop)))
+
+        return ak.Array(lazy_class_content(factory, baskets))
@@ -0,0 +1,147 @@
+"""
+Lazy decoding of the members of class branches with the C++ backend.
+
+Reading a basket only indexes it: `AnyClassFactory.build_cpp_span_reader` records where
+each member of each object starts, jumping over members by their size or `fNBytes` byte
+count where possible. The awkward array of the branch is then built from virtual buffers,
+so that each member is only decoded, for all baskets at once, when one of its buffers is
+first materialized.
+
+Branches whose objects contain pointers are decoded eagerly, because a pointer may refer
+to an object read in another member.
+"""
+
+from __future__ import annotations
+
+import threading
+
+import awkward as ak
+import numpy as np
+
+import uproot_custom.readers.cpp
+from uproot_custom.factories import (
+    AnyClassFactory,
+    AnyPointerFactory,
+    Factory,
+    _build_cpp_reader,
+    _walk_factories,
+)
+
+
+class LazyBasket:
+    """
+    Indexed but undecoded basket data, returned by `AsCustom.basket_array` when
+    `AsCustom.lazy_decoding` is enabled. The members are decoded on demand by the array
+    built in `AsCustom.final_array`.
+    """
+
+    def __init__(
+        self,
+        data: np.ndarray,
+        offsets: np.ndarray,
+        cursor_offset: int,
+        positions: list[np.ndarray],
+    ):
+        """
+        Args:
+            data (np.ndarray): Data of the basket.
+            offsets (np.ndarray): Regularized entry offsets of the basket.
+            cursor_offset (int): Cursor offset of the basket.
+            positions (list[np.ndarray]): Start of each member in each entry, followed by
+                the end of the last member, see `MemberSpanReader`.
+        """
+        self.data = data
+        self.offsets = offsets
+        self.cursor_offset = cursor_offset
+        self.positions = positions
+
+    def __len__(self) -> int:
+        return len(self.offsets) - 1
+
+
+def supports_lazy_decoding(factory: Factory) -> bool:
+    """
+    Whether the members of the items read by `factory` can be decoded one at a time.
+    """
+    return isinstance(factory, AnyClassFactory) and not any(
+        isinstance(f, AnyPointerFactory) for f in _walk_factories(factory)
+    )
+
+
+def index_basket(
+    data: np.ndarray,
+    offsets: np.ndarray,
+    cursor_offset: int,
+    factory: AnyClassFactory,
+) -> LazyBasket:
+    """
+    Index the members of the objects in a basket without decoding them.
+    """
+    reader = factory.build_cpp_span_reader()
+    positions = uproot_custom.readers.cpp.read_data(data, offsets, cursor_offset, reader)
+    return LazyBasket(data, offsets, cursor_offset, positions)
+
+
+def _lazy_member(
+    member: Factory,
+    i_member: int,
+    baskets: list[tuple[LazyBasket, int, int]],
+    length: int,
+) -> ak.contents.Content:
+    keyed_form, _, _ = ak.to_buffers(member.make_awkward_form().length_zero_array())
+    buffers: dict = {}
+    lock = threading.Lock()
+
+    def load(key: str) -> np.ndarray:
+        with lock:
+            if not buffers:
+                raw_data = uproot_custom.readers.cpp.read_data_spans(
+                    [
+                        (
+                            b.data,
+                            b.offsets,
+                            b.cursor_offset,
+                            b.positions[i_member],
+                            b.positions[i_member + 1],
+                            start,
+                            stop,
+                        )
+                        for b, start, stop in baskets
+                    ],
+                    _build_cpp_reader(member),
+                )
+                _, _, container = ak.to_buffers(member.make_awkward_content(raw_data))
+                buffers.update(container)
+        return buffers[key]
+
+    container = {
+        key: (lambda key=key: load(key)) for key in keyed_form.expected_from_buffers()
+    }
+    return ak.from_buffers(keyed_form, length, container, highlevel=False)
+
+
+def lazy_class_content(
+    factory: AnyClassFactory,
+    baskets: list[tuple[LazyBasket, int, int]],
+) -> ak.contents.Content:
+    """
+    Build the awkward content of indexed baskets, whose members are decoded on first
+    access. Members are decoded from all baskets into one set of buffers.
+
+    Args:
+        factory (AnyClassFactory): Factory of the branch.
+        baskets (list): `(basket, entry_start, entry_stop)` of each basket, the entry
+            range is local to the basket.
+    """
+    length = sum(stop - start for _, start, stop in baskets)
+
+    fields, contents = [], []
+    for i, member in enumerate(factory.sub_factories):
+        if isinstance(member.make_awkward_form(), ak.forms.EmptyForm):
+            continue
+        fields.append(member.name)
+        contents.append(_lazy_member(member, i, baskets, length))
+
+    if len(contents) == 0:
+        return ak.contents.EmptyArray()
+    return ak.contents.RecordArray(contents, fields, length=length)
@@ -7,6 +7,8 @@ This file contains only type hints without implementations.
 from uproot_custom.cpp import (
     AnyClassReader,
     AnyPointerReader,
+    ArrowExport,
+    ChunkedDecoder,
     CStyleArrayReader,
     DoubleReader,
     EmptyReader,
@@ -17,6 +19,9 @@ from uproot_custom.cpp import (
     Int32Reader,
     Int64Reader,
     IReader,
+    MemberSpanReader,
+    PlanReader,
+    PODClassReader,
     STLMapReader,
     STLSeqReader,
     STLStringReader,
@@ -32,12 +37,21 @@ from uproot_custom.cpp import (
     UInt16Reader,
     UInt32Reader,
     UInt64Reader,
+    bounds_checks,
     read_data,
+    read_data_batch,
+    read_data_chunked,
+    read_data_concat,
+    read_data_many,
+    read_data_spans,
+    set_bounds_checks,
 )
 
 __all__ = [
     "AnyClassReader",
     "AnyPointerReader",
+    "ArrowExport",
+    "ChunkedDecoder",
     "CStyleArrayReader",
     "DoubleReader",
     "EmptyReader",
@@ -48,6 +62,9 @@ __all__ = [
     "Int32Reader",
     "Int64Reader",
     "IReader",
+    "MemberSpanReader",
+    "PlanReader",
+    "PODClassReader",
     "STLMapReader",
     "STLSeqReader",
     "STLStringReader",
@@ -63,5 +80,12 @@ __all__ = [
     "UInt16Reader",
     "UInt32Reader",
     "UInt64Reader",
+    "bounds_checks",
     "read_data",
+    "read_data_batch",
+    "read_data_chunked",
+    "read_data_concat",
+    "read_data_many",
+    "read_data_spans",
+    "set_bounds_checks",
 ]
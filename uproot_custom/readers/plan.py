@@ -0,0 +1,234 @@
+"""
+Reader plans: factory trees lowered into a flat program of opcodes, executed by the C++
+`PlanReader` in one dispatch loop.
+
+Each factory lowers itself with `Factory.build_plan(plan, mode)`, where `mode` is the
+reader method the program replaces:
+
+- `"one"`: `read()`, read one item;
+- `"many"`: `read_many()`, read the number of items on top of the count stack;
+- `"memberwise"`: `read_many_memberwise()`, same for member-wise items.
+
+`build_plan` emits the ops and returns a template of the raw data its reader would
+return, made of `("column", i)`, `("offsets", i)` and `("reader", i)` references to the
+outputs of the `PlanReader`, and of tuples, lists and `None`. Factories that are not
+lowered fall back to their C++ reader, which is called by the program.
+
+A factory may be lowered in several modes, e.g. for the object-wise and member-wise
+branches of a sequence, so its outputs are allocated once per factory.
+"""
+
+from __future__ import annotations
+
+from typing import TYPE_CHECKING, Any, Callable, Literal
+
+import numpy as np
+
+import uproot_custom.readers.cpp
+
+if TYPE_CHECKING:
+    from uproot_custom.factories import Factory
+
+Mode = Literal["one", "many", "memberwise"]
+
+# same order as `PlanReader::OpCode`
+OPCODES = [
+    "primitive",
+    "primitive_array",
+    "skip",
+    "skip_array",
+    "count",
+    "dup",
+    "pop",
+    "loop",
+    "jump",
+    "zero",
+    "obj_header",
+    "seq_header",
+    "string",
+    "class_begin",
+    "class_end",
+    "call",
+    "call_many",
+    "call_memberwise",
+    "fail",
+]
+_OPCODE_VALUES = {name: i for i, name in enumerate(OPCODES)}
+
+# flags of "seq_header", same as `PlanReader::SeqFlags`
+kWithHeader = 1 << 0
+kMany = 1 << 1
+kObjwiseOnly = 1 << 2
+kMemberwiseOnly = 1 << 3
+
+
+def reads_like(factory: Factory, cls: type[Factory]) -> bool:
+    """
+    Whether `factory` reads its data like `cls`, i.e. a subclass does not override
+    `build_cpp_reader`. Only such factories may be lowered the way `cls` is.
+    """
+    return type(factory).build_cpp_reader is cls.build_cpp_reader
+
+
+class PlanBuilder:
+    """
+    Program and outputs of a `PlanReader` being built, see the module documentation.
+    """
+
+    def __init__(self):
+        self.ops: list[list[int]] = []
+        self.dtypes: list[str] = []
+        self.n_offsets = 0
+        self.readers: list[uproot_custom.readers.cpp.IReader] = []
+        self.strings: list[str] = []
+        self._outputs: dict[tuple[int, str], int] = {}
+        self._factories: list[Factory] = []  # keep ids of memoized factories unique
+
+    def emit(self, opcode: str, arg: int = 0, a: int = 0, b: int = 0, c: int = 0) -> int:
+        """
+        Append an op to the program and return its position.
+        """
+        self.ops.append([_OPCODE_VALUES[opcode], arg, a, b, c])
+        return len(self.ops) - 1
+
+    def here(self) -> int:
+        """
+        Position of the next op, e.g. a jump target.
+        """
+        return len(self.ops)
+
+    def patch(self, pos: int, a: int) -> None:
+        """
+        Set the jump target `a` of the op at `pos`.
+        """
+        self.ops[pos][2] = a
+
+    def string(self, text: str) -> int:
+        """
+        Index of a name or message in the string table.
+        """
+        if text not in self.strings:
+            self.strings.append(text)
+        return self.strings.index(text)
+
+    def _output(self, factory: Factory, kind: str, make: Callable[[], int]) -> int:
+        key = (id(factory), kind)
+        if key not in self._outputs:
+            self._factories.append(factory)
+            self._outputs[key] = make()
+        return self._outputs[key]
+
+    def column(self, factory: Factory, dtype: str, kind: str = "column") -> int:
+        """
+        Index of a column of `dtype` owned by `factory`.
+        """
+
+        def make():
+            self.dtypes.append(dtype)
+            return len(self.dtypes) - 1
+
+        return self._output(factory, kind, make)
+
+    def offsets(self, factory: Factory) -> int:
+        """
+        Index of the offsets array owned by `factory`.
+        """
+
+        def make():
+            self.n_offsets += 1
+            return self.n_offsets - 1
+
+        return self._output(factory, "offsets", make)
+
+    def fallback(self, factory: Factory, mode: Mode) -> tuple:
+        """
+        Call the C++ reader of `factory` from the program.
+        """
+
+        def make():
+            self.readers.append(factory.build_cpp_reader())
+            return len(self.readers) - 1
+
+        i_reader = self._output(factory, "reader", make)
+        opcode = {"one": "call", "many": "call_many", "memberwise": "call_memberwise"}[mode]
+        self.emit(opcode, a=i_reader)
+        return ("reader", i_reader)
+
+    def fail(self, message: str) -> None:
+        """
+        Throw `message` when the program reaches this op.
+        """
+        self.emit("fail", c=self.string(message))
+
+    def loop(self, body: Callable[[], Any]) -> Any:
+        """
+        Repeat the ops emitted by `body` as many times as the count on top of the stack,
+        which is popped. Returns what `body` returns.
+        """
+        start = self.emit("loop")
+        template = body()
+        self.emit("jump", a=start)
+        self.patch(start, self.here())
+        return template
+
+    def build_reader(self, name: str) -> uproot_custom.readers.cpp.PlanReader:
+        """
+        Build the C++ reader executing the program.
+        """
+        return uproot_custom.readers.cpp.PlanReader(
+            name,
+            [tuple(op) for op in self.ops],
+            self.dtypes,
+            self.n_offsets,
+            self.readers,
+            self.strings,
+        )
+
+
+def build_reader(factory: Factory) -> tuple[uproot_custom.readers.cpp.PlanReader, Any]:
+    """
+    Lower a factory tree into a `PlanReader`.
+
+    Returns:
+        The reader, and the template to rebuild its data with `rebuild`.
+    """
+    plan = PlanBuilder()
+    template = factory.build_plan(plan, "one")
+    return plan.build_reader(factory.name), template
+
+
+def rebuild(template: Any, raw_data: tuple[list, list, list]) -> Any:
+    """
+    Turn the data of a `PlanReader` into the data of the equivalent reader tree.
+    """
+    columns, offsets, readers = raw_data
+    outputs = {"column": columns, "offsets": offsets, "reader": readers}
+
+    def _rebuild(node):
+        if node is None:
+            return None
+        if isinstance(node, list):
+            return [_rebuild(i) for i in node]
+        if node[0] == "tuple":
+            return tuple(_rebuild(i) for i in node[1])
+        return outputs[node[0]][node[1]]
+
+    return _rebuild(template)
+
+
+def read_data(
+    data: np.ndarray,
+    offsets: np.ndarray,
+    cursor_offset: int,
+    reader: uproot_custom.readers.cpp.PlanReader,
+    template: Any,
+    entry_start: int = 0,
+    entry_stop: int = -1,
+) -> Any:
+    """
+    Same as `uproot_custom.readers.cpp.read_data`, with a reader built by `build_reader`.
+    """
+    raw_data = uproot_custom.readers.cpp.read_data(
+        data, offsets, cursor_offset, reader, entry_start, entry_stop
+    )
+    return rebuild(template, raw_data)
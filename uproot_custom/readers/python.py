@@ -54,11 +54,40 @@ class BinaryStream:
         self.initial_cursor_position = initial_cursor_position
 
         self.refs: dict[int, _Reference] = {}
+        self.n_reset_refs = 0
+        self.refs_entry = 0
+
+        # Index of the entry being read, maintained by `read_data`
+        self.current_entry = 0
 
     @property
     def entries(self):
         return len(self.offsets) - 1
 
+    def n_refs(self) -> int:
+        """
+        Number of references registered in the stream, including those discarded by
+        `reset_refs`, see the C++ `BinaryStream::n_refs`.
+        """
+        return self.n_reset_refs + len(self.refs)
+
+    def reset_refs(self) -> None:
+        self.n_reset_refs += len(self.refs)
+        self.refs = {}
+
+    def reset_refs_per_entry(self) -> None:
+        """
+        Discard the references registered in previous entries, see the C++
+        `BinaryStream::reset_refs_per_entry`.
+        """
+        if self.refs_entry != self.current_entry:
+            self.reset_refs()
+            self.refs_entry = self.current_entry
+
+    @property
+    def current_entry_end(self) -> int:
+        return int(self.offsets[self.current_entry + 1])
+
     @property
     def remaining_data(self):
         return self.data[self.cursor :]
@@ -849,12 +878,13 @@ class AnyPointerReader(IReader):
          - tag & kClassMask != 0: reference to known class, new object data
     """
 
-    def __init__(self, name: str, element_reader: IReader):
+    def __init__(self, name: str, element_reader: IReader, reset_refs: bool = False):
         super().__init__(name)
 
         self.element_reader = element_reader
         self.object_counter = 0  # Counter for assigning object indexes to true pointers
         self.object_indexes = array("q")
+        self.reset_refs = reset_refs
 
         self.class_name = None
 
@@ -863,6 +893,9 @@ class AnyPointerReader(IReader):
         debug_print(f"AnyPointerReader({self.name}): reading pointer:")
         debug_print(stream)
 
+        if self.reset_refs:
+            stream.reset_refs_per_entry()
+
         start_pos = stream.cursor
         ref_begin = start_pos + stream.initial_cursor_position
         fNBytes = stream.read_uint32()
@@ -917,7 +950,7 @@ class AnyPointerReader(IReader):
                     f"Expected {self.class_name}, but got {class_name}"
                 )
 
-            ref_key = ref_begin + kMapOffset if fVersion > 0 else len(stream.refs) + 1
+            ref_key = ref_begin + kMapOffset if fVersion > 0 else stream.n_refs() + 1
             stream.refs[ref_key] = _Reference(type="class", class_name=class_name)
 
             debug_print(
@@ -926,7 +959,7 @@ class AnyPointerReader(IReader):
             self.element_reader.read(stream)
             self.object_indexes.append(self.object_counter)
 
-            ref_key = ref_begin + kMapOffset if fVersion > 0 else len(stream.refs) + 1
+            ref_key = ref_begin + kMapOffset if fVersion > 0 else stream.n_refs() + 1
             stream.refs[ref_key] = _Reference(type="object", object_index=self.object_counter)
 
             self.object_counter += 1
@@ -946,7 +979,7 @@ class AnyPointerReader(IReader):
             self.element_reader.read(stream)
             self.object_indexes.append(self.object_counter)
 
-            obj_ref_key = ref_begin + kMapOffset if fVersion > 0 else len(stream.refs) + 1
+            obj_ref_key = ref_begin + kMapOffset if fVersion > 0 else stream.n_refs() + 1
             stream.refs[obj_ref_key] = _Reference(
                 type="object", object_index=self.object_counter
             )
@@ -982,11 +1015,7 @@ class CStyleArrayReader(IReader):
             self.element_reader.read_many(stream, self.flat_size)
 
         else:
-            entry_offsets = stream.offsets
-            cursor_pos = stream.cursor
-            end_offset_index = (entry_offsets > cursor_pos).nonzero()[0].min()
-            end_pos = entry_offsets[end_offset_index]
-
+            end_pos = stream.current_entry_end
             count = self.element_reader.read_until(stream, end_pos)
             self.offsets.append(self.offsets[-1] + count)
             debug_print(f"CStyleArrayReader({self.name}): read {count} elements")
@@ -1018,8 +1047,74 @@ class CStyleArrayReader(IReader):
 
 
 class EmptyReader(IReader):
+    """
+    Skips a member without storing anything: by a fixed number of bytes per element if
+    `element_size` is given, by the `fNBytes` byte count of each element if
+    `jump_by_byte_count`, or else by parsing the elements with `element_reader`. Does
+    nothing if none of them is given. With `shared_byte_count`, the elements of one
+    `read_many` call share a single byte count, like STL containers with a header, and
+    `element_reader` is required to parse them in `read_until`.
+    """
+
+    def __init__(
+        self,
+        name: str,
+        element_size: int = 0,
+        element_reader: Optional[IReader] = None,
+        jump_by_byte_count: bool = False,
+        shared_byte_count: bool = False,
+    ):
+        super().__init__(name)
+        self.element_size = element_size
+        self.element_reader = element_reader
+        self.jump_by_byte_count = jump_by_byte_count
+        self.shared_byte_count = jump_by_byte_count and shared_byte_count
+        if self.shared_byte_count and element_reader is None:
+            raise ValueError(
+                f"EmptyReader({name}): shared_byte_count requires an element reader"
+            )
+
     def read(self, stream):
-        pass
+        if self.element_size:
+            stream.skip(self.element_size)
+        elif self.jump_by_byte_count:
+            stream.skip(stream.read_fNBytes())
+        elif self.element_reader is not None:
+            self.element_reader.read(stream)
+
+    def read_many(self, stream, count):
+        if count <= 0:
+            return 0
+
+        if self.element_size:
+            stream.skip(self.element_size * count)
+        elif self.shared_byte_count:
+            stream.skip(stream.read_fNBytes())
+        elif self.jump_by_byte_count:
+            for _ in range(count):
+                stream.skip(stream.read_fNBytes())
+        elif self.element_reader is not None:
+            return self.element_reader.read_many(stream, count)
+        return count
+
+    def read_until(self, stream, end_pos):
+        if stream.cursor >= end_pos:
+            return 0
+
+        if self.element_size:
+            count = (end_pos - stream.cursor + self.element_size - 1) // self.element_size
+            stream.skip(self.element_size * count)
+            return count
+        elif self.jump_by_byte_count and not self.shared_byte_count:
+            return super().read_until(stream, end_pos)
+        elif self.element_reader is not None:
+            return self.element_reader.read_until(stream, end_pos)
+        return 0
+
+    def read_many_memberwise(self, stream, count):
+        if self.element_reader is None:
+            return super().read_many_memberwise(stream, count)
+        return self.element_reader.read_many_memberwise(stream, count)
 
     def data(self):
         return None
@@ -1030,9 +1125,21 @@ def read_data(
     offsets: NDArray[np.uint32],
     cursor_offset: int,
     reader: IReader,
+    entry_start: int = 0,
+    entry_stop: int = -1,
 ):
     stream = BinaryStream(data, offsets, cursor_offset)
-    for i_evt in range(stream.entries):
+
+    if entry_stop < 0 or entry_stop > stream.entries:
+        entry_stop = stream.entries
+    entry_start = min(max(entry_start, 0), entry_stop)
+
+    # skip entries before the range without parsing them, the references of their objects
+    # are not registered, so readers of pointers must start at entry 0
+    stream.cursor = int(offsets[entry_start])
+
+    for i_evt in range(entry_start, entry_stop):
+        stream.current_entry = i_evt
         start_pos = stream.cursor
         reader.read(stream)
         end_pos = stream.cursor